@@ -0,0 +1,161 @@
+#include "ai_governor.h"
+#include "esp_log.h"
+#include <stddef.h>
+#include <inttypes.h>
+
+static const char *TAG = "AiGovernor";
+
+#define AI_GOV_EWMA_SHIFT       3           /* 滑动平均系数1/8 */
+#define AI_GOV_MAX_FRAME_US     1000000     /* 超过1秒的帧间隔视为暂停后恢复，不计入平均 */
+
+static const char *const s_mode_name[AI_GOV_MODE_COUNT] = {"idle", "normal", "near"};
+
+/**
+ * @brief       指数滑动平均
+ * @param       avg: 当前平均值，0表示尚无样本
+ * @param       sample: 新样本
+ * @retval      新的平均值
+ */
+static uint32_t ai_gov_ewma(uint32_t avg, uint32_t sample)
+{
+    if (avg == 0) {
+        return sample;
+    }
+
+    return (uint32_t)((int32_t)avg + (((int32_t)sample - (int32_t)avg) >> AI_GOV_EWMA_SHIFT));
+}
+
+/**
+ * @brief       按当前场景、推理耗时与帧间隔计算跳帧数
+ * @param       gov: 调速器
+ * @retval      无
+ */
+static void ai_gov_update_skip(ai_governor_t *gov)
+{
+    if (gov->frame_us_avg == 0) {
+        return;
+    }
+
+    /* 两次推理的最小间隔：满足目标检测率，同时MSR01占用不超过core 1预算 */
+    uint32_t hz = gov->cfg.target_hz[gov->mode];
+    uint32_t interval_us = hz ? 1000000 / hz : UINT32_MAX;
+    uint32_t budget_us = (uint32_t)((uint64_t)gov->infer_us_avg * 100 / gov->cfg.cpu_budget_pct);
+
+    if (budget_us > interval_us) {
+        interval_us = budget_us;
+    }
+
+    /* 每次推理间隔 skip+1 帧，向上取整 */
+    uint32_t period = (interval_us + gov->frame_us_avg - 1) / gov->frame_us_avg;
+    uint32_t skip = period > 0 ? period - 1 : 0;
+
+    gov->skip_rate = skip > gov->cfg.max_skip ? gov->cfg.max_skip : skip;
+}
+
+/**
+ * @brief       初始化调速器
+ * @param       gov: 调速器
+ * @param       cfg: 配置，NULL使用AI_GOV_*默认值
+ * @retval      无
+ */
+void ai_governor_init(ai_governor_t *gov, const ai_governor_config_t *cfg)
+{
+    static const ai_governor_config_t default_cfg = {
+        .target_hz = {AI_GOV_TARGET_HZ_IDLE, AI_GOV_TARGET_HZ_NORMAL, AI_GOV_TARGET_HZ_NEAR},
+        .cpu_budget_pct = AI_GOV_CPU_BUDGET_PCT,
+        .near_margin_cm = AI_GOV_NEAR_MARGIN_CM,
+        .absent_inferences = AI_GOV_ABSENT_INFERENCES,
+        .max_skip = AI_GOV_MAX_SKIP,
+    };
+
+    *gov = (ai_governor_t){0};
+    gov->cfg = cfg ? *cfg : default_cfg;
+
+    if (gov->cfg.cpu_budget_pct == 0 || gov->cfg.cpu_budget_pct > 100) {
+        gov->cfg.cpu_budget_pct = 100;
+    }
+
+    /* 启动时按有人处理，首帧即推理 */
+    gov->mode = AI_GOV_MODE_NORMAL;
+}
+
+/**
+ * @brief       新帧到达：更新帧间隔并决定本帧是否推理
+ * @param       gov: 调速器
+ * @param       now_us: 当前时间（us）
+ * @retval      true: 本帧进行推理, false: 跳过
+ */
+bool ai_governor_on_frame(ai_governor_t *gov, int64_t now_us)
+{
+    if (gov->last_frame_us != 0) {
+        int64_t delta = now_us - gov->last_frame_us;
+        if (delta > 0 && delta < AI_GOV_MAX_FRAME_US) {
+            gov->frame_us_avg = ai_gov_ewma(gov->frame_us_avg, (uint32_t)delta);
+        }
+    }
+    gov->last_frame_us = now_us;
+    gov->frames++;
+
+    if (gov->skip_counter < gov->skip_rate) {
+        gov->skip_counter++;
+        return false;
+    }
+
+    gov->skip_counter = 0;
+    return true;
+}
+
+/**
+ * @brief       一次推理完成：更新耗时与场景，重新计算跳帧数
+ * @param       gov: 调速器
+ * @param       infer_us: 本次推理在core 1上的耗时（us），即MSR01级耗时
+ * @param       face_present: 是否检测到人脸
+ * @param       margin_valid: margin_cm是否有效（已标定且有距离）
+ * @param       margin_cm: 当前距离减去进入过近阈值（cm），负数表示已过近
+ * @retval      无
+ */
+void ai_governor_on_inference(ai_governor_t *gov, uint32_t infer_us, bool face_present,
+                              bool margin_valid, float margin_cm)
+{
+    ai_gov_mode_t mode;
+
+    gov->infer_us_avg = ai_gov_ewma(gov->infer_us_avg, infer_us);
+    gov->inferences++;
+
+    if (face_present) {
+        gov->no_face_count = 0;
+        mode = (margin_valid && margin_cm < gov->cfg.near_margin_cm) ? AI_GOV_MODE_NEAR : AI_GOV_MODE_NORMAL;
+    } else if (++gov->no_face_count >= gov->cfg.absent_inferences) {
+        mode = AI_GOV_MODE_IDLE;
+    } else {
+        /* 短暂丢失人脸时保持原场景，避免接近阈值时降频 */
+        mode = gov->mode;
+    }
+
+    if (mode != gov->mode) {
+        ESP_LOGI(TAG, "Mode %s -> %s", s_mode_name[gov->mode], s_mode_name[mode]);
+        /* 进入更高检测率的场景时下一帧立即推理 */
+        if (gov->cfg.target_hz[mode] > gov->cfg.target_hz[gov->mode]) {
+            gov->skip_counter = UINT32_MAX;
+        }
+        gov->mode = mode;
+    }
+
+    ai_gov_update_skip(gov);
+}
+
+/**
+ * @brief       输出调速器统计
+ * @param       gov: 调速器
+ * @retval      无
+ */
+void ai_governor_log_stats(const ai_governor_t *gov)
+{
+    uint32_t frame_us = gov->frame_us_avg ? gov->frame_us_avg : 1;
+
+    ESP_LOGI(TAG, "mode %s, skip %" PRIu32 ", infer avg %" PRIu32 " us, frame avg %" PRIu32
+             " us, %" PRIu32 "/%" PRIu32 " frames inferred, ~%" PRIu32 "%% core 1",
+             s_mode_name[gov->mode], gov->skip_rate, gov->infer_us_avg, gov->frame_us_avg,
+             gov->inferences, gov->frames,
+             (uint32_t)((uint64_t)gov->infer_us_avg * 100 / ((uint64_t)frame_us * (gov->skip_rate + 1))));
+}
@@ -0,0 +1,98 @@
+#ifndef __AI_GOVERNOR_H__
+#define __AI_GOVERNOR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 各场景的目标检测率（次/秒） */
+#define AI_GOV_TARGET_HZ_IDLE           2       /* 画面中无人 */
+#define AI_GOV_TARGET_HZ_NORMAL         5       /* 有人且距离安全 */
+#define AI_GOV_TARGET_HZ_NEAR           15      /* 接近或已超过过近阈值 */
+
+#define AI_GOV_CPU_BUDGET_PCT           60      /* MSR01级推理最多占用core 1的时间比例 */
+#define AI_GOV_NEAR_MARGIN_CM           8.0f    /* 距离进入阈值不足该值视为接近阈值 */
+#define AI_GOV_ABSENT_INFERENCES        10      /* 连续N次推理无人脸视为无人 */
+#define AI_GOV_MAX_SKIP                 15      /* 两次推理之间最多跳过的帧数 */
+#define AI_GOV_LOG_INFERENCES           100     /* 每N次推理输出一次统计 */
+
+/**
+ * @brief       调速器场景
+ */
+typedef enum {
+    AI_GOV_MODE_IDLE = 0,       /*!< 无人 */
+    AI_GOV_MODE_NORMAL,         /*!< 有人，距离安全 */
+    AI_GOV_MODE_NEAR,           /*!< 接近或超过过近阈值 */
+    AI_GOV_MODE_COUNT
+} ai_gov_mode_t;
+
+/**
+ * @brief       调速器配置
+ */
+typedef struct {
+    uint32_t target_hz[AI_GOV_MODE_COUNT];  /*!< 各场景目标检测率（次/秒） */
+    uint32_t cpu_budget_pct;                /*!< core 1上MSR01推理占用上限（%） */
+    float near_margin_cm;                   /*!< 接近阈值的判定余量（cm） */
+    uint32_t absent_inferences;             /*!< 判定无人所需的连续无人脸推理次数 */
+    uint32_t max_skip;                      /*!< 最大跳帧数 */
+} ai_governor_config_t;
+
+/**
+ * @brief       调速器状态（由AI任务独占使用）
+ */
+typedef struct {
+    ai_governor_config_t cfg;
+    ai_gov_mode_t mode;         /*!< 当前场景 */
+    uint32_t infer_us_avg;      /*!< core 1推理耗时滑动平均（us） */
+    uint32_t frame_us_avg;      /*!< 摄像头帧间隔滑动平均（us） */
+    int64_t last_frame_us;      /*!< 上一帧到达时间 */
+    uint32_t no_face_count;     /*!< 连续无人脸推理次数 */
+    uint32_t skip_rate;         /*!< 两次推理之间跳过的帧数 */
+    uint32_t skip_counter;      /*!< 自上次推理以来已跳过的帧数 */
+    uint32_t frames;            /*!< 累计帧数 */
+    uint32_t inferences;        /*!< 累计推理次数 */
+} ai_governor_t;
+
+/**
+ * @brief       初始化调速器
+ * @param       gov: 调速器
+ * @param       cfg: 配置，NULL使用AI_GOV_*默认值
+ * @retval      无
+ */
+void ai_governor_init(ai_governor_t *gov, const ai_governor_config_t *cfg);
+
+/**
+ * @brief       新帧到达：更新帧间隔并决定本帧是否推理
+ * @param       gov: 调速器
+ * @param       now_us: 当前时间（us）
+ * @retval      true: 本帧进行推理, false: 跳过
+ */
+bool ai_governor_on_frame(ai_governor_t *gov, int64_t now_us);
+
+/**
+ * @brief       一次推理完成：更新耗时与场景，重新计算跳帧数
+ * @param       gov: 调速器
+ * @param       infer_us: 本次推理在core 1上的耗时（us），即MSR01级耗时
+ * @param       face_present: 是否检测到人脸
+ * @param       margin_valid: margin_cm是否有效（已标定且有距离）
+ * @param       margin_cm: 当前距离减去进入过近阈值（cm），负数表示已过近
+ * @retval      无
+ */
+void ai_governor_on_inference(ai_governor_t *gov, uint32_t infer_us, bool face_present,
+                              bool margin_valid, float margin_cm);
+
+/**
+ * @brief       输出调速器统计
+ * @param       gov: 调速器
+ * @retval      无
+ */
+void ai_governor_log_stats(const ai_governor_t *gov);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AI_GOVERNOR_H__ */
@@ -0,0 +1,122 @@
+#include "distance_filter.hpp"
+#include <cmath>
+
+#define DISTANCE_FILTER_MIN_DT_S    0.001f      /* 时间戳相同或倒退时使用的最小间隔 */
+#define KALMAN_INIT_VEL_VAR         100.0f      /* 初始速度方差((cm/s)^2) */
+
+/**
+ * @brief 计算相邻测量的时间间隔
+ * @param now_us 本次时间戳
+ * @param last_us 上次时间戳
+ * @retval 间隔(s)，不小于DISTANCE_FILTER_MIN_DT_S
+ */
+static float distance_filter_dt(int64_t now_us, int64_t last_us)
+{
+    float dt = (float)(now_us - last_us) * 1e-6f;
+    return dt < DISTANCE_FILTER_MIN_DT_S ? DISTANCE_FILTER_MIN_DT_S : dt;
+}
+
+/**
+ * @brief 一阶低通的平滑系数
+ * @param cutoff_hz 截止频率
+ * @param dt 采样间隔(s)
+ * @retval 平滑系数(0,1]
+ */
+static float one_euro_alpha(float cutoff_hz, float dt)
+{
+    float tau = 1.0f / (2.0f * (float)M_PI * cutoff_hz);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+OneEuroFilter::OneEuroFilter(float min_cutoff_hz, float beta, float d_cutoff_hz)
+    : min_cutoff_hz_(min_cutoff_hz)
+    , beta_(beta)
+    , d_cutoff_hz_(d_cutoff_hz)
+{
+    reset();
+}
+
+void OneEuroFilter::reset()
+{
+    initialized_ = false;
+    x_ = 0.0f;
+    dx_ = 0.0f;
+    last_us_ = 0;
+}
+
+float OneEuroFilter::update(float distance_cm, int64_t timestamp_us)
+{
+    if (!initialized_ || timestamp_us - last_us_ > DISTANCE_FILTER_MAX_GAP_US) {
+        initialized_ = true;
+        x_ = distance_cm;
+        dx_ = 0.0f;
+        last_us_ = timestamp_us;
+        return x_;
+    }
+
+    float dt = distance_filter_dt(timestamp_us, last_us_);
+    last_us_ = timestamp_us;
+
+    /* 先平滑速度，再由速度决定本次截止频率 */
+    float dx = (distance_cm - x_) / dt;
+    dx_ += one_euro_alpha(d_cutoff_hz_, dt) * (dx - dx_);
+
+    float cutoff = min_cutoff_hz_ + beta_ * fabsf(dx_);
+    x_ += one_euro_alpha(cutoff, dt) * (distance_cm - x_);
+
+    return x_;
+}
+
+KalmanCvFilter::KalmanCvFilter(float accel_var, float meas_var)
+    : accel_var_(accel_var)
+    , meas_var_(meas_var)
+{
+    reset();
+}
+
+void KalmanCvFilter::reset()
+{
+    initialized_ = false;
+    d_ = 0.0f;
+    v_ = 0.0f;
+    p00_ = p01_ = p11_ = 0.0f;
+    last_us_ = 0;
+}
+
+float KalmanCvFilter::update(float distance_cm, int64_t timestamp_us)
+{
+    if (!initialized_ || timestamp_us - last_us_ > DISTANCE_FILTER_MAX_GAP_US) {
+        initialized_ = true;
+        d_ = distance_cm;
+        v_ = 0.0f;
+        p00_ = meas_var_;
+        p01_ = 0.0f;
+        p11_ = KALMAN_INIT_VEL_VAR;
+        last_us_ = timestamp_us;
+        return d_;
+    }
+
+    float dt = distance_filter_dt(timestamp_us, last_us_);
+    last_us_ = timestamp_us;
+
+    /* 预测：x = F x，P = F P F' + Q，Q为离散白噪声加速度模型 */
+    float dt2 = dt * dt;
+    d_ += v_ * dt;
+    p00_ += dt * (2.0f * p01_ + dt * p11_) + accel_var_ * dt2 * dt2 * 0.25f;
+    p01_ += dt * p11_ + accel_var_ * dt2 * dt * 0.5f;
+    p11_ += accel_var_ * dt2;
+
+    /* 更新：只观测距离，H = [1 0] */
+    float s = p00_ + meas_var_;
+    float k0 = p00_ / s;
+    float k1 = p01_ / s;
+    float y = distance_cm - d_;
+
+    d_ += k0 * y;
+    v_ += k1 * y;
+    p11_ -= k1 * p01_;
+    p01_ -= k0 * p01_;
+    p00_ -= k0 * p00_;
+
+    return d_;
+}
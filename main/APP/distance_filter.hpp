@@ -0,0 +1,116 @@
+#ifndef __DISTANCE_FILTER_HPP__
+#define __DISTANCE_FILTER_HPP__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "fixed_ring.hpp"
+
+#define DISTANCE_FILTER_MAX_GAP_US  1000000     /* 相邻测量间隔超过此值视为新的一段轨迹，滤波器重新起步 */
+
+/**
+ * @brief 距离滤波器接口：输入带时间戳的原始距离，输出平滑距离
+ */
+class DistanceFilter {
+public:
+    virtual ~DistanceFilter() {}
+
+    /**
+     * @brief 清空内部状态
+     */
+    virtual void reset() = 0;
+
+    /**
+     * @brief 输入一次测量
+     * @param distance_cm 原始距离(cm)
+     * @param timestamp_us 测量时间（帧采集时间，esp_timer时基）
+     * @retval 平滑后的距离(cm)
+     */
+    virtual float update(float distance_cm, int64_t timestamp_us) = 0;
+
+    /**
+     * @brief 获取当前平滑距离
+     * @retval 平滑后的距离(cm)，尚无数据时为-1
+     */
+    virtual float value() const = 0;
+};
+
+/**
+ * @brief 滑动平均：最近N次测量的均值（原有行为），延迟约N/2帧
+ */
+template <size_t N>
+class MovingAverageFilter : public DistanceFilter {
+public:
+    void reset() override { window_.clear(); }
+
+    float update(float distance_cm, int64_t timestamp_us) override
+    {
+        (void)timestamp_us;
+        window_.push(distance_cm);
+        return window_.mean();
+    }
+
+    float value() const override { return window_.empty() ? -1.0f : window_.mean(); }
+
+    /**
+     * @brief 获取窗口（用于输出最值、方差等调试信息）
+     */
+    const FixedRing<float, N>& window() const { return window_; }
+
+private:
+    FixedRing<float, N> window_;
+};
+
+/**
+ * @brief One-Euro滤波：截止频率随变化速度升高，静止时平滑、移动时跟手
+ */
+class OneEuroFilter : public DistanceFilter {
+public:
+    /**
+     * @brief 构造函数
+     * @param min_cutoff_hz 静止时的截止频率，越小越平滑
+     * @param beta 速度系数，越大移动时延迟越小
+     * @param d_cutoff_hz 速度估计的截止频率
+     */
+    OneEuroFilter(float min_cutoff_hz, float beta, float d_cutoff_hz);
+
+    void reset() override;
+    float update(float distance_cm, int64_t timestamp_us) override;
+    float value() const override { return initialized_ ? x_ : -1.0f; }
+
+private:
+    float min_cutoff_hz_;
+    float beta_;
+    float d_cutoff_hz_;
+    bool initialized_;
+    float x_;                   /*!< 平滑距离 */
+    float dx_;                  /*!< 平滑速度(cm/s) */
+    int64_t last_us_;
+};
+
+/**
+ * @brief 匀速模型卡尔曼滤波：状态为[距离, 速度]，按真实帧间隔预测
+ */
+class KalmanCvFilter : public DistanceFilter {
+public:
+    /**
+     * @brief 构造函数
+     * @param accel_var 过程噪声：加速度方差((cm/s^2)^2)，越大越跟手
+     * @param meas_var 测量噪声方差(cm^2)，越大越平滑
+     */
+    KalmanCvFilter(float accel_var, float meas_var);
+
+    void reset() override;
+    float update(float distance_cm, int64_t timestamp_us) override;
+    float value() const override { return initialized_ ? d_ : -1.0f; }
+
+private:
+    float accel_var_;
+    float meas_var_;
+    bool initialized_;
+    float d_;                   /*!< 距离(cm) */
+    float v_;                   /*!< 速度(cm/s) */
+    float p00_, p01_, p11_;     /*!< 协方差（对称，只存上三角） */
+    int64_t last_us_;
+};
+
+#endif /* __DISTANCE_FILTER_HPP__ */
@@ -26,18 +26,411 @@
 #include "face_distance_c_interface.h"
 #include "esp_task_wdt.h"
 #include "system_state_manager.h"
+#include "lcd_preview.h"
+#include "ai_governor.h"
+#include "motion_gate.h"
+#include "frame_ring.h"
+#include "pretrigger_ring.h"
+#include "latency_hist.h"
+#include "trace_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <string.h>
+#include <inttypes.h>
+
+/* 人脸跟踪：在上次人脸周围的区域内检测，定期或跟丢时全图搜索 */
+#define FACE_TRACK_ENABLE           1
+#define FACE_TRACK_EXPAND_PCT       60      /* 跟踪区域在人脸框四周各扩展人脸尺寸的比例 */
+#define FACE_TRACK_MIN_SIZE         96      /* 跟踪区域最小边长（像素） */
+#define FACE_TRACK_MAX_AREA_PCT     60      /* 跟踪区域超过整帧面积该比例时直接全图检测 */
+#define FACE_TRACK_FULL_INTERVAL    15      /* 连续跟踪N次后强制全图搜索一次 */
 
 
 TaskHandle_t camera_task_handle;
 TaskHandle_t ai_task_handle;
-QueueHandle_t xQueueFrameO = NULL;
-QueueHandle_t xQueueAIFrameO = NULL;
+TaskHandle_t mnp_task_handle;
+TaskHandle_t post_task_handle;
+
+/**
+ * @brief       人脸跟踪状态（MSR01级读取，MNP01级更新，由s_track_lock保护）
+ */
+typedef struct {
+    bool valid;                 /* 是否有可跟踪的人脸 */
+    int x0, y0, x1, y1;         /* 上次人脸框（帧坐标） */
+    uint32_t since_full;        /* 距上次全图搜索的跟踪次数 */
+    uint32_t tracked;           /* 跟踪检测次数 */
+    uint32_t full;              /* 全图检测次数 */
+    uint32_t lost;              /* 跟丢次数 */
+} face_track_t;
+
+/**
+ * @brief       流水线中一帧的处理方式
+ */
+typedef enum {
+    FACE_JOB_PASS = 0,          /* 不推理，直接显示 */
+    FACE_JOB_REUSE,             /* 画面静止或跟丢，绘制上次结果后显示 */
+    FACE_JOB_INFER,             /* 两级推理后做距离检测与绘制 */
+} face_job_kind_t;
+
+/**
+ * @brief       流水线任务单：从MSR01级依次传到后处理级，处理完放回空闲队列
+ */
+typedef struct {
+    camera_fb_t *fb;                                /* 摄像头帧 */
+    face_job_kind_t kind;                           /* 处理方式 */
+    uint16_t *crop_buf;                             /* 跟踪区域裁剪缓冲（每个任务单一份，避免级间争用） */
+    size_t crop_cap;                                /* 裁剪缓冲容量（像素） */
+    const uint16_t *input;                          /* 推理输入（整帧或裁剪缓冲） */
+    int in_w, in_h;                                 /* 推理输入宽高 */
+    int roi_x, roi_y;                               /* 裁剪区域左上角（帧坐标） */
+    bool tracked;                                   /* 是否为跟踪区域推理 */
+    std::list<dl::detect::result_t> candidates;     /* MSR01候选框 */
+    std::list<dl::detect::result_t> results;        /* MNP01结果（帧坐标） */
+    uint32_t msr_us;                                /* MSR01耗时（core 1，不含运动门控） */
+    uint32_t mnp_us;                                /* MNP01耗时（core 0） */
+} face_job_t;
+
+/**
+ * @brief       推理结果反馈给调速器（后处理级 -> MSR01级）
+ */
+typedef struct {
+    uint32_t infer_us;                              /* core 1上的MSR01耗时 */
+    bool face_present;
+    bool margin_valid;
+    float margin_cm;
+} face_feedback_t;
+
+/**
+ * @brief       流水线各级吞吐统计（每级只由自己的任务写入，输出任务在另一个核读取，均在s_stage_lock内进行）
+ */
+typedef struct {
+    uint32_t frames;            /* 处理帧数 */
+    uint64_t busy_us;           /* 处理耗时之和 */
+} face_pipe_stage_t;
+
+enum {
+    FACE_PIPE_STAGE_CAPTURE = 0,
+    FACE_PIPE_STAGE_MSR,
+    FACE_PIPE_STAGE_MNP,
+    FACE_PIPE_STAGE_POST,
+    FACE_PIPE_STAGE_COUNT
+};
+
+static const char *const s_stage_name[FACE_PIPE_STAGE_COUNT] = {"capture", "msr01", "mnp01", "post"};
+
+static face_job_t s_jobs[FACE_PIPE_JOBS];
+static frame_ring_t s_capture_ring;             /* 采集级 -> MSR01级，满时丢弃最旧帧 */
+static QueueHandle_t s_free_jobs = NULL;        /* 空闲任务单 */
+static QueueHandle_t s_msr_queue = NULL;        /* MSR01级 -> MNP01级 */
+static QueueHandle_t s_post_queue = NULL;       /* MNP01级 -> 后处理级 */
+static QueueHandle_t s_feedback_queue = NULL;   /* 后处理级 -> MSR01级（调速器） */
+
+static face_track_t s_track = {};
+static portMUX_TYPE s_track_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static face_pipe_stage_t s_stage_stats[FACE_PIPE_STAGE_COUNT];
+static portMUX_TYPE s_stage_lock = portMUX_INITIALIZER_UNLOCKED;   /* 64位累加在32位核上非原子 */
+
+/**
+ * @brief       计算跟踪区域：上次人脸框向四周扩展后裁剪到帧内
+ * @param       track: 跟踪状态
+ * @param       fw/fh: 帧宽高
+ * @param       rx/ry/rw/rh: 输出区域
+ * @retval      true: 区域可用, false: 区域过大，应全图检测
+ */
+static bool face_track_roi(const face_track_t *track, int fw, int fh, int *rx, int *ry, int *rw, int *rh)
+{
+    int bw = track->x1 - track->x0;
+    int bh = track->y1 - track->y0;
+    int mx = bw * FACE_TRACK_EXPAND_PCT / 100;
+    int my = bh * FACE_TRACK_EXPAND_PCT / 100;
+
+    if (bw + 2 * mx < FACE_TRACK_MIN_SIZE) {
+        mx = (FACE_TRACK_MIN_SIZE - bw + 1) / 2;
+    }
+    if (bh + 2 * my < FACE_TRACK_MIN_SIZE) {
+        my = (FACE_TRACK_MIN_SIZE - bh + 1) / 2;
+    }
+
+    int x0 = track->x0 - mx < 0 ? 0 : track->x0 - mx;
+    int y0 = track->y0 - my < 0 ? 0 : track->y0 - my;
+    int x1 = track->x1 + mx > fw ? fw : track->x1 + mx;
+    int y1 = track->y1 + my > fh ? fh : track->y1 + my;
+
+    if (x1 - x0 <= 0 || y1 - y0 <= 0
+        || (x1 - x0) * (y1 - y0) * 100 > fw * fh * FACE_TRACK_MAX_AREA_PCT) {
+        return false;
+    }
+
+    *rx = x0;
+    *ry = y0;
+    *rw = x1 - x0;
+    *rh = y1 - y0;
+    return true;
+}
+
+/**
+ * @brief       把跟踪区域从帧中复制到任务单的裁剪缓冲
+ * @param       job: 任务单
+ * @param       rx/ry/rw/rh: 区域
+ * @retval      true: 成功, false: 缓冲分配失败
+ */
+static bool face_track_crop(face_job_t *job, int rx, int ry, int rw, int rh)
+{
+    const camera_fb_t *fb = job->fb;
+    size_t need = (size_t)rw * rh;
+
+    if (need > job->crop_cap) {
+        /* 按整帧大小分配一次，之后不再重新分配 */
+        size_t cap = (size_t)fb->width * fb->height;
+        heap_caps_free(job->crop_buf);
+        job->crop_buf = (uint16_t *)heap_caps_malloc(cap * sizeof(uint16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        job->crop_cap = job->crop_buf ? cap : 0;
+        if (!job->crop_buf) {
+            ESP_LOGW("AI_Task", "Failed to allocate face track crop buffer");
+            return false;
+        }
+    }
+
+    const uint16_t *src = (const uint16_t *)fb->buf + (size_t)ry * fb->width + rx;
+    for (int r = 0; r < rh; r++) {
+        memcpy(job->crop_buf + (size_t)r * rw, src + (size_t)r * fb->width, (size_t)rw * sizeof(uint16_t));
+    }
+
+    return true;
+}
+
+/**
+ * @brief       把裁剪区域内的检测结果（人脸框与关键点）平移回帧坐标
+ * @param       results: 检测结果
+ * @param       rx/ry: 区域左上角
+ * @retval      无
+ */
+static void face_track_map_back(std::list<dl::detect::result_t> &results, int rx, int ry)
+{
+    for (dl::detect::result_t &res : results) {
+        for (size_t i = 0; i < res.box.size(); i++) {
+            res.box[i] += (i & 1) ? ry : rx;
+        }
+        for (size_t i = 0; i < res.keypoint.size(); i++) {
+            res.keypoint[i] += (i & 1) ? ry : rx;
+        }
+    }
+}
+
+/**
+ * @brief       用本次检测结果更新跟踪目标（跟踪第一个人脸，调用者持有s_track_lock）
+ * @param       track: 跟踪状态
+ * @param       results: 检测结果（帧坐标）
+ * @retval      无
+ */
+static void face_track_update(face_track_t *track, const std::list<dl::detect::result_t> &results)
+{
+#if FACE_TRACK_ENABLE
+    /* 多人时只跟踪一个会漏掉其他人脸，保持全图检测 */
+    if (results.size() != 1 || results.front().box.size() < 4) {
+        track->valid = false;
+        return;
+    }
 
+    const std::vector<int> &box = results.front().box;
+    track->x0 = box[0];
+    track->y0 = box[1];
+    track->x1 = box[2];
+    track->y1 = box[3];
+    track->valid = track->x1 > track->x0 && track->y1 > track->y0;
+#else
+    (void)results;
+    track->valid = false;
+#endif
+}
 
 /**
- * @brief       摄像头图像数据获取任务
+ * @brief       第一级推理（MSR01）：有跟踪目标时只检测其周围区域，区域内无候选时改为全图
+ * @param       detector: MSR01检测器
+ * @param       job: 任务单，输出推理输入与候选框
+ * @retval      无
+ */
+static void face_msr_run(HumanFaceDetectMSR01 &detector, face_job_t *job)
+{
+    camera_fb_t *fb = job->fb;
+    face_track_t snap;
+    int rx, ry, rw, rh;
+
+    portENTER_CRITICAL(&s_track_lock);
+    snap = s_track;
+    portEXIT_CRITICAL(&s_track_lock);
+
+    if (snap.valid && snap.since_full < FACE_TRACK_FULL_INTERVAL
+        && face_track_roi(&snap, fb->width, fb->height, &rx, &ry, &rw, &rh)
+        && face_track_crop(job, rx, ry, rw, rh))
+    {
+        std::list<dl::detect::result_t> &candidates = detector.infer(job->crop_buf, {rh, rw, 3});
+
+        if (!candidates.empty()) {
+            job->input = job->crop_buf;
+            job->in_w = rw;
+            job->in_h = rh;
+            job->roi_x = rx;
+            job->roi_y = ry;
+            job->tracked = true;
+            job->candidates = candidates;
+            return;
+        }
+
+        /* 跟丢后在同一帧上全图搜索，避免误判为无人 */
+        portENTER_CRITICAL(&s_track_lock);
+        s_track.lost++;
+        portEXIT_CRITICAL(&s_track_lock);
+    }
+
+    /* 全图检测 */
+    job->input = (const uint16_t *)fb->buf;
+    job->in_w = fb->width;
+    job->in_h = fb->height;
+    job->roi_x = 0;
+    job->roi_y = 0;
+    job->tracked = false;
+    job->candidates = detector.infer((uint16_t *)fb->buf, {(int)fb->height, (int)fb->width, 3});
+}
+
+/**
+ * @brief       第二级推理（MNP01）：细化候选框，结果平移回帧坐标并更新跟踪目标
+ * @param       detector2: MNP01检测器
+ * @param       job: 任务单
+ * @retval      无
+ */
+static void face_mnp_run(HumanFaceDetectMNP01 &detector2, face_job_t *job)
+{
+    job->results = detector2.infer((uint16_t *)job->input, {job->in_h, job->in_w, 3}, job->candidates);
+
+    if (job->tracked) {
+        face_track_map_back(job->results, job->roi_x, job->roi_y);
+    }
+
+    portENTER_CRITICAL(&s_track_lock);
+    if (job->tracked && job->results.empty()) {
+        /* 跟踪区域内候选被全部否决：下一帧全图搜索，本帧沿用上次结果而不是判为无人 */
+        s_track.valid = false;
+        s_track.lost++;
+        job->kind = FACE_JOB_REUSE;
+    } else {
+        face_track_update(&s_track, job->results);
+        if (job->tracked) {
+            s_track.since_full++;
+            s_track.tracked++;
+        } else {
+            s_track.since_full = 0;
+            s_track.full++;
+        }
+    }
+    portEXIT_CRITICAL(&s_track_lock);
+}
+
+/**
+ * @brief       把检测结果转换为定长结果批（超出FACE_RESULT_MAX_FACES的人脸丢弃）
+ * @param       batch: 输出
+ * @param       results: 检测结果（帧坐标）
+ * @param       fb: 结果所属的摄像头帧
+ * @retval      无
+ */
+static void face_result_batch_fill(face_result_batch_t *batch, const std::list<dl::detect::result_t> &results,
+                                   const camera_fb_t *fb)
+{
+    batch->timestamp_us = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+    batch->count = 0;
+
+    for (const dl::detect::result_t &res : results) {
+        if (batch->count >= FACE_RESULT_MAX_FACES) {
+            break;
+        }
+
+        face_result_t *face = &batch->faces[batch->count++];
+        memset(face, 0, sizeof(*face));
+        for (size_t i = 0; i < 4 && i < res.box.size(); i++) {
+            face->box[i] = res.box[i];
+        }
+        face->score = res.score;
+        face->has_keypoints = res.keypoint.size() >= FACE_RESULT_KEYPOINTS;
+        if (face->has_keypoints) {
+            memcpy(face->keypoint, res.keypoint.data(), sizeof(face->keypoint));
+        }
+    }
+}
+
+/**
+ * @brief       记录一级的处理耗时
+ * @param       stage: 级编号
+ * @param       start_us: 开始时间
+ * @retval      无
+ */
+static inline void face_pipe_account(int stage, int64_t start_us)
+{
+    uint64_t busy_us = (uint64_t)(esp_timer_get_time() - start_us);
+
+    portENTER_CRITICAL(&s_stage_lock);
+    s_stage_stats[stage].frames++;
+    s_stage_stats[stage].busy_us += busy_us;
+    portEXIT_CRITICAL(&s_stage_lock);
+}
+
+/**
+ * @brief       输出各级吞吐（帧率、平均耗时、占用率），按上次输出以来的增量计算
+ * @param       now_us: 当前时间
+ * @retval      无
+ */
+static void face_pipe_report(int64_t now_us)
+{
+    static face_pipe_stage_t last[FACE_PIPE_STAGE_COUNT];
+    static int64_t last_us = 0;
+    face_pipe_stage_t snap[FACE_PIPE_STAGE_COUNT];
+
+    if (last_us != 0 && now_us - last_us < FACE_PIPE_REPORT_US) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_stage_lock);
+    memcpy(snap, s_stage_stats, sizeof(snap));
+    portEXIT_CRITICAL(&s_stage_lock);
+
+    if (last_us == 0) {
+        last_us = now_us;
+        memcpy(last, snap, sizeof(last));
+        return;
+    }
+
+    int64_t span_us = now_us - last_us;
+    for (int i = 0; i < FACE_PIPE_STAGE_COUNT; i++) {
+        face_pipe_stage_t cur = snap[i];
+        uint32_t frames = cur.frames - last[i].frames;
+        uint64_t busy = cur.busy_us - last[i].busy_us;
+
+        ESP_LOGI("Pipeline", "%-7s: %5.1f fps, avg %6" PRIu32 " us, busy %3" PRIu32 "%%",
+                 s_stage_name[i], frames * 1000000.0 / span_us,
+                 frames ? (uint32_t)(busy / frames) : 0, (uint32_t)(busy * 100 / span_us));
+        last[i] = cur;
+    }
+
+    frame_ring_stats_t ring;
+    frame_ring_get_stats(&s_capture_ring, &ring);
+    ESP_LOGI("Pipeline", "capture ring: %" PRIu32 " pushed, %" PRIu32 " dropped, residency avg %" PRIu32 " us max %" PRIu32 " us",
+             ring.pushed, ring.dropped, ring.popped ? (uint32_t)(ring.residency_us / ring.popped) : 0,
+             ring.residency_max_us);
+
+    pretrigger_ring_stats_t pre;
+    pretrigger_ring_get_stats(&pre);
+    ESP_LOGI("Pipeline", "pre-trigger ring: %" PRIu32 " recorded (1/%" PRIu32 " scale, avg %" PRIu32 " us), %" PRIu32
+             " skipped, %" PRIu32 " alarm frames used, %" PRIu32 " misses",
+             pre.recorded, pre.decimation, pre.recorded ? (uint32_t)(pre.record_us / pre.recorded) : 0,
+             pre.skipped, pre.acquired, pre.misses);
+
+    last_us = now_us;
+}
+
+/**
+ * @brief       摄像头图像数据获取任务（流水线第一级）
  * @param       arg：未使用
  * @retval      无
  */
@@ -46,9 +439,11 @@ static void camera_process_handler(void *arg)
     arg = arg;
     camera_fb_t *camera_frame = NULL;
     bool watchdog_active = false;
-    bool cleanup_logged = false; // 移动到函数级别
     esp_err_t wdt_ret;
 
+    /* 拍照前状态管理器等待本任务确认停止取帧 */
+    system_state_register_client(SYSTEM_CLIENT_CAMERA);
+
     /* 安全地将当前任务添加到看门狗监控 */
     wdt_ret = esp_task_wdt_add(NULL);
     if (wdt_ret == ESP_OK) {
@@ -75,18 +470,13 @@ static void camera_process_handler(void *arg)
                 }
             }
             
-            /* 在暂停期间不访问摄像头，但保持较短的等待时间避免摄像头休眠 */
-            if (!cleanup_logged) {
-                ESP_LOGI("Camera_Task", "Camera task paused - releasing camera resources for photo upload");
-                cleanup_logged = true;
-            }
-            
-            /* 适度的等待时间，避免摄像头硬件进入休眠状态 */
-            vTaskDelay(200 / portTICK_PERIOD_MS);
+            /* 最后一帧已入帧环，确认后MSR01级即可取空帧环；阻塞到恢复为止，不再轮询 */
+            ESP_LOGI("Camera_Task", "Camera task paused - releasing camera resources for photo upload");
+            system_state_ack_pause(SYSTEM_CLIENT_CAMERA);
+            system_state_wait_resume(SYSTEM_CLIENT_CAMERA);
             continue;
         } else {
             /* 恢复正常操作时重新加入看门狗 */
-            cleanup_logged = false; // 重置日志标志
             if (!watchdog_active) {
                 wdt_ret = esp_task_wdt_add(NULL);
                 if (wdt_ret == ESP_OK) {
@@ -104,13 +494,17 @@ static void camera_process_handler(void *arg)
             esp_task_wdt_reset();
         }
         
-        /* 获取摄像头图像 */
+        /* 获取摄像头图像（capture级耗时包含等待传感器出帧的时间） */
+        int64_t start_us = esp_timer_get_time();
         camera_frame = esp_camera_fb_get();
 
         if (camera_frame)
         {
-            /* 以队列的形式发送 */
-            xQueueSend(xQueueFrameO, &camera_frame, portMAX_DELAY);
+            face_pipe_account(FACE_PIPE_STAGE_CAPTURE, start_us);
+            LAT_RECORD(LAT_STAGE_CAPTURE, start_us);
+
+            /* 放入帧环，AI跟不上时丢弃最旧帧，采集不会被阻塞 */
+            frame_ring_push(&s_capture_ring, camera_frame);
         } else {
             /* 如果获取失败，短暂延时避免CPU占用过高 */
             vTaskDelay(pdMS_TO_TICKS(10));
@@ -122,7 +516,7 @@ static void camera_process_handler(void *arg)
 }
 
 /**
- * @brief       摄像头图像数据传入AI处理任务
+ * @brief       MSR01级：调速、运动门控、跟踪区域裁剪及候选框生成（流水线第二级）
  * @param       arg：未使用
  * @retval      无
  */
@@ -130,8 +524,10 @@ static void ai_process_handler(void *arg)
 {
     arg = arg;
     camera_fb_t *face_ai_frameI = NULL;
+    face_job_t *job = NULL;
+    face_job_t *held_jobs[FACE_PIPE_JOBS];
+    face_feedback_t feedback;
     HumanFaceDetectMSR01 detector(0.3F, 0.3F, 10, 0.3F);
-    HumanFaceDetectMNP01 detector2(0.4F, 0.3F, 10);
     bool watchdog_active = false;
     esp_err_t wdt_ret;
 
@@ -144,9 +540,15 @@ static void ai_process_handler(void *arg)
         ESP_LOGW("AI_Task", "Failed to add to watchdog: %s", esp_err_to_name(wdt_ret));
     }
 
-    /* 添加帧率控制，降低AI推理频率减少CPU负载 */
-    int frame_skip_counter = 0;
-    const int FRAME_SKIP_RATE = 3; // 每4帧处理1帧
+    /* 按实测推理耗时自适应跳帧：无人时降频，接近阈值时升频 */
+    ai_governor_t governor;
+    ai_governor_init(&governor, NULL);
+
+    /* 运动门控：画面静止时跳过推理，复用上次结果（缩略图约2.4KB，不放在任务栈上） */
+    static motion_gate_t motion;
+    motion_gate_init(&motion);
+
+    system_state_register_client(SYSTEM_CLIENT_AI);
 
     while(1)
     {
@@ -163,14 +565,32 @@ static void ai_process_handler(void *arg)
                     watchdog_active = false;
                 }
             }
-            
-            /* 跳过本次处理并释放帧缓冲 */
-            if (xQueueReceive(xQueueFrameO, &face_ai_frameI, 10 / portTICK_PERIOD_MS)) {
-                /* 直接转发到输出队列，不进行AI处理 */
-                xQueueSend(xQueueAIFrameO, &face_ai_frameI, portMAX_DELAY);
+
+            /* 先读采集级确认再出队：确认之前入环的帧此时都已可见，不阻塞即可取空 */
+            bool camera_paused = system_state_client_paused(SYSTEM_CLIENT_CAMERA);
+
+            /* 跳过推理，帧仍经流水线按序送往显示并归还 */
+            face_ai_frameI = frame_ring_pop(&s_capture_ring, camera_paused ? 0 : pdMS_TO_TICKS(100), NULL);
+            if (face_ai_frameI) {
+                xQueueReceive(s_free_jobs, &job, portMAX_DELAY);
+                job->fb = face_ai_frameI;
+                job->kind = FACE_JOB_PASS;
+                xQueueSend(s_msr_queue, &job, portMAX_DELAY);
+                continue;
+            }
+            if (!camera_paused) {
+                continue;
+            }
+
+            /* 帧环已空，收回全部任务单：收齐即说明下游各级都已交出手中的帧 */
+            for (int i = 0; i < FACE_PIPE_JOBS; i++) {
+                xQueueReceive(s_free_jobs, &held_jobs[i], portMAX_DELAY);
+            }
+            system_state_ack_pause(SYSTEM_CLIENT_AI);
+            system_state_wait_resume(SYSTEM_CLIENT_AI);
+            for (int i = 0; i < FACE_PIPE_JOBS; i++) {
+                xQueueSend(s_free_jobs, &held_jobs[i], 0);
             }
-            /* 短暂延时，让主任务有时间处理拍照 */
-            vTaskDelay(100 / portTICK_PERIOD_MS);
             continue;
         } else {
             /* 恢复正常操作时重新加入看门狗 */
@@ -185,62 +605,180 @@ static void ai_process_handler(void *arg)
                 }
             }
         }
-        
+
         /* 重置看门狗，防止AI处理任务超时 - 只有在成功加入看门狗时才重置 */
         if (watchdog_active) {
             esp_task_wdt_reset();
         }
-        
-        /* 以队列的形式获取摄像头图像数据 */
-        if (xQueueReceive(xQueueFrameO, &face_ai_frameI, portMAX_DELAY))
-        {
-            /* 帧率控制 - 跳过一些帧以减少CPU负载 */
-            frame_skip_counter++;
-            if (frame_skip_counter < FRAME_SKIP_RATE) {
-                /* 直接转发帧，不进行AI处理 */
-                xQueueSend(xQueueAIFrameO, &face_ai_frameI, portMAX_DELAY);
-                continue;
-            }
-            frame_skip_counter = 0; // 重置计数器
-            
-            /* 在AI推理前重置看门狗 - 因为推理可能耗时较长 */
-            if (watchdog_active) {
-                esp_task_wdt_reset();
+
+        /* 应用后处理级反馈的推理耗时与距离，调整检测率 */
+        while (xQueueReceive(s_feedback_queue, &feedback, 0)) {
+            ai_governor_on_inference(&governor, feedback.infer_us, feedback.face_present,
+                                     feedback.margin_valid, feedback.margin_cm);
+            if (governor.inferences % AI_GOV_LOG_INFERENCES == 0) {
+                ai_governor_log_stats(&governor);
+
+                /* 统计由MNP01级和后处理级在另一个核上更新，取快照后再输出 */
+                portENTER_CRITICAL(&s_track_lock);
+                face_track_t track = s_track;
+                portEXIT_CRITICAL(&s_track_lock);
+                ESP_LOGI("AI_Task", "Face track: %" PRIu32 " tracked, %" PRIu32 " full, %" PRIu32 " lost",
+                         track.tracked, track.full, track.lost);
+                ESP_LOGI("AI_Task", "Motion gate: %" PRIu32 " checks, %" PRIu32 " inferences skipped, %" PRIu32
+                         " forced by staleness, last %" PRIu32 " cells changed",
+                         motion.checks, motion.skipped, motion.stale, motion.last_changed);
             }
-            
-            /* 判断图像是否出现人脸 - 第一次推理 */
-            std::list<dl::detect::result_t> &detect_candidates = detector.infer((uint16_t *)face_ai_frameI->buf, {(int)face_ai_frameI->height, (int)face_ai_frameI->width, 3});
-            
-            /* 第二次推理 - 添加超时保护 */
-            std::list<dl::detect::result_t> &detect_results = detector2.infer((uint16_t *)face_ai_frameI->buf, {(int)face_ai_frameI->height, (int)face_ai_frameI->width, 3}, detect_candidates);
+        }
 
-            /* 推理完成后重置看门狗 */
-            if (watchdog_active) {
-                esp_task_wdt_reset();
+        /* 从帧环获取最旧的未处理帧，最多等待100ms以便按时喂看门狗 */
+        face_ai_frameI = frame_ring_pop(&s_capture_ring, pdMS_TO_TICKS(100), NULL);
+        if (face_ai_frameI)
+        {
+            /* 流水线中的帧数受任务单数量限制 */
+            xQueueReceive(s_free_jobs, &job, portMAX_DELAY);
+
+            int64_t frame_us = esp_timer_get_time();
+
+            job->fb = face_ai_frameI;
+            job->kind = FACE_JOB_PASS;
+            job->msr_us = 0;
+            job->mnp_us = 0;
+
+            /* 帧率控制 - 由调速器决定本帧是否推理 */
+            if (ai_governor_on_frame(&governor, frame_us)) {
+                /* 画面静止时复用上次结果（标定期间需要新样本，不门控）；须在绘制检测框之前判断 */
+                bool moved = motion_gate_check(&motion, (const uint16_t *)face_ai_frameI->buf,
+                                               face_ai_frameI->width, face_ai_frameI->height, frame_us);
+                if (!moved && is_distance_calibrated()) {
+                    job->kind = FACE_JOB_REUSE;
+                } else {
+                    /* 在AI推理前重置看门狗 - 因为推理可能耗时较长 */
+                    if (watchdog_active) {
+                        esp_task_wdt_reset();
+                    }
+
+                    /* 判断图像是否出现人脸 - 第一次推理（跟踪区域或全图） */
+                    int64_t msr_start_us = esp_timer_get_time();
+                    face_msr_run(detector, job);
+                    job->msr_us = (uint32_t)(esp_timer_get_time() - msr_start_us);
+                    LAT_RECORD(LAT_STAGE_MSR01, msr_start_us);
+                    job->kind = FACE_JOB_INFER;
+
+                    /* 保存参考缩略图，供后续静止帧比较 */
+                    motion_gate_commit(&motion, frame_us);
+                }
             }
 
-            if (detect_results.size() > 0)
-            {
-                printf("Face detected - Count: %d\r\n", (int)detect_results.size());
-                
-                /* 输出人脸关键点信息用于调试 */
-                print_eye_coordinates(detect_results);
-                
-                /* 处理距离检测 */
-                printf("Calling distance detection...\r\n");
-                handle_distance_detection_c(&detect_results, face_ai_frameI);
-                
-                /* 此处是在图像中绘画检测效果 */
-                draw_detection_result((uint16_t *)face_ai_frameI->buf, face_ai_frameI->height, face_ai_frameI->width, detect_results);
+            face_pipe_account(FACE_PIPE_STAGE_MSR, frame_us);
+
+            /* 交给MNP01级，本级立即处理下一帧 */
+            xQueueSend(s_msr_queue, &job, portMAX_DELAY);
+        }
+    }
+}
+
+/**
+ * @brief       MNP01级：细化候选框（流水线第三级，与下一帧的MSR01重叠执行）
+ * @param       arg：未使用
+ * @retval      无
+ */
+static void mnp_process_handler(void *arg)
+{
+    arg = arg;
+    face_job_t *job = NULL;
+    HumanFaceDetectMNP01 detector2(0.4F, 0.3F, 10);
+
+    while (1)
+    {
+        if (xQueueReceive(s_msr_queue, &job, portMAX_DELAY))
+        {
+            int64_t start_us = esp_timer_get_time();
+
+            if (job->kind == FACE_JOB_INFER) {
+                /* 第二次推理 */
+                face_mnp_run(detector2, job);
+                job->mnp_us = (uint32_t)(esp_timer_get_time() - start_us);
+                LAT_RECORD(LAT_STAGE_MNP01, start_us);
             }
-            else
-            {
-                /* 当没有检测到人脸时，处理状态重置和蜂鸣器关闭 */
-                handle_no_face_detected_c();
+
+            face_pipe_account(FACE_PIPE_STAGE_MNP, start_us);
+            xQueueSend(s_post_queue, &job, portMAX_DELAY);
+        }
+    }
+}
+
+/**
+ * @brief       后处理级：距离检测、绘制检测结果并投递显示（流水线第四级）
+ * @param       arg：未使用
+ * @retval      无
+ */
+static void post_process_handler(void *arg)
+{
+    arg = arg;
+    face_job_t *job = NULL;
+    face_result_batch_t batch;
+    std::list<dl::detect::result_t> last_results;
+
+    while (1)
+    {
+        if (xQueueReceive(s_post_queue, &job, portMAX_DELAY))
+        {
+            int64_t start_us = esp_timer_get_time();
+            camera_fb_t *face_ai_frameI = job->fb;
+
+            if (job->kind == FACE_JOB_INFER) {
+                std::list<dl::detect::result_t> &detect_results = job->results;
+
+                if (detect_results.size() > 0)
+                {
+                    TRACE_LOG(TRACE_EV_FACE_COUNT, (int32_t)detect_results.size());
+
+                    /* 输出人脸关键点信息用于调试 */
+                    print_eye_coordinates(detect_results);
+
+                    /* 先存入预录帧环（绘制检测框之前），距离检测触发报警时直接取这一帧 */
+                    pretrigger_ring_record(face_ai_frameI);
+
+                    /* 处理距离检测 - 每帧转换一次定长结果批，下游不再分配内存 */
+                    int64_t lat_start = LAT_STAMP();
+                    face_result_batch_fill(&batch, detect_results, face_ai_frameI);
+                    handle_distance_detection_c(&batch, face_ai_frameI);
+                    LAT_RECORD(LAT_STAGE_DISTANCE, lat_start);
+
+                    /* 此处是在图像中绘画检测效果 */
+                    lat_start = LAT_STAMP();
+                    draw_detection_result((uint16_t *)face_ai_frameI->buf, face_ai_frameI->height, face_ai_frameI->width, detect_results);
+                    LAT_RECORD(LAT_STAGE_DRAW, lat_start);
+                }
+                else
+                {
+                    /* 当没有检测到人脸时，处理状态重置和蜂鸣器关闭 */
+                    handle_no_face_detected_c();
+                }
+
+                /* 保存结果，供静止帧复用 */
+                last_results = detect_results;
+
+                /* 距离更新后把推理耗时与距离余量反馈给调速器；
+                 * 调速器只为core 1做预算，core 0上的MNP01由任务单数量限流 */
+                face_feedback_t feedback;
+                feedback.infer_us = job->msr_us;
+                feedback.face_present = !detect_results.empty();
+                feedback.margin_valid = get_distance_threshold_margin_c(&feedback.margin_cm);
+                xQueueSend(s_feedback_queue, &feedback, 0);
+            } else if (job->kind == FACE_JOB_REUSE && !last_results.empty()) {
+                int64_t lat_start = LAT_STAMP();
+                draw_detection_result((uint16_t *)face_ai_frameI->buf, face_ai_frameI->height, face_ai_frameI->width, last_results);
+                LAT_RECORD(LAT_STAGE_DRAW, lat_start);
             }
-            
-            /* 以队列的形式发送AI处理的图像 */
-            xQueueSend(xQueueAIFrameO, &face_ai_frameI, portMAX_DELAY);
+
+            /* 投递到显示信箱，显示任务只取最新一帧 */
+            lcd_preview_post_frame(face_ai_frameI);
+            job->fb = NULL;
+            xQueueSend(s_free_jobs, &job, portMAX_DELAY);
+
+            face_pipe_account(FACE_PIPE_STAGE_POST, start_us);
+            face_pipe_report(esp_timer_get_time());
         }
     }
 }
@@ -252,17 +790,48 @@ static void ai_process_handler(void *arg)
  */
 uint8_t esp_face_detection_ai_strat(void)
 {
-    /* 创建队列及任务 - 调整栈大小平衡内存使用 */
-    xQueueFrameO = xQueueCreate(5, sizeof(camera_fb_t *));
-    xQueueAIFrameO = xQueueCreate(5, sizeof(camera_fb_t *));
-    xTaskCreatePinnedToCore(camera_process_handler, "cam_task", 6 * 1024, NULL, 5, &camera_task_handle, 1);
-    xTaskCreatePinnedToCore(ai_process_handler, "ai_process_hand", 10 * 1024, NULL, 4, &ai_task_handle, 1);
-
-    if (xQueueFrameO != NULL 
-        || xQueueAIFrameO != NULL 
-        || camera_task_handle != NULL 
-        || ai_task_handle != NULL)
+    /* 创建帧环及队列 - 级间队列深度等于任务单数量，不会阻塞在发送上 */
+    if (frame_ring_init(&s_capture_ring, FACE_PIPE_CAPTURE_RING) != ESP_OK) {
+        return 1;
+    }
+
+    /* 预录帧环分配失败不影响检测，报警时退回暂停摄像头后拍照 */
+    if (pretrigger_ring_init() != ESP_OK) {
+        ESP_LOGW("Pipeline", "Pre-trigger ring unavailable, alarm photos will pause the camera");
+    }
+    s_free_jobs = xQueueCreate(FACE_PIPE_JOBS, sizeof(face_job_t *));
+    s_msr_queue = xQueueCreate(FACE_PIPE_JOBS, sizeof(face_job_t *));
+    s_post_queue = xQueueCreate(FACE_PIPE_JOBS, sizeof(face_job_t *));
+    s_feedback_queue = xQueueCreate(FACE_PIPE_JOBS, sizeof(face_feedback_t));
+
+    if (s_free_jobs == NULL || s_msr_queue == NULL
+        || s_post_queue == NULL || s_feedback_queue == NULL)
+    {
+        return 1;
+    }
+
+    for (int i = 0; i < FACE_PIPE_JOBS; i++) {
+        face_job_t *job = &s_jobs[i];
+        xQueueSend(s_free_jobs, &job, 0);
+    }
+
+    /* 按配置的核心与优先级创建各级任务 - 调整栈大小平衡内存使用 */
+    xTaskCreatePinnedToCore(camera_process_handler, "cam_task", 6 * 1024, NULL,
+                            FACE_PIPE_CAM_PRIO, &camera_task_handle, FACE_PIPE_CAM_CORE);
+    xTaskCreatePinnedToCore(ai_process_handler, "ai_process_hand", 10 * 1024, NULL,
+                            FACE_PIPE_MSR_PRIO, &ai_task_handle, FACE_PIPE_MSR_CORE);
+    xTaskCreatePinnedToCore(mnp_process_handler, "ai_mnp_stage", 8 * 1024, NULL,
+                            FACE_PIPE_MNP_PRIO, &mnp_task_handle, FACE_PIPE_MNP_CORE);
+    xTaskCreatePinnedToCore(post_process_handler, "ai_post_stage", 6 * 1024, NULL,
+                            FACE_PIPE_POST_PRIO, &post_task_handle, FACE_PIPE_POST_CORE);
+
+    if (camera_task_handle != NULL
+        && ai_task_handle != NULL
+        && mnp_task_handle != NULL
+        && post_task_handle != NULL)
     {
+        ESP_LOGI("Pipeline", "capture@core%d, msr01@core%d, mnp01@core%d, post@core%d, %d frames in flight",
+                 FACE_PIPE_CAM_CORE, FACE_PIPE_MSR_CORE, FACE_PIPE_MNP_CORE, FACE_PIPE_POST_CORE, FACE_PIPE_JOBS);
         return 0;
     }
 
@@ -299,24 +868,45 @@ void esp_face_detection_ai_deinit(void)
         ai_task_handle = NULL;
     }
 
-    if (xQueueFrameO != NULL)
-    {
-        vQueueDelete(xQueueFrameO);
-        xQueueFrameO = NULL;
+    /* MNP01级与后处理级未加入看门狗 */
+    if (mnp_task_handle != NULL) {
+        vTaskDelete(mnp_task_handle);
+        mnp_task_handle = NULL;
     }
 
-    if (xQueueAIFrameO != NULL)
-    {
-        vQueueDelete(xQueueAIFrameO);
-        xQueueAIFrameO = NULL;
+    if (post_task_handle != NULL) {
+        vTaskDelete(post_task_handle);
+        post_task_handle = NULL;
+    }
+
+    /* 归还流水线中尚未处理完的帧 */
+    for (int i = 0; i < FACE_PIPE_JOBS; i++) {
+        if (s_jobs[i].fb != NULL) {
+            esp_camera_fb_return(s_jobs[i].fb);
+            s_jobs[i].fb = NULL;
+        }
+        heap_caps_free(s_jobs[i].crop_buf);
+        s_jobs[i].crop_buf = NULL;
+        s_jobs[i].crop_cap = 0;
+    }
+
+    QueueHandle_t *queues[] = {&s_free_jobs, &s_msr_queue, &s_post_queue, &s_feedback_queue};
+    for (size_t i = 0; i < sizeof(queues) / sizeof(queues[0]); i++) {
+        if (*queues[i] != NULL) {
+            vQueueDelete(*queues[i]);
+            *queues[i] = NULL;
+        }
     }
-    
+
+    /* 各级任务已删除，归还帧环中的帧 */
+    frame_ring_flush(&s_capture_ring);
+
     /* 清理距离检测器 */
     deinit_distance_detection_system();
 }
 
 /**
- * @brief       输出左右眼中心坐标
+ * @brief       输出左右眼中心坐标（写入二进制跟踪缓冲，不在调用任务中格式化）
  * @param       results：检测结果
  * @retval      无
  */
@@ -327,22 +917,14 @@ void print_eye_coordinates(std::list<dl::detect::result_t> &results)
     {
         if (prediction->keypoint.size() == 10)
         {
-            // 获取左右眼坐标
-            int left_eye_x = prediction->keypoint[0];
-            int left_eye_y = prediction->keypoint[1];
-            int right_eye_x = prediction->keypoint[6];
-            int right_eye_y = prediction->keypoint[7];
-            
-            // 输出眼部坐标信息
-            printf("=== Face %d Eye Coordinates ===\r\n", face_count + 1);
-            printf("Left Eye Center:  (%3d, %3d)\r\n", left_eye_x, left_eye_y);
-            printf("Right Eye Center: (%3d, %3d)\r\n", right_eye_x, right_eye_y);
-            printf("Eye Distance: %d pixels\r\n", abs(right_eye_x - left_eye_x));
-            printf("================================\r\n");
+            // 记录左右眼坐标（只写入跟踪缓冲，由输出任务格式化）
+            TRACE_LOG(TRACE_EV_FACE_EYES, face_count + 1,
+                      prediction->keypoint[0], prediction->keypoint[1],
+                      prediction->keypoint[6], prediction->keypoint[7]);
         }
         else
         {
-            printf("Face %d: No keypoints detected\r\n", face_count + 1);
+            TRACE_LOG(TRACE_EV_FACE_NO_KEYPOINTS, face_count + 1);
         }
     }
 }
@@ -1,55 +1,69 @@
-/**
- ****************************************************************************************************
- * @file        esp_face_detection.hpp
- * @author      正点原子团队(ALIENTEK)
- * @version     V1.0
- * @date        2023-12-01
- * @brief       人脸识别代码
- * @license     Copyright (c) 2020-2032, 广州市星翼电子科技有限公司
- ****************************************************************************************************
- * @attention
- *
- * 实验平台:正点原子 ESP32-S3 开发板
- * 在线视频:www.yuanzige.com
- * 技术论坛:www.openedv.com
- * 公司网址:www.alientek.com
- * 购买地址:openedv.taobao.com
- *
- ****************************************************************************************************
- */
-
-#ifndef __ESP_FACE_DETECTION_HPP
-#define __ESP_FACE_DETECTION_HPP
-
-#include "esp_camera.h"
-#include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
-#include "freertos/task.h"
-#include "freertos/semphr.h"
-
-// Face distance C interface
-#include "face_distance_c_interface.h"
-
-#ifdef __cplusplus
-#include <list>
-#include "dl_detect_define.hpp"
-extern "C" {
-#endif
-
-extern QueueHandle_t xQueueAIFrameO;
-extern TaskHandle_t camera_task_handle;
-extern TaskHandle_t ai_task_handle;
-
-/* C函数声明 */
-uint8_t esp_face_detection_ai_strat(void);
-void esp_face_detection_ai_deinit(void);
-
-#ifdef __cplusplus
-}
-
-/* C++函数声明 */
-void print_eye_coordinates(std::list<dl::detect::result_t> &results);
-#endif
-
-#endif
+/**
+ ****************************************************************************************************
+ * @file        esp_face_detection.hpp
+ * @author      正点原子团队(ALIENTEK)
+ * @version     V1.0
+ * @date        2023-12-01
+ * @brief       人脸识别代码
+ * @license     Copyright (c) 2020-2032, 广州市星翼电子科技有限公司
+ ****************************************************************************************************
+ * @attention
+ *
+ * 实验平台:正点原子 ESP32-S3 开发板
+ * 在线视频:www.yuanzige.com
+ * 技术论坛:www.openedv.com
+ * 公司网址:www.alientek.com
+ * 购买地址:openedv.taobao.com
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __ESP_FACE_DETECTION_HPP
+#define __ESP_FACE_DETECTION_HPP
+
+#include "esp_camera.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// Face distance C interface
+#include "face_distance_c_interface.h"
+
+#ifdef __cplusplus
+#include <list>
+#include "dl_detect_define.hpp"
+extern "C" {
+#endif
+
+/* 检测流水线：采集 -> MSR01候选 -> MNP01细化 -> 距离检测/绘制，各级独立任务，相邻帧重叠执行 */
+#define FACE_PIPE_CAM_CORE      1           /* 采集级核心 */
+#define FACE_PIPE_CAM_PRIO      5
+#define FACE_PIPE_MSR_CORE      1           /* MSR01级核心 */
+#define FACE_PIPE_MSR_PRIO      4
+#define FACE_PIPE_MNP_CORE      0           /* MNP01级核心，与显示任务同核，优先级低于显示任务 */
+#define FACE_PIPE_MNP_PRIO      4
+#define FACE_PIPE_POST_CORE     0           /* 距离检测/绘制级核心 */
+#define FACE_PIPE_POST_PRIO     5           /* 耗时短，优先于MNP01级以免帧积压 */
+#define FACE_PIPE_JOBS          3           /* 流水线中同时处理的帧数上限 */
+#define FACE_PIPE_CAPTURE_RING  2           /* 采集帧环槽数，满时丢弃最旧帧 */
+#define FACE_PIPE_REPORT_US     10000000    /* 各级吞吐输出周期（us） */
+
+extern TaskHandle_t camera_task_handle;
+extern TaskHandle_t ai_task_handle;
+extern TaskHandle_t mnp_task_handle;
+extern TaskHandle_t post_task_handle;
+
+/* C函数声明 */
+uint8_t esp_face_detection_ai_strat(void);
+void esp_face_detection_ai_deinit(void);
+
+#ifdef __cplusplus
+}
+
+/* C++函数声明 */
+void print_eye_coordinates(std::list<dl::detect::result_t> &results);
+#endif
+
+#endif
@@ -11,13 +11,12 @@
 
 #include "face_distance_c_interface.h"
 #include "face_distance_detector.hpp"
-#include "dl_detect_define.hpp"
 #include "esp_log.h"
 #include "buzzer.h"
 #include "photo_uploader.h"
 #include "system_state_manager.h"
 #include "esp_camera.h"
-#include <list>
+#include "trace_log.h"
 #include <cstring>
 
 static const char *TAG = "FaceDistanceC";
@@ -27,7 +26,6 @@ void* g_distance_detector_handle = nullptr;
 
 // 标定相关变量
 static bool calibration_requested = false;
-static int calibration_frames_collected = 0;
 
 // 状态跟踪变量 - 在函数间共享
 static face_distance_state_t last_alarm_state = FACE_DISTANCE_SAFE;
@@ -94,12 +92,11 @@ void start_distance_calibration(void)
     ESP_LOGI(TAG, "1. Sit directly in front of the camera");
     ESP_LOGI(TAG, "2. Keep your face unobstructed");
     ESP_LOGI(TAG, "3. Maintain exactly 50 cm distance from camera");
-    ESP_LOGI(TAG, "4. Stay still for calibration (20 frames needed)");
+    ESP_LOGI(TAG, "4. Stay still for calibration (stops once stable, at most 20 frames)");
     ESP_LOGI(TAG, "=====================================\r\n");
     
     if (detector->startCalibration() == ESP_OK) {
         calibration_requested = true;
-        calibration_frames_collected = 0;
     } else {
         ESP_LOGE(TAG, "Failed to start calibration");
     }
@@ -120,7 +117,6 @@ void reset_distance_calibration(void)
     if (detector->resetCalibration() == ESP_OK) {
         ESP_LOGI(TAG, "Distance calibration reset successfully");
         calibration_requested = false;
-        calibration_frames_collected = 0;
     } else {
         ESP_LOGE(TAG, "Failed to reset calibration");
     }
@@ -129,96 +125,66 @@ void reset_distance_calibration(void)
 /**
  * @brief 处理人脸检测结果进行距离检测
  */
-void handle_distance_detection_c(void* results, void* camera_frame)
+void handle_distance_detection_c(const face_result_batch_t* results, void* camera_frame)
 {
-    printf("=== Distance detection called ===\r\n");
-    
-    if (g_distance_detector_handle == nullptr) {
-        printf("Distance detector not initialized!\r\n");
+    if (g_distance_detector_handle == nullptr || results == nullptr) {
+        TRACE_LOG(TRACE_EV_DIST_NOT_READY);
         return;
     }
     
     FaceDistanceDetector* detector = static_cast<FaceDistanceDetector*>(g_distance_detector_handle);
-    std::list<dl::detect::result_t>* detect_results = static_cast<std::list<dl::detect::result_t>*>(results);
-    camera_fb_t* current_frame = static_cast<camera_fb_t*>(camera_frame);
+    (void)camera_frame;
     
-    printf("Processing %d faces for distance detection\r\n", (int)detect_results->size());
+    TRACE_LOG(TRACE_EV_DIST_BATCH, (int32_t)results->count);
     
     // 处理标定
-    if (calibration_requested && !detect_results->empty()) {
-        printf("Calibration mode: processing frame\r\n");
-        const auto& face = detect_results->front();
-        if (face.keypoint.size() >= 10) {
-            printf("Face has %d keypoints\r\n", (int)face.keypoint.size());
-            if (detector->addCalibrationFrame(face.keypoint)) {
-                calibration_frames_collected++;
-                ESP_LOGI(TAG, "Calibration frame %d collected", calibration_frames_collected);
-                
-                if (calibration_frames_collected >= 20) {
-                    if (detector->finishCalibration() == ESP_OK) {
-                        ESP_LOGI(TAG, "=== CALIBRATION COMPLETED ===");
-                        calibration_requested = false;
-                        calibration_frames_collected = 0;
-                    } else {
-                        ESP_LOGE(TAG, "=== CALIBRATION FAILED ===");
-                    }
+    if (calibration_requested && results->count > 0) {
+        const face_result_t& face = results->faces[0];
+        if (face.has_keypoints) {
+            // 检测器内部剔除侧脸/离群帧，均值收敛或达到上限帧数后返回true
+            if (detector->addCalibrationFrame(face)) {
+                if (detector->finishCalibration() == ESP_OK) {
+                    ESP_LOGI(TAG, "=== CALIBRATION COMPLETED ===");
+                    calibration_requested = false;
+                } else {
+                    ESP_LOGE(TAG, "=== CALIBRATION FAILED ===");
                 }
-            } else {
-                printf("Failed to add calibration frame\r\n");
             }
         } else {
-            printf("Face has insufficient keypoints: %d\r\n", (int)face.keypoint.size());
+            TRACE_LOG(TRACE_EV_CALIB_NO_KEYPOINTS);
         }
         return;
     }
     
     // 正常距离检测
     if (detector->isCalibrated()) {
-        printf("Detector is calibrated, processing distance...\r\n");
-        face_distance_state_t state = detector->processFrame(*detect_results);
+        face_distance_state_t state = detector->processFrame(*results);
         float distance = detector->getCurrentDistance();
         
-        printf("Current distance: %.1f cm, state: %d\r\n", distance, (int)state);
+        TRACE_LOG(TRACE_EV_DIST_RESULT, TRACE_F(distance), (int32_t)state);
         
         if (state != last_alarm_state) {
-            printf("=== State change: %d -> %d ===\r\n", (int)last_alarm_state, (int)state);
+            TRACE_LOG(TRACE_EV_DIST_STATE, (int32_t)last_alarm_state, (int32_t)state, TRACE_F(distance));
             if (state == FACE_DISTANCE_TOO_CLOSE) {
-                printf("\r\n");
-                printf("🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨\r\n");
-                printf("⚠️  WARNING: FACE TOO CLOSE! ⚠️\r\n");
-                printf("Current Distance: %.1f cm\r\n", distance);
-                printf("Safe Distance: > 48 cm\r\n");
-                printf("Please move back for eye safety!\r\n");
-                printf("🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨🚨\r\n");
-                printf("\r\n");
+                /* 状态变化很少发生，保留一行日志；逐帧信息走二进制跟踪 */
                 ESP_LOGW(TAG, "⚠️  WARNING: FACE TOO CLOSE! Distance: %.1f cm ⚠️", distance);
                 
                 // 开启蜂鸣器报警
-                printf("🔊 Activating buzzer alarm... 🔊\r\n");
                 buzzer_alarm(1);
-                printf("🔊 Buzzer alarm activated! 🔊\r\n");
+                TRACE_LOG(TRACE_EV_BUZZER, 1);
                 
                 // 启动3秒自动关闭定时器
                 system_start_alarm_timeout(3000); // 3秒后自动关闭报警器
                 
                 // 请求异步拍照上传（系统状态管理器将暂停AI任务后进行拍照）
-                printf("📸 Requesting photo upload (will pause AI tasks first)... 📸\r\n");
                 system_request_photo_upload();
-                printf("📸 Photo upload requested successfully 📸\r\n");
                 
             } else {
-                printf("\r\n");
-                printf("✅✅✅✅✅✅✅✅✅✅✅✅✅✅✅✅\r\n");
-                printf("✅ Face distance is now SAFE ✅\r\n");
-                printf("Current Distance: %.1f cm\r\n", distance);
-                printf("✅✅✅✅✅✅✅✅✅✅✅✅✅✅✅✅\r\n");
-                printf("\r\n");
                 ESP_LOGI(TAG, "✅ Face distance is now safe. Distance: %.1f cm", distance);
                 
                 // 关闭蜂鸣器报警
-                printf("🔇 Deactivating buzzer alarm... 🔇\r\n");
                 buzzer_alarm(0);
-                printf("🔇 Buzzer alarm deactivated 🔇\r\n");
+                TRACE_LOG(TRACE_EV_BUZZER, 0);
                 
                 // 停止报警超时计时
                 system_stop_alarm_timeout();
@@ -228,18 +194,16 @@ void handle_distance_detection_c(void* results, void* camera_frame)
             // 持续警告
             static int warning_counter = 0;
             if (++warning_counter % 10 == 0) {  // 每10帧显示一次持续警告
-                printf("⚠️  STILL TOO CLOSE: %.1f cm - Move back! ⚠️\r\n", distance);
+                TRACE_LOG(TRACE_EV_DIST_STILL_CLOSE, TRACE_F(distance));
             }
         }
     } else {
         static int reminder_counter = 0;
         if (++reminder_counter % 100 == 0) { // 每100帧提醒一次
-            printf("Distance detector not calibrated (reminder %d)\r\n", reminder_counter / 100);
+            TRACE_LOG(TRACE_EV_DIST_UNCALIBRATED, reminder_counter / 100);
             ESP_LOGI(TAG, "Distance detector not calibrated. Use start_distance_calibration() to calibrate.");
         }
     }
-    
-    printf("=== Distance detection finished ===\r\n");
 }
 
 /**
@@ -252,7 +216,6 @@ void handle_no_face_detected_c(void)
     
     // 记录没有检测到人脸
     if (!no_face_logged) {
-        printf("No face detected - resetting alarm state\r\n");
         ESP_LOGI(TAG, "No face detected - checking alarm state");
         no_face_logged = true;
         no_face_counter = 0;
@@ -262,24 +225,56 @@ void handle_no_face_detected_c(void)
     
     // 如果之前是警报状态，现在关闭蜂鸣器
     if (last_alarm_state == FACE_DISTANCE_TOO_CLOSE) {
-        printf("\r\n");
-        printf("🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇\r\n");
-        printf("🔇 NO FACE DETECTED - ALARM OFF 🔇\r\n");
-        printf("Face left camera view, deactivating alarm\r\n");
-        printf("🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇🔇\r\n");
-        printf("\r\n");
         ESP_LOGI(TAG, "🔇 Face left camera view - deactivating alarm");
         
         // 关闭蜂鸣器报警
-        printf("🔇 Deactivating buzzer alarm (no face)... 🔇\r\n");
         buzzer_alarm(0);
-        printf("🔇 Buzzer alarm deactivated (no face) 🔇\r\n");
+        TRACE_LOG(TRACE_EV_NO_FACE_ALARM_OFF);
         
         last_alarm_state = FACE_DISTANCE_SAFE;
     }
     
     // 每50帧提醒一次没有检测到人脸
     if (no_face_counter % 50 == 0) {
-        printf("No face detected for %d frames\r\n", no_face_counter);
+        TRACE_LOG(TRACE_EV_NO_FACE, no_face_counter);
+    }
+}
+
+/**
+ * @brief 获取当前距离与进入过近阈值的余量（用于调节检测频率）
+ */
+bool get_distance_threshold_margin_c(float* margin_cm)
+{
+    if (g_distance_detector_handle == nullptr || margin_cm == nullptr) {
+        return false;
+    }
+
+    FaceDistanceDetector* detector = static_cast<FaceDistanceDetector*>(g_distance_detector_handle);
+    return detector->getThresholdMargin(margin_cm);
+}
+
+/**
+ * @brief 运行时切换距离滤波器
+ */
+esp_err_t set_distance_filter_c(face_distance_filter_t filter)
+{
+    if (g_distance_detector_handle == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    FaceDistanceDetector* detector = static_cast<FaceDistanceDetector*>(g_distance_detector_handle);
+    return detector->setFilter(filter);
+}
+
+/**
+ * @brief 获取当前使用的距离滤波器
+ */
+face_distance_filter_t get_distance_filter_c(void)
+{
+    if (g_distance_detector_handle == nullptr) {
+        return FACE_DISTANCE_FILTER_DEFAULT;
     }
+
+    FaceDistanceDetector* detector = static_cast<FaceDistanceDetector*>(g_distance_detector_handle);
+    return detector->getFilter();
 }
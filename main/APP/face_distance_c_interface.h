@@ -13,6 +13,7 @@
 #define __FACE_DISTANCE_C_INTERFACE_H
 
 #include "esp_err.h"
+#include "face_result.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -27,6 +28,21 @@ typedef enum {
     FACE_DISTANCE_TOO_CLOSE = 1 /*!< 过近状态 */
 } face_distance_state_t;
 
+/**
+ * @brief 距离平滑滤波器类型
+ */
+typedef enum {
+    FACE_DISTANCE_FILTER_MOVING_AVG = 0,    /*!< 7帧滑动平均（原有行为） */
+    FACE_DISTANCE_FILTER_ONE_EURO = 1,      /*!< One-Euro自适应低通 */
+    FACE_DISTANCE_FILTER_KALMAN = 2,        /*!< 匀速模型卡尔曼 */
+    FACE_DISTANCE_FILTER_COUNT
+} face_distance_filter_t;
+
+/* 上电默认使用的滤波器：回放轨迹上卡尔曼在各场景的报警延迟均不差于滑动平均，且无误报 */
+#ifndef FACE_DISTANCE_FILTER_DEFAULT
+#define FACE_DISTANCE_FILTER_DEFAULT    FACE_DISTANCE_FILTER_KALMAN
+#endif
+
 /* 全局距离检测器指针 */
 extern void* g_distance_detector_handle;
 
@@ -61,10 +77,10 @@ void reset_distance_calibration(void);
 
 /**
  * @brief 处理人脸检测结果进行距离检测
- * @param results 人脸检测结果列表
+ * @param results 本帧人脸检测结果
  * @param camera_frame 当前摄像头帧（用于拍照上传）
  */
-void handle_distance_detection_c(void* results, void* camera_frame);
+void handle_distance_detection_c(const face_result_batch_t* results, void* camera_frame);
 
 /**
  * @brief 处理没有检测到人脸的情况
@@ -72,6 +88,29 @@ void handle_distance_detection_c(void* results, void* camera_frame);
  */
 void handle_no_face_detected_c(void);
 
+/**
+ * @brief 获取当前距离与进入过近阈值的余量（用于调节检测频率）
+ * @param margin_cm 输出：平滑距离减去进入阈值(cm)，负数表示已过近
+ * @retval true 有效
+ * @retval false 未初始化、未标定或尚无距离数据
+ */
+bool get_distance_threshold_margin_c(float* margin_cm);
+
+/**
+ * @brief 运行时切换距离滤波器（各滤波器持续接收测量，切换后无需重新预热）
+ * @param filter 滤波器类型
+ * @retval ESP_OK 成功
+ * @retval ESP_ERR_INVALID_ARG 类型无效
+ * @retval ESP_ERR_INVALID_STATE 检测器未初始化
+ */
+esp_err_t set_distance_filter_c(face_distance_filter_t filter);
+
+/**
+ * @brief 获取当前使用的距离滤波器
+ * @retval 滤波器类型，未初始化时返回默认值
+ */
+face_distance_filter_t get_distance_filter_c(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,13 @@
  */
 
 #include "face_distance_detector.hpp"
+#include "trace_log.h"
+#include "persist_store.h"
+#include "nvs.h"
+#include "esp_rom_crc.h"
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
 
 static const char *TAG = "FaceDistanceDetector";
 
@@ -29,8 +36,16 @@ FaceDistanceDetector::FaceDistanceDetector()
     : k_constant_(0.0f)
     , is_calibrated_(false)
     , current_state_(FACE_DISTANCE_SAFE)
+    , filter_one_euro_(ONE_EURO_MIN_CUTOFF_HZ, ONE_EURO_BETA, ONE_EURO_D_CUTOFF_HZ)
+    , filter_kalman_(KALMAN_ACCEL_VAR, KALMAN_MEAS_VAR)
+    , filter_mode_(FACE_DISTANCE_FILTER_DEFAULT)
+    , calibration_rejects_(0)
     , calibration_in_progress_(false)
 {
+    filters_[FACE_DISTANCE_FILTER_MOVING_AVG] = &filter_avg_;
+    filters_[FACE_DISTANCE_FILTER_ONE_EURO] = &filter_one_euro_;
+    filters_[FACE_DISTANCE_FILTER_KALMAN] = &filter_kalman_;
+    
     // 初始化姿态校正参数
     correction_params_.min_ratio = 0.7f;      // 头部左转时的最小比例
     correction_params_.max_ratio = 1.3f;      // 头部右转时的最大比例
@@ -51,25 +66,23 @@ FaceDistanceDetector::~FaceDistanceDetector()
  */
 esp_err_t FaceDistanceDetector::init()
 {
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(ret);
-    
-    // 从NVS加载标定数据
-    ret = loadFromNVS();
+    // NVS已在app_main中初始化，这里只在启动时读取一次标定数据
+    esp_err_t ret = loadCalibration();
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "No calibration data found, please calibrate first");
         is_calibrated_ = false;
     }
     
-    // 初始化滤波队列
-    while (!filter_queue_.empty()) {
-        filter_queue_.pop();
+    // 恢复上次选择的滤波器
+    uint32_t filter = 0;
+    if (persist_get_u32(NVS_SETTINGS_NAMESPACE, NVS_FILTER_KEY, &filter) == ESP_OK &&
+        filter < FACE_DISTANCE_FILTER_COUNT) {
+        filter_mode_.store((face_distance_filter_t)filter, std::memory_order_relaxed);
     }
     
+    // 初始化滤波器
+    resetFilters();
+    
     ESP_LOGI(TAG, "Face distance detector initialized. Calibrated: %s", 
              is_calibrated_ ? "Yes" : "No");
     
@@ -79,13 +92,9 @@ esp_err_t FaceDistanceDetector::init()
 /**
  * @brief 计算双眼内眼角距离
  */
-float FaceDistanceDetector::calculateEyeDistance(const std::vector<int>& keypoints)
+float FaceDistanceDetector::calculateEyeDistance(const int* keypoints)
 {
-    if (keypoints.size() < 8) {
-        ESP_LOGW(TAG, "Insufficient keypoints for eye distance calculation");
-        return -1.0f;
-    }
-    
+
     // 左眼中心: keypoints[0], keypoints[1]
     // 右眼中心: keypoints[6], keypoints[7]
     float left_eye_x = keypoints[0];
@@ -102,13 +111,9 @@ float FaceDistanceDetector::calculateEyeDistance(const std::vector<int>& keypoin
 /**
  * @brief 计算偏航比例 (用于姿态感知)
  */
-float FaceDistanceDetector::calculateYawRatio(const std::vector<int>& keypoints)
+float FaceDistanceDetector::calculateYawRatio(const int* keypoints)
 {
-    if (keypoints.size() < 10) {
-        ESP_LOGW(TAG, "Insufficient keypoints for yaw ratio calculation");
-        return 1.0f; // 默认正面
-    }
-    
+
     // 左眼中心: keypoints[0], keypoints[1]
     // 右眼中心: keypoints[6], keypoints[7]  
     // 鼻子: keypoints[4], keypoints[5]
@@ -160,36 +165,32 @@ float FaceDistanceDetector::getPoseCorrection(float yaw_ratio)
 }
 
 /**
- * @brief 更新滤波队列
+ * @brief 更新滤波器
+ * @note 所有滤波器都接收测量（每个只有几次浮点运算），运行时切换后立即可用
  */
-void FaceDistanceDetector::updateFilterQueue(float distance)
+void FaceDistanceDetector::updateFilters(float distance, int64_t timestamp_us)
 {
-    filter_queue_.push(distance);
-    
-    // 保持队列大小
-    while (filter_queue_.size() > FILTER_QUEUE_SIZE) {
-        filter_queue_.pop();
+    for (int i = 0; i < FACE_DISTANCE_FILTER_COUNT; i++) {
+        filters_[i]->update(distance, timestamp_us);
     }
 }
 
 /**
- * @brief 获取平滑距离
+ * @brief 清空所有滤波器
  */
-float FaceDistanceDetector::getSmoothedDistance()
+void FaceDistanceDetector::resetFilters()
 {
-    if (filter_queue_.empty()) {
-        return -1.0f;
-    }
-    
-    float sum = 0.0f;
-    std::queue<float> temp_queue = filter_queue_;
-    
-    while (!temp_queue.empty()) {
-        sum += temp_queue.front();
-        temp_queue.pop();
+    for (int i = 0; i < FACE_DISTANCE_FILTER_COUNT; i++) {
+        filters_[i]->reset();
     }
-    
-    return sum / filter_queue_.size();
+}
+
+/**
+ * @brief 获取平滑距离
+ */
+float FaceDistanceDetector::getSmoothedDistance() const
+{
+    return filters_[getFilter()]->value();
 }
 
 /**
@@ -201,28 +202,116 @@ esp_err_t FaceDistanceDetector::startCalibration()
     ESP_LOGI(TAG, "Please face the camera directly and sit %.1f cm away", KNOWN_DISTANCE_CM);
     
     calibration_samples_.clear();
+    calibration_samples_.reserve(CALIBRATION_FRAMES); // 预留容量，采集过程中不再分配
+    calibration_scratch_.reserve(CALIBRATION_FRAMES);
+    calibration_stats_.clear();
+    calibration_rejects_ = 0;
     calibration_in_progress_ = true;
     
     return ESP_OK;
 }
 
+/**
+ * @brief 计算中位数（会打乱输入顺序）
+ */
+static float calibration_median(std::vector<float>& v)
+{
+    size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    float upper = v[mid];
+    if (v.size() & 1) {
+        return upper;
+    }
+    return 0.5f * (upper + *std::max_element(v.begin(), v.begin() + mid));
+}
+
+/**
+ * @brief 判断标定样本是否离群（偏离中位数超过K倍MAD稳健标准差）
+ */
+bool FaceDistanceDetector::isCalibrationOutlier(float eye_distance)
+{
+    if ((int)calibration_samples_.size() < CALIBRATION_MAD_MIN_FRAMES) {
+        return false;
+    }
+    
+    calibration_scratch_.assign(calibration_samples_.begin(), calibration_samples_.end());
+    float median = calibration_median(calibration_scratch_);
+    
+    for (float& s : calibration_scratch_) {
+        s = fabsf(s - median);
+    }
+    float sigma = 1.4826f * calibration_median(calibration_scratch_);
+    if (sigma < CALIBRATION_MAD_FLOOR_PX) {
+        sigma = CALIBRATION_MAD_FLOOR_PX;
+    }
+    
+    return fabsf(eye_distance - median) > CALIBRATION_MAD_K * sigma;
+}
+
+/**
+ * @brief 均值95%置信区间半宽与均值之比
+ * @note t分位数用Cornish-Fisher一阶近似 t ≈ z + (z^3 + z) / (4·df)
+ */
+float FaceDistanceDetector::getCalibrationRelativeCi() const
+{
+    const RunningStats& st = calibration_stats_;
+    if (st.n < 2 || st.mean <= 0.0f) {
+        return INFINITY;
+    }
+    
+    const float z = 1.96f;
+    float t = z + (z * z * z + z) / (4.0f * (st.n - 1));
+    return t * sqrtf(st.variance() / st.n) / st.mean;
+}
+
 /**
  * @brief 添加标定帧数据
  */
-bool FaceDistanceDetector::addCalibrationFrame(const std::vector<int>& keypoints)
+bool FaceDistanceDetector::addCalibrationFrame(const face_result_t& face)
 {
-    if (!calibration_in_progress_) {
+    if (!calibration_in_progress_ || !face.has_keypoints) {
         return false;
     }
     
-    float eye_distance = calculateEyeDistance(keypoints);
-    if (eye_distance > 0) {
-        calibration_samples_.push_back(eye_distance);
-        ESP_LOGD(TAG, "Calibration sample %d/%d: %.2f pixels", 
-                 calibration_samples_.size(), CALIBRATION_FRAMES, eye_distance);
+    float eye_distance = calculateEyeDistance(face.keypoint);
+    if (eye_distance <= 0) {
+        return false;
     }
     
-    return calibration_samples_.size() >= CALIBRATION_FRAMES;
+    // 侧脸时双眼间距被压缩，直接剔除
+    float yaw_ratio = calculateYawRatio(face.keypoint);
+    if (fabsf(yaw_ratio - 1.0f) > CALIBRATION_MAX_YAW_DEV) {
+        TRACE_LOG(TRACE_EV_CALIB_REJECTED, 1, TRACE_F(yaw_ratio));
+        return false;
+    }
+    
+    // 眨眼、抖动等造成的离群值
+    if (isCalibrationOutlier(eye_distance)) {
+        TRACE_LOG(TRACE_EV_CALIB_REJECTED, 2, TRACE_F(eye_distance));
+        if (++calibration_rejects_ > CALIBRATION_MAX_REJECTS) {
+            // 连续被剔除说明用户位置已改变，以当前位置重新采集
+            ESP_LOGW(TAG, "Too many calibration outliers, restarting sample collection");
+            calibration_samples_.clear();
+            calibration_stats_.clear();
+            calibration_rejects_ = 0;
+        }
+        return false;
+    }
+    
+    calibration_rejects_ = 0;
+    calibration_samples_.push_back(eye_distance);
+    calibration_stats_.add(eye_distance);
+    
+    float rel_ci = getCalibrationRelativeCi();
+    TRACE_LOG(TRACE_EV_CALIB_SAMPLE, calibration_stats_.n, TRACE_F(eye_distance), TRACE_F(rel_ci * 100.0f));
+    
+    if (calibration_stats_.n >= CALIBRATION_MIN_FRAMES && rel_ci <= CALIBRATION_REL_TOLERANCE) {
+        ESP_LOGI(TAG, "Calibration converged after %d frames (CI +/-%.2f%%)", 
+                 calibration_stats_.n, rel_ci * 100.0f);
+        return true;
+    }
+    
+    return calibration_stats_.n >= CALIBRATION_FRAMES;
 }
 
 /**
@@ -235,24 +324,36 @@ esp_err_t FaceDistanceDetector::finishCalibration()
         return ESP_FAIL;
     }
     
-    // 计算平均值
-    float sum = 0.0f;
+    // 前几帧在启用MAD之前被接受，这里用全部样本的中位数/MAD再剔除一次后求均值
+    calibration_scratch_.assign(calibration_samples_.begin(), calibration_samples_.end());
+    float median = calibration_median(calibration_scratch_);
+    for (float& s : calibration_scratch_) {
+        s = fabsf(s - median);
+    }
+    float sigma = std::max(1.4826f * calibration_median(calibration_scratch_), CALIBRATION_MAD_FLOOR_PX);
+    
+    RunningStats final_stats;
+    final_stats.clear();
     for (float sample : calibration_samples_) {
-        sum += sample;
+        if (fabsf(sample - median) <= CALIBRATION_MAD_K * sigma) {
+            final_stats.add(sample);
+        }
     }
-    float avg_eye_distance = sum / calibration_samples_.size();
+    float avg_eye_distance = final_stats.n > 0 ? final_stats.mean : median;
     
     // 计算K常数
     k_constant_ = KNOWN_DISTANCE_CM * avg_eye_distance;
     
-    ESP_LOGI(TAG, "Calibration completed. K constant: %.2f", k_constant_);
+    ESP_LOGI(TAG, "Calibration completed. K constant: %.2f (%d/%d samples, eye distance %.2f +/- %.2f px)", 
+             k_constant_, final_stats.n, (int)calibration_samples_.size(), 
+             avg_eye_distance, sqrtf(final_stats.variance()));
     
-    // 保存到NVS
-    esp_err_t ret = saveToNVS();
+    // 交给后台任务写入，不在AI任务中等待Flash
+    esp_err_t ret = saveCalibration(avg_eye_distance, sqrtf(final_stats.variance()), final_stats.n);
     if (ret == ESP_OK) {
         is_calibrated_ = true;
         calibration_in_progress_ = false;
-        ESP_LOGI(TAG, "Calibration data saved successfully");
+        ESP_LOGI(TAG, "Calibration data queued for saving");
     } else {
         ESP_LOGE(TAG, "Failed to save calibration data");
     }
@@ -263,22 +364,22 @@ esp_err_t FaceDistanceDetector::finishCalibration()
 /**
  * @brief 处理一帧人脸数据
  */
-face_distance_state_t FaceDistanceDetector::processFrame(const std::list<dl::detect::result_t>& results)
+face_distance_state_t FaceDistanceDetector::processFrame(const face_result_batch_t& results)
 {
     if (!is_calibrated_) {
         ESP_LOGW(TAG, "Detector not calibrated, please calibrate first");
         return current_state_;
     }
     
-    if (results.empty()) {
+    if (results.count == 0) {
         // 没有检测到人脸，保持当前状态
         return current_state_;
     }
     
     // 使用第一个检测到的人脸
-    const auto& face = results.front();
+    const face_result_t& face = results.faces[0];
     
-    if (face.keypoint.size() < 10) {
+    if (!face.has_keypoints) {
         ESP_LOGW(TAG, "Insufficient keypoints in detection result");
         return current_state_;
     }
@@ -298,8 +399,8 @@ face_distance_state_t FaceDistanceDetector::processFrame(const std::list<dl::det
     // 距离解算
     float raw_distance = k_constant_ / corrected_eye_distance;
     
-    // 数据滤波
-    updateFilterQueue(raw_distance);
+    // 数据滤波（使用帧采集时间，帧间隔随调速器变化）
+    updateFilters(raw_distance, results.timestamp_us);
     float smoothed_distance = getSmoothedDistance();
     
     // 状态决策
@@ -311,8 +412,9 @@ face_distance_state_t FaceDistanceDetector::processFrame(const std::list<dl::det
         ESP_LOGI(TAG, "Face distance safe. Distance: %.1f cm", smoothed_distance);
     }
     
-    ESP_LOGD(TAG, "Distance: %.1f cm, Yaw ratio: %.2f, Correction: %.2f", 
-             smoothed_distance, yaw_ratio, correction_factor);
+    ESP_LOGD(TAG, "Distance: %.1f cm (raw %.1f, window %.1f-%.1f, var %.2f), Yaw ratio: %.2f, Correction: %.2f", 
+             smoothed_distance, raw_distance, filter_avg_.window().min(), filter_avg_.window().max(),
+             filter_avg_.window().variance(), yaw_ratio, correction_factor);
     
     return current_state_;
 }
@@ -322,113 +424,131 @@ face_distance_state_t FaceDistanceDetector::processFrame(const std::list<dl::det
  */
 float FaceDistanceDetector::getCurrentDistance() const
 {
-    return const_cast<FaceDistanceDetector*>(this)->getSmoothedDistance();
+    return getSmoothedDistance();
 }
 
 /**
- * @brief 保存到NVS
+ * @brief 获取当前距离与进入过近阈值的余量
  */
-esp_err_t FaceDistanceDetector::saveToNVS()
+bool FaceDistanceDetector::getThresholdMargin(float* margin_cm) const
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Error opening NVS handle: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    ret = nvs_set_blob(nvs_handle, NVS_K_CONSTANT_KEY, &k_constant_, sizeof(k_constant_));
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Error saving K constant: %s", esp_err_to_name(ret));
-        nvs_close(nvs_handle);
-        return ret;
+    float distance = getCurrentDistance();
+    if (!is_calibrated_ || distance < 0.0f) {
+        return false;
     }
-    
-    uint8_t calibrated = 1;
-    ret = nvs_set_u8(nvs_handle, NVS_CALIBRATED_KEY, calibrated);
+
+    *margin_cm = distance - ENTER_THRESHOLD_CM;
+    return true;
+}
+
+/**
+ * @brief 计算标定数据的CRC（不含crc字段本身）
+ */
+static uint32_t calibration_blob_crc(const face_calibration_blob_t& blob)
+{
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&blob), offsetof(face_calibration_blob_t, crc));
+}
+
+/**
+ * @brief 保存标定数据（挂起到persist_store，由后台任务合并写入）
+ */
+esp_err_t FaceDistanceDetector::saveCalibration(float eye_distance_px, float eye_distance_sd_px, int samples)
+{
+    face_calibration_blob_t blob = {};
+    blob.version = CALIB_BLOB_VERSION;
+    blob.size = sizeof(blob);
+    blob.k_constant = k_constant_;
+    blob.eye_distance_px = eye_distance_px;
+    blob.eye_distance_sd_px = eye_distance_sd_px;
+    blob.samples = (uint16_t)samples;
+    blob.crc = calibration_blob_crc(blob);
+    
+    esp_err_t ret = persist_set_blob(NVS_NAMESPACE, NVS_CALIB_BLOB_KEY, &blob, sizeof(blob));
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Error saving calibration flag: %s", esp_err_to_name(ret));
-        nvs_close(nvs_handle);
-        return ret;
+        ESP_LOGE(TAG, "Error queueing calibration data: %s", esp_err_to_name(ret));
     }
     
-    ret = nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
-    
     return ret;
 }
 
 /**
- * @brief 从NVS加载
+ * @brief 启动时加载标定数据
  */
-esp_err_t FaceDistanceDetector::loadFromNVS()
+esp_err_t FaceDistanceDetector::loadCalibration()
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Error opening NVS handle: %s", esp_err_to_name(ret));
-        return ret;
-    }
+    face_calibration_blob_t blob = {};
+    size_t size = sizeof(blob);
+    esp_err_t ret = persist_get_blob(NVS_NAMESPACE, NVS_CALIB_BLOB_KEY, &blob, &size);
     
-    size_t required_size = sizeof(k_constant_);
-    ret = nvs_get_blob(nvs_handle, NVS_K_CONSTANT_KEY, &k_constant_, &required_size);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return loadLegacyCalibration();
+    }
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "K constant not found in NVS");
-        nvs_close(nvs_handle);
+        ESP_LOGW(TAG, "Error reading calibration data: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    uint8_t calibrated = 0;
-    ret = nvs_get_u8(nvs_handle, NVS_CALIBRATED_KEY, &calibrated);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Calibration flag not found in NVS");
-        nvs_close(nvs_handle);
-        return ret;
+    if (size != sizeof(blob) || blob.version != CALIB_BLOB_VERSION || blob.size != sizeof(blob) ||
+        blob.crc != calibration_blob_crc(blob) || blob.k_constant <= 0.0f) {
+        ESP_LOGW(TAG, "Calibration data invalid (version %u, size %u), please recalibrate", 
+                 (unsigned)blob.version, (unsigned)size);
+        return ESP_ERR_INVALID_VERSION;
     }
     
-    is_calibrated_ = (calibrated == 1);
-    nvs_close(nvs_handle);
+    k_constant_ = blob.k_constant;
+    is_calibrated_ = true;
     
-    ESP_LOGI(TAG, "Loaded calibration data: K=%.2f, Calibrated=%s", 
-             k_constant_, is_calibrated_ ? "Yes" : "No");
+    ESP_LOGI(TAG, "Loaded calibration data: K=%.2f (eye distance %.2f +/- %.2f px, %u samples)", 
+             k_constant_, blob.eye_distance_px, blob.eye_distance_sd_px, (unsigned)blob.samples);
     
     return ESP_OK;
 }
 
 /**
- * @brief 重置标定
+ * @brief 加载旧版分键保存的标定数据，并迁移为新的标定blob
  */
-esp_err_t FaceDistanceDetector::resetCalibration()
+esp_err_t FaceDistanceDetector::loadLegacyCalibration()
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Error opening NVS handle: %s", esp_err_to_name(ret));
-        return ret;
+    float k_constant = 0.0f;
+    size_t size = sizeof(k_constant);
+    esp_err_t ret = persist_get_blob(NVS_NAMESPACE, NVS_K_CONSTANT_KEY, &k_constant, &size);
+    if (ret != ESP_OK || size != sizeof(k_constant) || k_constant <= 0.0f) {
+        return ret != ESP_OK ? ret : ESP_ERR_INVALID_SIZE;
     }
     
-    ret = nvs_erase_all(nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Error erasing NVS: %s", esp_err_to_name(ret));
-        nvs_close(nvs_handle);
-        return ret;
-    }
+    k_constant_ = k_constant;
+    is_calibrated_ = true;
+    ESP_LOGI(TAG, "Loaded legacy calibration data: K=%.2f, migrating", k_constant_);
     
-    ret = nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
+    // 擦除旧键后写入新格式，两者在同一批中按顺序落盘
+    persist_erase_namespace(NVS_NAMESPACE);
+    saveCalibration(k_constant_ / KNOWN_DISTANCE_CM, 0.0f, 0);
     
+    return ESP_OK;
+}
+
+/**
+ * @brief 重置标定
+ */
+esp_err_t FaceDistanceDetector::resetCalibration()
+{
+    // 内存状态立即生效，NVS擦除交给后台任务
     k_constant_ = 0.0f;
     is_calibrated_ = false;
     current_state_ = FACE_DISTANCE_SAFE;
     
-    // 清空滤波队列
-    while (!filter_queue_.empty()) {
-        filter_queue_.pop();
+    // 清空滤波器
+    resetFilters();
+    
+    esp_err_t ret = persist_erase_namespace(NVS_NAMESPACE);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Error queueing calibration erase: %s", esp_err_to_name(ret));
+        return ret;
     }
     
     ESP_LOGI(TAG, "Calibration reset successfully");
     
-    return ret;
+    return ESP_OK;
 }
 
 /**
@@ -442,6 +562,23 @@ void FaceDistanceDetector::setThresholds(float enter_threshold, float exit_thres
              enter_threshold, exit_threshold);
 }
 
+/**
+ * @brief 切换距离滤波器
+ */
+esp_err_t FaceDistanceDetector::setFilter(face_distance_filter_t filter)
+{
+    if ((unsigned)filter >= FACE_DISTANCE_FILTER_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (filter_mode_.exchange(filter, std::memory_order_relaxed) != filter) {
+        // 记住选择，下次启动沿用
+        persist_set_u32(NVS_SETTINGS_NAMESPACE, NVS_FILTER_KEY, (uint32_t)filter);
+    }
+    ESP_LOGI(TAG, "Distance filter set to %d", (int)filter);
+    return ESP_OK;
+}
+
 // C接口实现
 extern "C" {
 
@@ -477,9 +614,11 @@ esp_err_t face_distance_detector_start_calibration(FaceDistanceDetector* detecto
 
 bool face_distance_detector_add_calibration_frame(FaceDistanceDetector* detector, const int* keypoints, int keypoints_size)
 {
-    if (!detector || !keypoints) return false;
-    std::vector<int> kp(keypoints, keypoints + keypoints_size);
-    return detector->addCalibrationFrame(kp);
+    if (!detector || !keypoints || keypoints_size < FACE_RESULT_KEYPOINTS) return false;
+    face_result_t face = {};
+    face.has_keypoints = true;
+    memcpy(face.keypoint, keypoints, sizeof(face.keypoint));
+    return detector->addCalibrationFrame(face);
 }
 
 esp_err_t face_distance_detector_finish_calibration(FaceDistanceDetector* detector)
@@ -25,15 +25,12 @@
 
 #ifdef __cplusplus
 #include <vector>
-#include <list>
-#include <queue>
 #include <cmath>
-#include "dl_detect_define.hpp"
+#include <atomic>
+#include "distance_filter.hpp"
 #endif
 
 #include "esp_log.h"
-#include "nvs_flash.h"
-#include "nvs.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -108,6 +105,20 @@ typedef struct {
     float max_correction; /*!< 最大校正系数 */
 } pose_correction_params_t;
 
+/**
+ * @brief 标定数据（整体作为一个NVS blob保存，版本或长度不符时视为未标定）
+ */
+typedef struct {
+    uint16_t version;         /*!< 结构版本 */
+    uint16_t size;            /*!< 结构长度 */
+    float k_constant;         /*!< 标定常数 */
+    float eye_distance_px;    /*!< 标定时的平均眼距 */
+    float eye_distance_sd_px; /*!< 标定时眼距的标准差 */
+    uint16_t samples;         /*!< 参与平均的样本数 */
+    uint16_t reserved;
+    uint32_t crc;             /*!< 以上字段的CRC32 */
+} face_calibration_blob_t;
+
 /**
  * @brief 人脸距离检测器类
  */
@@ -117,29 +128,50 @@ private:
     static constexpr float KNOWN_DISTANCE_CM = 50.0f;     /*!< 标定距离 */
     static constexpr float ENTER_THRESHOLD_CM = 45.0f;    /*!< 进入过近状态阈值 - 调整为45cm便于测试 */
     static constexpr float EXIT_THRESHOLD_CM = 48.0f;     /*!< 退出过近状态阈值 - 调整为48cm便于测试 */
-    static constexpr int FILTER_QUEUE_SIZE = 7;           /*!< 滤波队列大小 */
-    static constexpr int CALIBRATION_FRAMES = 20;         /*!< 标定帧数 */
+    static constexpr int FILTER_QUEUE_SIZE = 7;           /*!< 滑动平均窗口大小 */
+    static constexpr float ONE_EURO_MIN_CUTOFF_HZ = 0.3f; /*!< One-Euro静止截止频率 */
+    static constexpr float ONE_EURO_BETA = 0.005f;        /*!< One-Euro速度系数 */
+    static constexpr float ONE_EURO_D_CUTOFF_HZ = 0.5f;   /*!< One-Euro速度截止频率 */
+    static constexpr float KALMAN_ACCEL_VAR = 50.0f;      /*!< 卡尔曼加速度方差((cm/s^2)^2) */
+    static constexpr float KALMAN_MEAS_VAR = 9.0f;        /*!< 卡尔曼测量方差(cm^2) */
+    static constexpr int CALIBRATION_FRAMES = 20;         /*!< 标定帧数上限（未收敛时按此结束） */
+    static constexpr int CALIBRATION_MIN_FRAMES = 8;      /*!< 提前结束前至少接受的帧数 */
+    static constexpr float CALIBRATION_REL_TOLERANCE = 0.015f; /*!< 均值95%置信区间半宽/均值 低于此值即收敛 */
+    static constexpr float CALIBRATION_MAX_YAW_DEV = 0.15f;   /*!< 偏航比例偏离1超过此值的帧视为侧脸 */
+    static constexpr int CALIBRATION_MAD_MIN_FRAMES = 5;  /*!< 接受帧数达到此值后启用MAD离群剔除 */
+    static constexpr float CALIBRATION_MAD_K = 3.5f;      /*!< 离群阈值：偏离中位数超过K倍稳健标准差 */
+    static constexpr float CALIBRATION_MAD_FLOOR_PX = 0.5f; /*!< 稳健标准差下限(像素)，避免样本过于一致时误剔 */
+    static constexpr int CALIBRATION_MAX_REJECTS = 10;    /*!< 连续剔除帧数上限，超过则认为位置已变，重新采集 */
     
-    // NVS存储键
+    // NVS存储键（经persist_store异步写入）
     static constexpr char NVS_NAMESPACE[] = "face_dist";
-    static constexpr char NVS_K_CONSTANT_KEY[] = "k_const";
-    static constexpr char NVS_CALIBRATED_KEY[] = "calibrated";
+    static constexpr char NVS_CALIB_BLOB_KEY[] = "calib";
+    static constexpr char NVS_K_CONSTANT_KEY[] = "k_const";       /*!< 旧版单独保存的K常数，仅用于迁移 */
+    static constexpr char NVS_SETTINGS_NAMESPACE[] = "face_cfg";  /*!< 设置不随标定重置而擦除 */
+    static constexpr char NVS_FILTER_KEY[] = "filter";
+    static constexpr uint16_t CALIB_BLOB_VERSION = 1;
     
     // 内部状态
     float k_constant_;                    /*!< 标定常数 */
     bool is_calibrated_;                  /*!< 是否已标定 */
     face_distance_state_t current_state_; /*!< 当前系统状态 */
-    std::queue<float> filter_queue_;      /*!< 滤波队列 */
+    MovingAverageFilter<FILTER_QUEUE_SIZE> filter_avg_; /*!< 滑动平均（也提供窗口统计） */
+    OneEuroFilter filter_one_euro_;       /*!< One-Euro滤波 */
+    KalmanCvFilter filter_kalman_;        /*!< 卡尔曼滤波 */
+    DistanceFilter* filters_[FACE_DISTANCE_FILTER_COUNT]; /*!< 按类型索引 */
+    std::atomic<face_distance_filter_t> filter_mode_; /*!< 当前输出所用的滤波器 */
     pose_correction_params_t correction_params_; /*!< 姿态校正参数 */
     
     // 内部方法
-    float calculateEyeDistance(const std::vector<int>& keypoints);
-    float calculateYawRatio(const std::vector<int>& keypoints);
+    float calculateEyeDistance(const int* keypoints);
+    float calculateYawRatio(const int* keypoints);
     float getPoseCorrection(float yaw_ratio);
-    float getSmoothedDistance();
-    void updateFilterQueue(float distance);
-    esp_err_t saveToNVS();
-    esp_err_t loadFromNVS();
+    float getSmoothedDistance() const;
+    void updateFilters(float distance, int64_t timestamp_us);
+    void resetFilters();
+    esp_err_t saveCalibration(float eye_distance_px, float eye_distance_sd_px, int samples);
+    esp_err_t loadCalibration();
+    esp_err_t loadLegacyCalibration();
     
 public:
     /**
@@ -175,11 +207,12 @@ public:
     
     /**
      * @brief 添加标定帧数据
-     * @param keypoints 人脸关键点数据
-     * @retval true 标定完成
+     * @note 侧脸帧与离群帧被剔除；接受帧数达到下限且均值置信区间足够窄时提前完成
+     * @param face 人脸检测结果（需含关键点）
+     * @retval true 已收集足够数据，可调用finishCalibration()
      * @retval false 需要更多帧
      */
-    bool addCalibrationFrame(const std::vector<int>& keypoints);
+    bool addCalibrationFrame(const face_result_t& face);
     
     /**
      * @brief 完成标定
@@ -190,10 +223,10 @@ public:
     
     /**
      * @brief 处理一帧人脸数据
-     * @param results 人脸检测结果
+     * @param results 本帧人脸检测结果
      * @retval 当前系统状态
      */
-    face_distance_state_t processFrame(const std::list<dl::detect::result_t>& results);
+    face_distance_state_t processFrame(const face_result_batch_t& results);
     
     /**
      * @brief 获取当前状态
@@ -207,6 +240,14 @@ public:
      */
     float getCurrentDistance() const;
     
+    /**
+     * @brief 获取当前距离与进入过近阈值的余量
+     * @param margin_cm 输出：平滑距离减去进入阈值(cm)，负数表示已过近
+     * @retval true 有效（已标定且有距离数据）
+     * @retval false 无效
+     */
+    bool getThresholdMargin(float* margin_cm) const;
+    
     /**
      * @brief 重置标定
      * @retval ESP_OK 成功
@@ -220,10 +261,48 @@ public:
      * @param exit_threshold 退出阈值
      */
     void setThresholds(float enter_threshold, float exit_threshold);
+    
+    /**
+     * @brief 切换距离滤波器（可在其他任务中调用）
+     * @param filter 滤波器类型
+     * @retval ESP_OK 成功
+     * @retval ESP_ERR_INVALID_ARG 类型无效
+     */
+    esp_err_t setFilter(face_distance_filter_t filter);
+    
+    /**
+     * @brief 获取当前滤波器类型
+     */
+    face_distance_filter_t getFilter() const { return filter_mode_.load(std::memory_order_relaxed); }
 
 private:
+    /**
+     * @brief Welford在线均值/方差
+     */
+    struct RunningStats {
+        int n;
+        float mean;
+        float m2;
+        
+        void clear() { n = 0; mean = 0.0f; m2 = 0.0f; }
+        void add(float x)
+        {
+            n++;
+            float delta = x - mean;
+            mean += delta / n;
+            m2 += delta * (x - mean);
+        }
+        float variance() const { return n > 1 ? m2 / (n - 1) : 0.0f; }
+    };
+    
+    bool isCalibrationOutlier(float eye_distance);
+    float getCalibrationRelativeCi() const;
+    
     // 标定相关
-    std::vector<float> calibration_samples_; /*!< 标定样本 */
+    std::vector<float> calibration_samples_; /*!< 已接受的标定样本（用于中位数/MAD） */
+    std::vector<float> calibration_scratch_; /*!< 求中位数用的临时副本 */
+    RunningStats calibration_stats_;         /*!< 已接受样本的在线统计 */
+    int calibration_rejects_;                /*!< 连续被剔除的帧数 */
     bool calibration_in_progress_;           /*!< 标定进行中标志 */
 };
 
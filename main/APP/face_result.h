@@ -0,0 +1,37 @@
+#ifndef __FACE_RESULT_H__
+#define __FACE_RESULT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FACE_RESULT_MAX_FACES       4       /* 每帧最多保存的人脸数，超出部分丢弃 */
+#define FACE_RESULT_KEYPOINTS       10      /* 5个关键点的x/y坐标 */
+
+/**
+ * @brief       单个人脸检测结果（帧坐标）
+ */
+typedef struct {
+    int box[4];                             /*!< 人脸框：左上x, 左上y, 右下x, 右下y */
+    float score;                            /*!< 置信度 */
+    bool has_keypoints;                     /*!< keypoint是否有效 */
+    int keypoint[FACE_RESULT_KEYPOINTS];    /*!< 左眼(0,1) 左嘴角(2,3) 鼻尖(4,5) 右眼(6,7) 右嘴角(8,9) */
+} face_result_t;
+
+/**
+ * @brief       一帧的人脸检测结果（定长POD，可在C/C++之间直接传递，无需堆分配）
+ */
+typedef struct {
+    int64_t timestamp_us;                   /*!< 帧采集时间（esp_timer时间基准） */
+    uint32_t count;                         /*!< 有效人脸数 */
+    face_result_t faces[FACE_RESULT_MAX_FACES];
+} face_result_batch_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FACE_RESULT_H__ */
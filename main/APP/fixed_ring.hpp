@@ -0,0 +1,146 @@
+#ifndef __FIXED_RING_HPP__
+#define __FIXED_RING_HPP__
+
+#include <stddef.h>
+#include <type_traits>
+
+/**
+ * @brief       定长滑动窗口：满后新值覆盖最旧值，均值/最值/方差均为O(1)（均摊）
+ * @note        数据与最值候选都放在对象内的定长数组中，push不分配内存。
+ *              最值用单调队列维护；浮点累加和每N次写入重算一次，避免长时间运行的舍入漂移
+ */
+template <typename T, size_t N>
+class FixedRing {
+    static_assert(N > 0, "FixedRing capacity must be positive");
+
+public:
+    FixedRing() { clear(); }
+
+    /**
+     * @brief       清空窗口
+     */
+    void clear()
+    {
+        pos_ = 0;
+        count_ = 0;
+        pushes_ = 0;
+        sum_ = T();
+        sum_sq_ = T();
+        min_.clear();
+        max_.clear();
+    }
+
+    /**
+     * @brief       写入新值，窗口已满时丢弃最旧值
+     * @param       v: 新值
+     */
+    void push(T v)
+    {
+        if (count_ == N) {
+            T old = buf_[pos_];
+            sum_ -= old;
+            sum_sq_ -= old * old;
+            /* 被覆盖的槽是窗口中最旧的，若仍是候选则必在队首 */
+            if (min_.len && min_.front() == pos_) {
+                min_.pop_front();
+            }
+            if (max_.len && max_.front() == pos_) {
+                max_.pop_front();
+            }
+        } else {
+            count_++;
+        }
+
+        buf_[pos_] = v;
+        sum_ += v;
+        sum_sq_ += v * v;
+
+        while (min_.len && buf_[min_.back()] > v) {
+            min_.pop_back();
+        }
+        min_.push_back(pos_);
+        while (max_.len && buf_[max_.back()] < v) {
+            max_.pop_back();
+        }
+        max_.push_back(pos_);
+
+        pos_ = (pos_ + 1) % N;
+
+        if (std::is_floating_point<T>::value && ++pushes_ >= N) {
+            resync();
+        }
+    }
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == N; }
+
+    /**
+     * @brief       按时间顺序访问，0为最旧值
+     */
+    T operator[](size_t i) const { return buf_[(pos_ + N - count_ + i) % N]; }
+    T oldest() const { return (*this)[0]; }
+    T newest() const { return buf_[(pos_ + N - 1) % N]; }
+
+    T sum() const { return sum_; }
+    T mean() const { return count_ ? sum_ / (T)count_ : T(); }
+    T min() const { return min_.len ? buf_[min_.front()] : T(); }
+    T max() const { return max_.len ? buf_[max_.front()] : T(); }
+
+    /**
+     * @brief       总体方差（除以n），窗口为空时为0
+     */
+    T variance() const
+    {
+        if (count_ == 0) {
+            return T();
+        }
+        T m = sum_ / (T)count_;
+        T var = sum_sq_ / (T)count_ - m * m;
+        return var > T() ? var : T();
+    }
+
+private:
+    /**
+     * @brief       单调队列：按写入顺序保存候选槽号，容量与窗口相同
+     */
+    struct Wedge {
+        size_t idx[N];
+        size_t first;
+        size_t len;
+
+        void clear() { first = 0; len = 0; }
+        size_t front() const { return idx[first]; }
+        size_t back() const { return idx[(first + len - 1) % N]; }
+        void pop_front() { first = (first + 1) % N; len--; }
+        void pop_back() { len--; }
+        void push_back(size_t i) { idx[(first + len) % N] = i; len++; }
+    };
+
+    /**
+     * @brief       由窗口数据重算累加和
+     */
+    void resync()
+    {
+        pushes_ = 0;
+        sum_ = T();
+        sum_sq_ = T();
+        for (size_t i = 0; i < count_; i++) {
+            T v = (*this)[i];
+            sum_ += v;
+            sum_sq_ += v * v;
+        }
+    }
+
+    T buf_[N];
+    size_t pos_;        /* 下一次写入的槽 */
+    size_t count_;
+    size_t pushes_;     /* 距上次重算的写入次数 */
+    T sum_;
+    T sum_sq_;
+    Wedge min_;
+    Wedge max_;
+};
+
+#endif /* __FIXED_RING_HPP__ */
@@ -0,0 +1,147 @@
+#include "frame_ring.h"
+#include "esp_timer.h"
+#include <string.h>
+#include <stdbool.h>
+
+/**
+ * @brief       初始化帧环
+ * @param       ring: 帧环
+ * @param       size: 槽数（1 ~ FRAME_RING_MAX_SIZE），1即只保留最新一帧
+ * @retval      ESP_OK: 成功, ESP_ERR_INVALID_ARG: 槽数无效
+ */
+esp_err_t frame_ring_init(frame_ring_t *ring, uint32_t size)
+{
+    if (!ring || size == 0 || size > FRAME_RING_MAX_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->size = size;
+    return ESP_OK;
+}
+
+/**
+ * @brief       入队一帧（仅生产者调用），环满时丢弃最旧帧并用esp_camera_fb_return归还
+ * @note        帧的所有权转交给帧环
+ * @param       ring: 帧环
+ * @param       fb: 摄像头帧
+ * @retval      本帧的代号
+ */
+uint32_t frame_ring_push(frame_ring_t *ring, camera_fb_t *fb)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    /* 环满：与消费者争夺最旧帧，争到则由生产者归还；争不到说明消费者刚取走，槽已空出 */
+    if (head - tail >= ring->size) {
+        camera_fb_t *oldest = ring->slots[tail % ring->size].fb;
+        if (__atomic_compare_exchange_n(&ring->tail, &tail, tail + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            esp_camera_fb_return(oldest);
+            ring->stats.dropped++;
+        }
+    }
+
+    frame_ring_slot_t *slot = &ring->slots[head % ring->size];
+    slot->fb = fb;
+    slot->gen = head;
+    slot->enqueue_us = esp_timer_get_time();
+
+    /* 槽内容写完后再发布head */
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    ring->stats.pushed++;
+
+    TaskHandle_t consumer = __atomic_load_n(&ring->consumer, __ATOMIC_ACQUIRE);
+    if (consumer) {
+        xTaskNotifyGive(consumer);
+    }
+
+    return head;
+}
+
+/**
+ * @brief       尝试出队一帧
+ * @param       ring: 帧环
+ * @param       out: 输出槽内容
+ * @retval      true: 成功, false: 环为空
+ */
+static bool frame_ring_try_pop(frame_ring_t *ring, frame_ring_slot_t *out)
+{
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    while (tail != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+        *out = ring->slots[tail % ring->size];
+
+        /* CAS成功说明读到的槽未被生产者丢弃或覆盖；失败时tail已更新为最新值，重试 */
+        if (__atomic_compare_exchange_n(&ring->tail, &tail, tail + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief       出队最旧的一帧（仅消费者调用），为空时等待生产者通知
+ * @param       ring: 帧环
+ * @param       timeout: 最长等待时间（tick）
+ * @param       gen: 输出帧代号，可为NULL；代号不连续说明中间有帧被丢弃
+ * @retval      帧指针，超时返回NULL；所有权转交给调用者
+ */
+camera_fb_t *frame_ring_pop(frame_ring_t *ring, TickType_t timeout, uint32_t *gen)
+{
+    frame_ring_slot_t slot;
+
+    if (!ring->consumer) {
+        __atomic_store_n(&ring->consumer, xTaskGetCurrentTaskHandle(), __ATOMIC_RELEASE);
+    }
+
+    if (!frame_ring_try_pop(ring, &slot)) {
+        /* 通知可能早于本次等待到达（计数型），被唤醒后再试一次 */
+        if (!ulTaskNotifyTake(pdTRUE, timeout) || !frame_ring_try_pop(ring, &slot)) {
+            return NULL;
+        }
+    }
+
+    uint32_t residency = (uint32_t)(esp_timer_get_time() - slot.enqueue_us);
+    ring->stats.popped++;
+    ring->stats.residency_us += residency;
+    if (residency > ring->stats.residency_max_us) {
+        ring->stats.residency_max_us = residency;
+    }
+
+    if (gen) {
+        *gen = slot.gen;
+    }
+
+    return slot.fb;
+}
+
+/**
+ * @brief       清空帧环并归还所有帧（生产者与消费者都已停止时调用）
+ * @param       ring: 帧环
+ * @retval      无
+ */
+void frame_ring_flush(frame_ring_t *ring)
+{
+    while (ring->tail != ring->head) {
+        esp_camera_fb_return(ring->slots[ring->tail % ring->size].fb);
+        ring->tail++;
+    }
+
+    ring->consumer = NULL;
+}
+
+/**
+ * @brief       获取帧环统计
+ * @param       ring: 帧环
+ * @param       stats: 输出
+ * @retval      无
+ */
+void frame_ring_get_stats(const frame_ring_t *ring, frame_ring_stats_t *stats)
+{
+    if (stats) {
+        *stats = ring->stats;
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef __FRAME_RING_H__
+#define __FRAME_RING_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_RING_MAX_SIZE     8       /* 环形缓冲最大槽数 */
+
+/**
+ * @brief       帧槽：帧指针、代号（生产序号）与入队时间
+ */
+typedef struct {
+    camera_fb_t *fb;
+    uint32_t gen;
+    int64_t enqueue_us;
+} frame_ring_slot_t;
+
+/**
+ * @brief       帧环统计
+ */
+typedef struct {
+    uint32_t pushed;            /*!< 入队帧数 */
+    uint32_t popped;            /*!< 出队帧数 */
+    uint32_t dropped;           /*!< 满时丢弃的最旧帧数（已归还摄像头驱动） */
+    uint64_t residency_us;      /*!< 出队帧在环中停留时间之和 */
+    uint32_t residency_max_us;  /*!< 最长停留时间 */
+} frame_ring_stats_t;
+
+/**
+ * @brief       单生产者/单消费者无锁帧环，满时丢弃最旧帧
+ * @note        head只由生产者推进；tail由消费者出队推进，生产者丢弃最旧帧时也用CAS推进，
+ *              双方以CAS争夺同一帧，成功者获得其所有权。字段由__atomic内建函数访问，C/C++均可包含
+ */
+typedef struct {
+    frame_ring_slot_t slots[FRAME_RING_MAX_SIZE];
+    uint32_t size;              /*!< 槽数 */
+    uint32_t head;              /*!< 下一个写入序号（即下一帧的代号） */
+    uint32_t tail;              /*!< 下一个读取序号 */
+    TaskHandle_t consumer;      /*!< 消费者任务，入队后通知 */
+    frame_ring_stats_t stats;   /*!< pushed/dropped由生产者写，其余由消费者写 */
+} frame_ring_t;
+
+/**
+ * @brief       初始化帧环
+ * @param       ring: 帧环
+ * @param       size: 槽数（1 ~ FRAME_RING_MAX_SIZE），1即只保留最新一帧
+ * @retval      ESP_OK: 成功, ESP_ERR_INVALID_ARG: 槽数无效
+ */
+esp_err_t frame_ring_init(frame_ring_t *ring, uint32_t size);
+
+/**
+ * @brief       入队一帧（仅生产者调用），环满时丢弃最旧帧并用esp_camera_fb_return归还
+ * @note        帧的所有权转交给帧环
+ * @param       ring: 帧环
+ * @param       fb: 摄像头帧
+ * @retval      本帧的代号
+ */
+uint32_t frame_ring_push(frame_ring_t *ring, camera_fb_t *fb);
+
+/**
+ * @brief       出队最旧的一帧（仅消费者调用），为空时等待生产者通知
+ * @param       ring: 帧环
+ * @param       timeout: 最长等待时间（tick）
+ * @param       gen: 输出帧代号，可为NULL；代号不连续说明中间有帧被丢弃
+ * @retval      帧指针，超时返回NULL；所有权转交给调用者
+ */
+camera_fb_t *frame_ring_pop(frame_ring_t *ring, TickType_t timeout, uint32_t *gen);
+
+/**
+ * @brief       清空帧环并归还所有帧（生产者与消费者都已停止时调用）
+ * @param       ring: 帧环
+ * @retval      无
+ */
+void frame_ring_flush(frame_ring_t *ring);
+
+/**
+ * @brief       获取帧环统计
+ * @param       ring: 帧环
+ * @param       stats: 输出
+ * @retval      无
+ */
+void frame_ring_get_stats(const frame_ring_t *ring, frame_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_RING_H__ */
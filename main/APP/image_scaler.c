@@ -1,5 +1,7 @@
 #include "image_scaler.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /**
  * @brief       RGB565图像缩放函数（最近邻插值，速度更快）
@@ -38,8 +40,42 @@ int scale_rgb565_nearest(const uint16_t* src_buf, int src_width, int src_height,
     return 0;
 }
 
+/* R/B通道打包到一个32位字：R位于[16:20]，B位于[0:4]，乘以Q8权重后互不溢出 */
+#define RGB565_RB_LANE(p)   ((((uint32_t)(p) & 0xF800u) << 5) | ((uint32_t)(p) & 0x001Fu))
+/* G通道单独一个32位字 */
+#define RGB565_G_LANE(p)    (((uint32_t)(p) >> 5) & 0x3Fu)
+/* 大端存放的像素（摄像头帧缓冲/LCD数据顺序）与本机顺序互换 */
+#define RGB565_SWAP(p)      ((uint16_t)(((p) << 8) | ((p) >> 8)))
+
+/**
+ * @brief       Q8定点双线性混合四个相邻像素
+ * @param       p00/p10: 上一行左/右像素
+ * @param       p01/p11: 下一行左/右像素
+ * @param       fx/fy: 水平/垂直插值权重（0~255，Q8）
+ * @retval      混合后的RGB565像素
+ */
+static inline uint16_t rgb565_blend_q8(uint16_t p00, uint16_t p10, uint16_t p01, uint16_t p11,
+                                       uint32_t fx, uint32_t fy)
+{
+    /* 四个权重之和恒为256，避免逐项重复计算(1 - diff) */
+    uint32_t w11 = (fx * fy + 128) >> 8;
+    uint32_t w10 = fx - w11;
+    uint32_t w01 = fy - w11;
+    uint32_t w00 = 256 - fx - fy + w11;
+
+    uint32_t rb = RGB565_RB_LANE(p00) * w00 + RGB565_RB_LANE(p10) * w10 +
+                  RGB565_RB_LANE(p01) * w01 + RGB565_RB_LANE(p11) * w11 + 0x00800080u;
+    uint32_t g  = RGB565_G_LANE(p00) * w00 + RGB565_G_LANE(p10) * w10 +
+                  RGB565_G_LANE(p01) * w01 + RGB565_G_LANE(p11) * w11 + 0x80u;
+
+    rb >>= 8;
+    g >>= 8;
+
+    return (uint16_t)((((rb >> 16) & 0x1Fu) << 11) | ((g & 0x3Fu) << 5) | (rb & 0x1Fu));
+}
+
 /**
- * @brief       RGB565图像缩放函数（双线性插值）
+ * @brief       RGB565图像缩放函数（双线性插值，Q8定点实现）
  * @param       src_buf: 源图像缓冲区（RGB565格式）
  * @param       src_width: 源图像宽度
  * @param       src_height: 源图像高度
@@ -56,6 +92,67 @@ int scale_rgb565_bilinear(const uint16_t* src_buf, int src_width, int src_height
         return -1;
     }
 
+    /* 源坐标 = 目标坐标 * (src - 1) / dst，以Q8表示；用商/余数累加代替逐像素除法 */
+    const uint32_t x_num = (uint32_t)(src_width - 1) << 8;
+    const uint32_t y_num = (uint32_t)(src_height - 1) << 8;
+    const uint32_t x_step = x_num / dst_width, x_rem = x_num % dst_width;
+    const uint32_t y_step = y_num / dst_height, y_rem = y_num % dst_height;
+
+    uint32_t y_q8 = 0, y_err = 0;
+
+    for (int i = 0; i < dst_height; i++) {
+        int y1 = (int)(y_q8 >> 8);
+        int y2 = (y1 + 1 < src_height) ? y1 + 1 : src_height - 1;
+        uint32_t fy = y_q8 & 0xFF;
+        const uint16_t *row0 = src_buf + (size_t)y1 * src_width;
+        const uint16_t *row1 = src_buf + (size_t)y2 * src_width;
+        uint16_t *dst_row = dst_buf + (size_t)i * dst_width;
+
+        uint32_t x_q8 = 0, x_err = 0;
+
+        for (int j = 0; j < dst_width; j++) {
+            int x1 = (int)(x_q8 >> 8);
+            int x2 = (x1 + 1 < src_width) ? x1 + 1 : src_width - 1;
+
+            dst_row[j] = rgb565_blend_q8(row0[x1], row0[x2], row1[x1], row1[x2], x_q8 & 0xFF, fy);
+
+            x_q8 += x_step;
+            x_err += x_rem;
+            if (x_err >= (uint32_t)dst_width) {
+                x_err -= dst_width;
+                x_q8++;
+            }
+        }
+
+        y_q8 += y_step;
+        y_err += y_rem;
+        if (y_err >= (uint32_t)dst_height) {
+            y_err -= dst_height;
+            y_q8++;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       RGB565图像缩放函数（双线性插值，浮点参考实现，仅用于精度对比）
+ * @param       src_buf: 源图像缓冲区（RGB565格式）
+ * @param       src_width: 源图像宽度
+ * @param       src_height: 源图像高度
+ * @param       dst_buf: 目标图像缓冲区（RGB565格式）
+ * @param       dst_width: 目标图像宽度
+ * @param       dst_height: 目标图像高度
+ * @retval      0: 成功, -1: 失败
+ */
+int scale_rgb565_bilinear_float(const uint16_t* src_buf, int src_width, int src_height,
+                               uint16_t* dst_buf, int dst_width, int dst_height)
+{
+    if (!src_buf || !dst_buf || src_width <= 0 || src_height <= 0 || 
+        dst_width <= 0 || dst_height <= 0) {
+        return -1;
+    }
+
     float x_ratio = (float)(src_width - 1) / dst_width;
     float y_ratio = (float)(src_height - 1) / dst_height;
 
@@ -127,3 +224,230 @@ int scale_rgb565_bilinear(const uint16_t* src_buf, int src_width, int src_height
 
     return 0;
 }
+
+/**
+ * @brief       准备缩放映射表，源/目标尺寸与上次相同时直接返回
+ * @param       map: 映射表（首次使用前需清零）
+ * @param       src_width: 源图像宽度
+ * @param       src_height: 源图像高度
+ * @param       dst_width: 目标图像宽度
+ * @param       dst_height: 目标图像高度
+ * @retval      0: 成功, -1: 失败
+ */
+int rgb565_scale_map_prepare(rgb565_scale_map_t *map, int src_width, int src_height,
+                             int dst_width, int dst_height)
+{
+    if (!map || src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0 ||
+        src_width > UINT16_MAX || src_height > UINT16_MAX) {
+        return -1;
+    }
+
+    /* 尺寸未变化，沿用缓存的映射表 */
+    if (map->x_index && map->y_index && map->mode == RGB565_SCALE_NEAREST &&
+        map->src_width == src_width && map->src_height == src_height &&
+        map->dst_width == dst_width && map->dst_height == dst_height) {
+        return 0;
+    }
+
+    rgb565_scale_map_release(map);
+
+    map->x_index = (uint16_t *)malloc(dst_width * sizeof(uint16_t));
+    map->y_index = (uint16_t *)malloc(dst_height * sizeof(uint16_t));
+    if (!map->x_index || !map->y_index) {
+        rgb565_scale_map_release(map);
+        return -1;
+    }
+
+    /* 与原逐像素计算保持一致：src = dst * src_size / dst_size，每个几何尺寸只算一次 */
+    for (int j = 0; j < dst_width; j++) {
+        int px = (int)(((int64_t)j * src_width) / dst_width);
+        map->x_index[j] = (uint16_t)(px >= src_width ? src_width - 1 : px);
+    }
+
+    for (int i = 0; i < dst_height; i++) {
+        int py = (int)(((int64_t)i * src_height) / dst_height);
+        map->y_index[i] = (uint16_t)(py >= src_height ? src_height - 1 : py);
+    }
+
+    map->src_width = src_width;
+    map->src_height = src_height;
+    map->dst_width = dst_width;
+    map->dst_height = dst_height;
+    map->mode = RGB565_SCALE_NEAREST;
+
+    return 0;
+}
+
+/**
+ * @brief       准备双线性缩放映射表（Q8权重），参数与缓存规则同rgb565_scale_map_prepare
+ * @param       byte_swapped: 1表示像素按大端字节序存放（摄像头帧缓冲/LCD数据顺序）
+ * @retval      0: 成功, -1: 失败
+ */
+int rgb565_scale_map_prepare_bilinear(rgb565_scale_map_t *map, int src_width, int src_height,
+                                      int dst_width, int dst_height, int byte_swapped)
+{
+    if (!map || src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0 ||
+        src_width > UINT16_MAX || src_height > UINT16_MAX) {
+        return -1;
+    }
+
+    if (map->x_index && map->y_index && map->mode == RGB565_SCALE_BILINEAR &&
+        map->byte_swapped == (byte_swapped ? 1 : 0) &&
+        map->src_width == src_width && map->src_height == src_height &&
+        map->dst_width == dst_width && map->dst_height == dst_height) {
+        return 0;
+    }
+
+    rgb565_scale_map_release(map);
+
+    map->x_index = (uint16_t *)malloc(dst_width * sizeof(uint16_t));
+    map->y_index = (uint16_t *)malloc(dst_height * sizeof(uint16_t));
+    map->x_frac = (uint8_t *)malloc(dst_width);
+    map->y_frac = (uint8_t *)malloc(dst_height);
+    if (!map->x_index || !map->y_index || !map->x_frac || !map->y_frac) {
+        rgb565_scale_map_release(map);
+        return -1;
+    }
+
+    /* 与浮点参考实现相同的采样位置：src = dst * (src_size - 1) / dst_size，取Q8 */
+    for (int j = 0; j < dst_width; j++) {
+        uint32_t q8 = (uint32_t)((((int64_t)j * (src_width - 1)) << 8) / dst_width);
+        map->x_index[j] = (uint16_t)(q8 >> 8);
+        map->x_frac[j] = (uint8_t)(q8 & 0xFF);
+    }
+
+    for (int i = 0; i < dst_height; i++) {
+        uint32_t q8 = (uint32_t)((((int64_t)i * (src_height - 1)) << 8) / dst_height);
+        map->y_index[i] = (uint16_t)(q8 >> 8);
+        map->y_frac[i] = (uint8_t)(q8 & 0xFF);
+    }
+
+    map->src_width = src_width;
+    map->src_height = src_height;
+    map->dst_width = dst_width;
+    map->dst_height = dst_height;
+    map->mode = RGB565_SCALE_BILINEAR;
+    map->byte_swapped = byte_swapped ? 1 : 0;
+
+    return 0;
+}
+
+/**
+ * @brief       释放缩放映射表
+ * @param       map: 映射表
+ * @retval      无
+ */
+void rgb565_scale_map_release(rgb565_scale_map_t *map)
+{
+    if (!map) {
+        return;
+    }
+
+    free(map->x_index);
+    free(map->y_index);
+    free(map->x_frac);
+    free(map->y_frac);
+    memset(map, 0, sizeof(*map));
+}
+
+/**
+ * @brief       按映射表对若干目标行做最近邻缩放（无除法，重复行直接memcpy）
+ * @param       map: 已准备好的映射表
+ * @param       src_buf: 源图像缓冲区（RGB565格式）
+ * @param       dst_buf: 目标行缓冲区，存放rows行、每行dst_width个像素
+ * @param       dst_y: 起始目标行
+ * @param       rows: 行数
+ * @retval      0: 成功, -1: 失败
+ */
+int scale_rgb565_nearest_rows(const rgb565_scale_map_t *map, const uint16_t *src_buf,
+                              uint16_t *dst_buf, int dst_y, int rows)
+{
+    if (!map || !map->x_index || !map->y_index || !src_buf || !dst_buf ||
+        map->mode != RGB565_SCALE_NEAREST ||
+        dst_y < 0 || rows <= 0 || dst_y + rows > map->dst_height) {
+        return -1;
+    }
+
+    const int dst_width = map->dst_width;
+    const uint16_t *x_index = map->x_index;
+    const size_t row_bytes = (size_t)dst_width * sizeof(uint16_t);
+
+    for (int i = 0; i < rows; i++) {
+        uint16_t *dst_row = dst_buf + (size_t)i * dst_width;
+        int src_y = map->y_index[dst_y + i];
+
+        /* 放大时相邻目标行映射到同一源行，直接复制上一行 */
+        if (i > 0 && src_y == map->y_index[dst_y + i - 1]) {
+            memcpy(dst_row, dst_row - dst_width, row_bytes);
+            continue;
+        }
+
+        const uint16_t *src_row = src_buf + (size_t)src_y * map->src_width;
+        int j = 0;
+
+        for (; j + 4 <= dst_width; j += 4) {
+            dst_row[j]     = src_row[x_index[j]];
+            dst_row[j + 1] = src_row[x_index[j + 1]];
+            dst_row[j + 2] = src_row[x_index[j + 2]];
+            dst_row[j + 3] = src_row[x_index[j + 3]];
+        }
+
+        for (; j < dst_width; j++) {
+            dst_row[j] = src_row[x_index[j]];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       按双线性映射表对若干目标行做Q8定点插值（R/B与G分两条32位通道并行计算）
+ * @param       map: 由rgb565_scale_map_prepare_bilinear准备的映射表
+ * @param       src_buf: 源图像缓冲区（RGB565格式）
+ * @param       dst_buf: 目标行缓冲区，存放rows行、每行dst_width个像素
+ * @param       dst_y: 起始目标行
+ * @param       rows: 行数
+ * @retval      0: 成功, -1: 失败
+ */
+int scale_rgb565_bilinear_rows(const rgb565_scale_map_t *map, const uint16_t *src_buf,
+                               uint16_t *dst_buf, int dst_y, int rows)
+{
+    if (!map || !map->x_index || !map->y_index || !map->x_frac || !map->y_frac ||
+        !src_buf || !dst_buf || map->mode != RGB565_SCALE_BILINEAR ||
+        dst_y < 0 || rows <= 0 || dst_y + rows > map->dst_height) {
+        return -1;
+    }
+
+    const int src_width = map->src_width;
+    const int dst_width = map->dst_width;
+    const uint16_t *x_index = map->x_index;
+    const uint8_t *x_frac = map->x_frac;
+
+    for (int i = 0; i < rows; i++) {
+        int y1 = map->y_index[dst_y + i];
+        int y2 = (y1 + 1 < map->src_height) ? y1 + 1 : map->src_height - 1;
+        uint32_t fy = map->y_frac[dst_y + i];
+        const uint16_t *row0 = src_buf + (size_t)y1 * src_width;
+        const uint16_t *row1 = src_buf + (size_t)y2 * src_width;
+        uint16_t *dst_row = dst_buf + (size_t)i * dst_width;
+
+        if (map->byte_swapped) {
+            for (int j = 0; j < dst_width; j++) {
+                int x1 = x_index[j];
+                int x2 = (x1 + 1 < src_width) ? x1 + 1 : src_width - 1;
+                uint16_t p = rgb565_blend_q8(RGB565_SWAP(row0[x1]), RGB565_SWAP(row0[x2]),
+                                             RGB565_SWAP(row1[x1]), RGB565_SWAP(row1[x2]),
+                                             x_frac[j], fy);
+                dst_row[j] = RGB565_SWAP(p);
+            }
+        } else {
+            for (int j = 0; j < dst_width; j++) {
+                int x1 = x_index[j];
+                int x2 = (x1 + 1 < src_width) ? x1 + 1 : src_width - 1;
+                dst_row[j] = rgb565_blend_q8(row0[x1], row0[x2], row1[x1], row1[x2], x_frac[j], fy);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -2,13 +2,14 @@
 #define __IMAGE_SCALER_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief       RGB565图像缩放函数（双线性插值）
+ * @brief       RGB565图像缩放函数（双线性插值，Q8定点实现）
  * @param       src_buf: 源图像缓冲区（RGB565格式）
  * @param       src_width: 源图像宽度
  * @param       src_height: 源图像高度
@@ -20,6 +21,14 @@ extern "C" {
 int scale_rgb565_bilinear(const uint16_t* src_buf, int src_width, int src_height,
                          uint16_t* dst_buf, int dst_width, int dst_height);
 
+/**
+ * @brief       RGB565图像缩放函数（双线性插值，浮点参考实现，仅用于精度对比）
+ * @param       参数同scale_rgb565_bilinear
+ * @retval      0: 成功, -1: 失败
+ */
+int scale_rgb565_bilinear_float(const uint16_t* src_buf, int src_width, int src_height,
+                               uint16_t* dst_buf, int dst_width, int dst_height);
+
 /**
  * @brief       RGB565图像缩放函数（最近邻插值，速度更快）
  * @param       src_buf: 源图像缓冲区（RGB565格式）
@@ -33,6 +42,81 @@ int scale_rgb565_bilinear(const uint16_t* src_buf, int src_width, int src_height
 int scale_rgb565_nearest(const uint16_t* src_buf, int src_width, int src_height,
                         uint16_t* dst_buf, int dst_width, int dst_height);
 
+/**
+ * @brief       缩放映射表类型
+ */
+typedef enum {
+    RGB565_SCALE_NEAREST = 0,   /*!< 最近邻 */
+    RGB565_SCALE_BILINEAR = 1   /*!< 双线性（Q8定点） */
+} rgb565_scale_mode_t;
+
+/**
+ * @brief       缩放映射表（按源/目标尺寸缓存，尺寸不变时重复使用）
+ */
+typedef struct {
+    int src_width;          /*!< 源图像宽度 */
+    int src_height;         /*!< 源图像高度 */
+    int dst_width;          /*!< 目标图像宽度 */
+    int dst_height;         /*!< 目标图像高度 */
+    rgb565_scale_mode_t mode; /*!< 映射表类型 */
+    uint8_t byte_swapped;   /*!< 像素按大端字节序存放（摄像头/LCD顺序），仅双线性使用 */
+    uint16_t *x_index;      /*!< 目标列 -> 源列 */
+    uint16_t *y_index;      /*!< 目标行 -> 源行 */
+    uint8_t *x_frac;        /*!< 目标列的Q8水平插值权重，仅双线性使用 */
+    uint8_t *y_frac;        /*!< 目标行的Q8垂直插值权重，仅双线性使用 */
+} rgb565_scale_map_t;
+
+/**
+ * @brief       准备缩放映射表，源/目标尺寸与上次相同时直接返回
+ * @param       map: 映射表（首次使用前需清零）
+ * @param       src_width: 源图像宽度
+ * @param       src_height: 源图像高度
+ * @param       dst_width: 目标图像宽度
+ * @param       dst_height: 目标图像高度
+ * @retval      0: 成功, -1: 失败
+ */
+int rgb565_scale_map_prepare(rgb565_scale_map_t *map, int src_width, int src_height,
+                             int dst_width, int dst_height);
+
+/**
+ * @brief       准备双线性缩放映射表（Q8权重），参数与缓存规则同rgb565_scale_map_prepare
+ * @param       byte_swapped: 1表示像素按大端字节序存放（摄像头帧缓冲/LCD数据顺序）
+ * @retval      0: 成功, -1: 失败
+ */
+int rgb565_scale_map_prepare_bilinear(rgb565_scale_map_t *map, int src_width, int src_height,
+                                      int dst_width, int dst_height, int byte_swapped);
+
+/**
+ * @brief       释放缩放映射表
+ * @param       map: 映射表
+ * @retval      无
+ */
+void rgb565_scale_map_release(rgb565_scale_map_t *map);
+
+/**
+ * @brief       按映射表对若干目标行做最近邻缩放（无除法，重复行直接memcpy）
+ * @param       map: 已准备好的映射表
+ * @param       src_buf: 源图像缓冲区（RGB565格式）
+ * @param       dst_buf: 目标行缓冲区，存放rows行、每行dst_width个像素
+ * @param       dst_y: 起始目标行
+ * @param       rows: 行数
+ * @retval      0: 成功, -1: 失败
+ */
+int scale_rgb565_nearest_rows(const rgb565_scale_map_t *map, const uint16_t *src_buf,
+                              uint16_t *dst_buf, int dst_y, int rows);
+
+/**
+ * @brief       按双线性映射表对若干目标行做Q8定点插值（R/B与G分两条32位通道并行计算）
+ * @param       map: 由rgb565_scale_map_prepare_bilinear准备的映射表
+ * @param       src_buf: 源图像缓冲区（RGB565格式）
+ * @param       dst_buf: 目标行缓冲区，存放rows行、每行dst_width个像素
+ * @param       dst_y: 起始目标行
+ * @param       rows: 行数
+ * @retval      0: 成功, -1: 失败
+ */
+int scale_rgb565_bilinear_rows(const rgb565_scale_map_t *map, const uint16_t *src_buf,
+                               uint16_t *dst_buf, int dst_y, int rows);
+
 #ifdef __cplusplus
 }
 #endif
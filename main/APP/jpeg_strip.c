@@ -0,0 +1,444 @@
+#include "jpeg_strip.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_camera.h"
+#include "img_converters.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "JpegStrip";
+
+_Static_assert(JPEG_STRIP_COUNT >= 2, "strip encoding needs at least two strips");
+_Static_assert(JPEG_STRIP_MCU_ROWS % 16 == 0, "strip height must cover whole 4:2:0 MCU rows");
+
+/**
+ * @brief       一条的编码结果
+ */
+typedef struct {
+    uint8_t *buf;               /* fmt2jpg输出的完整JPEG */
+    size_t len;
+    bool ok;
+} jpeg_strip_part_t;
+
+/**
+ * @brief       一条JPEG的结构位置
+ */
+typedef struct {
+    size_t sof;                 /* SOF0标记位置 */
+    size_t sos;                 /* SOS标记位置（其前为表头） */
+    size_t scan;                /* 熵编码数据起点 */
+    size_t scan_end;            /* 熵编码数据终点（EOI位置） */
+} jpeg_layout_t;
+
+/**
+ * @brief       编码器状态：同一时间只编码一张图像，当前作业的参数与各条结果放在这里供两个核共享
+ */
+static struct {
+    TaskHandle_t worker;
+    SemaphoreHandle_t lock;     /* 串行化各次编码，也保证fmt2jpg的表只在单核编码时初始化 */
+    SemaphoreHandle_t done;     /* 辅助任务每编完一条释放一次 */
+    uint8_t warm_quality;       /* fmt2jpg的静态表已按此质量初始化，0表示尚未初始化 */
+
+    const uint8_t *src;
+    uint16_t width;
+    uint16_t height;
+    uint16_t strip_rows;
+    uint8_t quality;
+    uint32_t strip_count;
+    uint32_t next_strip;        /* 下一条待领取的条号（原子递增），作业之间不小于JPEG_STRIP_COUNT */
+    uint32_t done_strips;       /* 已编完的条数（原子递增） */
+    jpeg_strip_part_t parts[JPEG_STRIP_COUNT];
+
+    jpeg_strip_stats_t stats;
+} s_jpeg = {
+    .next_strip = JPEG_STRIP_COUNT,
+};
+
+/**
+ * @brief       领取并编码剩余的条，直到全部被领取
+ * @param       worker: 是否为辅助任务（仅用于统计）
+ * @retval      无
+ */
+static void jpeg_strip_run(bool worker)
+{
+    uint32_t i;
+
+    while ((i = __atomic_fetch_add(&s_jpeg.next_strip, 1, __ATOMIC_ACQ_REL)) < s_jpeg.strip_count) {
+        uint32_t first_row = i * s_jpeg.strip_rows;
+        uint32_t rows = s_jpeg.height - first_row < s_jpeg.strip_rows ? s_jpeg.height - first_row : s_jpeg.strip_rows;
+        size_t row_bytes = (size_t)s_jpeg.width * 2;
+        jpeg_strip_part_t *part = &s_jpeg.parts[i];
+
+        /* 每条单独编码为完整JPEG：DC预测从0开始，与解码器在复位标记处的行为一致 */
+        part->ok = fmt2jpg((uint8_t *)s_jpeg.src + first_row * row_bytes, rows * row_bytes, s_jpeg.width,
+                           (uint16_t)rows, PIXFORMAT_RGB565, s_jpeg.quality, &part->buf, &part->len);
+        __atomic_add_fetch(&s_jpeg.done_strips, 1, __ATOMIC_ACQ_REL);
+        if (worker) {
+            __atomic_add_fetch(&s_jpeg.stats.worker_strips, 1, __ATOMIC_RELAXED);
+            xSemaphoreGive(s_jpeg.done);
+        }
+    }
+}
+
+/**
+ * @brief       辅助编码任务：被唤醒后与调用者一起领取条
+ * @note        唤醒晚了（调用者已编完所有条）时领不到条，直接回去等待，调用者不会等它
+ * @param       arg: 未使用
+ * @retval      无
+ */
+static void jpeg_strip_worker(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        jpeg_strip_run(true);
+    }
+}
+
+/**
+ * @brief       单核编码一小块图像，使fmt2jpg按该质量初始化其静态量化表与哈夫曼表（调用者持有lock）
+ * @note        esp32-camera的jpge编码器把表放在文件作用域的静态变量中并惰性填充，不可重入；
+ *              两个核首次或换质量后同时编码会互相破坏表，须先单核预热
+ * @param       quality: JPEG质量
+ * @retval      true: 成功
+ */
+static bool jpeg_strip_warm_up(uint8_t quality)
+{
+    uint16_t block[16 * 16];
+    uint8_t *out = NULL;
+    size_t out_len = 0;
+
+    memset(block, 0x80, sizeof(block));
+    bool ok = fmt2jpg((uint8_t *)block, sizeof(block), 16, 16, PIXFORMAT_RGB565, quality, &out, &out_len);
+    free(out);
+    if (ok) {
+        s_jpeg.warm_quality = quality;
+    }
+
+    return ok;
+}
+
+/**
+ * @brief       解析fmt2jpg输出的结构：SOI、若干表段、SOF0、SOS、熵编码数据、EOI
+ * @param       buf/len: JPEG数据
+ * @param       layout: 输出
+ * @retval      true: 结构符合拼接要求, false: 不符合（如含DRI或非基线编码）
+ */
+static bool jpeg_strip_parse(const uint8_t *buf, size_t len, jpeg_layout_t *layout)
+{
+    size_t pos = 2;
+
+    if (len < 4 || buf[0] != 0xFF || buf[1] != 0xD8 || buf[len - 2] != 0xFF || buf[len - 1] != 0xD9) {
+        return false;
+    }
+
+    layout->sof = 0;
+    while (pos + 4 <= len) {
+        if (buf[pos] != 0xFF) {
+            return false;
+        }
+
+        uint8_t marker = buf[pos + 1];
+        size_t seg_len = ((size_t)buf[pos + 2] << 8) | buf[pos + 3];
+
+        if (marker == 0xDD || (marker >= 0xC1 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)) {
+            return false;
+        }
+        if (marker == 0xC0) {
+            layout->sof = pos;
+        }
+        if (pos + 2 + seg_len > len) {
+            return false;
+        }
+        if (marker == 0xDA) {
+            layout->sos = pos;
+            layout->scan = pos + 2 + seg_len;
+            layout->scan_end = len - 2;
+            return layout->sof != 0 && layout->scan <= layout->scan_end;
+        }
+        pos += 2 + seg_len;
+    }
+
+    return false;
+}
+
+/**
+ * @brief       由SOF0的采样因子求一条的MCU数（复位间隔）
+ * @param       buf: 第一条JPEG
+ * @param       layout: 其结构
+ * @retval      复位间隔，条高不是MCU高度整数倍或超出16位时返回0
+ */
+static uint32_t jpeg_strip_restart_interval(const uint8_t *buf, const jpeg_layout_t *layout)
+{
+    const uint8_t *sof = buf + layout->sof;
+    uint32_t comps = sof[9];
+    uint32_t h_max = 1;
+    uint32_t v_max = 1;
+
+    if (layout->sof + 10 + comps * 3 > layout->sos) {
+        return 0;
+    }
+    for (uint32_t c = 0; c < comps; c++) {
+        uint32_t hv = sof[10 + c * 3 + 1];
+        h_max = (hv >> 4) > h_max ? (hv >> 4) : h_max;
+        v_max = (hv & 0x0F) > v_max ? (hv & 0x0F) : v_max;
+    }
+
+    uint32_t mcu_w = 8 * h_max;
+    uint32_t mcu_h = 8 * v_max;
+    if (s_jpeg.strip_rows % mcu_h != 0) {
+        return 0;
+    }
+
+    uint32_t interval = ((s_jpeg.width + mcu_w - 1) / mcu_w) * (s_jpeg.strip_rows / mcu_h);
+    return interval <= 0xFFFF ? interval : 0;
+}
+
+/**
+ * @brief       拼接各条：沿用第一条的表头并改写SOF0高度、插入DRI，各条熵编码数据之间插入RSTn
+ * @param       out/out_len: 输出，用free释放
+ * @retval      ESP_OK: 成功, ESP_ERR_NO_MEM: 内存不足, ESP_FAIL: 各条结构不一致
+ */
+static esp_err_t jpeg_strip_splice(uint8_t **out, size_t *out_len)
+{
+    jpeg_layout_t layout[JPEG_STRIP_COUNT];
+    const uint8_t *first = s_jpeg.parts[0].buf;
+    size_t total;
+
+    for (uint32_t i = 0; i < s_jpeg.strip_count; i++) {
+        if (!jpeg_strip_parse(s_jpeg.parts[i].buf, s_jpeg.parts[i].len, &layout[i])) {
+            ESP_LOGW(TAG, "Strip %lu has an unexpected layout", (unsigned long)i);
+            return ESP_FAIL;
+        }
+        /* 各条的量化表、哈夫曼表须相同，表头只允许SOF0中的高度不同 */
+        if (layout[i].sof != layout[0].sof || layout[i].scan != layout[0].scan ||
+            memcmp(s_jpeg.parts[i].buf, first, layout[0].sof + 5) != 0 ||
+            memcmp(s_jpeg.parts[i].buf + layout[0].sof + 7, first + layout[0].sof + 7,
+                   layout[0].scan - layout[0].sof - 7) != 0) {
+            ESP_LOGW(TAG, "Strip %lu tables differ from strip 0", (unsigned long)i);
+            return ESP_FAIL;
+        }
+    }
+
+    uint32_t interval = jpeg_strip_restart_interval(first, &layout[0]);
+    if (interval == 0) {
+        ESP_LOGW(TAG, "Strip height %u is not a whole number of MCU rows", s_jpeg.strip_rows);
+        return ESP_FAIL;
+    }
+
+    total = layout[0].scan + 6 + 2;                             /* 表头+SOS、DRI、EOI */
+    for (uint32_t i = 0; i < s_jpeg.strip_count; i++) {
+        total += layout[i].scan_end - layout[i].scan + 2;       /* 熵编码数据+RSTn（最后一条不用） */
+    }
+
+    uint8_t *buf = heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        buf = malloc(total);
+    }
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t pos = layout[0].sos;
+    memcpy(buf, first, pos);
+    buf[layout[0].sof + 5] = (uint8_t)(s_jpeg.height >> 8);
+    buf[layout[0].sof + 6] = (uint8_t)s_jpeg.height;
+
+    const uint8_t dri[6] = { 0xFF, 0xDD, 0x00, 0x04, (uint8_t)(interval >> 8), (uint8_t)interval };
+    memcpy(buf + pos, dri, sizeof(dri));
+    pos += sizeof(dri);
+
+    memcpy(buf + pos, first + layout[0].sos, layout[0].scan - layout[0].sos);
+    pos += layout[0].scan - layout[0].sos;
+
+    /* 编码器在每条末尾已用1填满最后一个字节，可直接接复位标记 */
+    for (uint32_t i = 0; i < s_jpeg.strip_count; i++) {
+        size_t scan_len = layout[i].scan_end - layout[i].scan;
+
+        memcpy(buf + pos, s_jpeg.parts[i].buf + layout[i].scan, scan_len);
+        pos += scan_len;
+        if (i + 1 < s_jpeg.strip_count) {
+            buf[pos++] = 0xFF;
+            buf[pos++] = (uint8_t)(0xD0 + (i & 7));
+        }
+    }
+    buf[pos++] = 0xFF;
+    buf[pos++] = 0xD9;
+
+    *out = buf;
+    *out_len = pos;
+    return ESP_OK;
+}
+
+/**
+ * @brief       整帧单核编码
+ */
+static esp_err_t jpeg_strip_encode_whole(const uint8_t *src, size_t src_len, uint16_t width, uint16_t height,
+                                         uint8_t quality, uint8_t **out, size_t *out_len)
+{
+    s_jpeg.stats.fallback++;
+    if (!fmt2jpg((uint8_t *)src, src_len, width, height, PIXFORMAT_RGB565, quality, out, out_len)) {
+        free(*out);
+        *out = NULL;
+        return ESP_FAIL;
+    }
+
+    /* 单核完整编码一次后静态表已按该质量就绪 */
+    s_jpeg.warm_quality = quality;
+    return ESP_OK;
+}
+
+/**
+ * @brief       按常用质量单核预热编码器后创建辅助编码任务
+ * @param       quality: 预热用的JPEG质量（之后换质量时会在首次编码前重新单核预热）
+ * @retval      ESP_OK: 成功, ESP_ERR_NO_MEM: 失败（编码仍可用，退化为单核）
+ */
+esp_err_t jpeg_strip_init(uint8_t quality)
+{
+    if (s_jpeg.worker) {
+        return ESP_OK;
+    }
+
+    if (!s_jpeg.lock) {
+        s_jpeg.lock = xSemaphoreCreateMutex();
+    }
+    if (!s_jpeg.done) {
+        s_jpeg.done = xSemaphoreCreateBinary();
+    }
+    if (!s_jpeg.lock || !s_jpeg.done) {
+        ESP_LOGE(TAG, "Failed to create strip encoder semaphores");
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* 辅助任务启动前先单核预热，之后同质量的编码可在两个核上同时进行 */
+    xSemaphoreTake(s_jpeg.lock, portMAX_DELAY);
+    if (!jpeg_strip_warm_up(quality)) {
+        ESP_LOGW(TAG, "Warm-up encode at quality %u failed", quality);
+    }
+    xSemaphoreGive(s_jpeg.lock);
+
+    if (xTaskCreatePinnedToCore(jpeg_strip_worker, "jpeg_strip", JPEG_STRIP_WORKER_STACK, NULL,
+                                JPEG_STRIP_WORKER_PRIO, &s_jpeg.worker, JPEG_STRIP_WORKER_CORE) != pdPASS) {
+        s_jpeg.worker = NULL;
+        ESP_LOGE(TAG, "Failed to create strip encoder task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Strip JPEG encoder: %d strips, worker on core %d", JPEG_STRIP_COUNT, JPEG_STRIP_WORKER_CORE);
+    return ESP_OK;
+}
+
+/**
+ * @brief       把RGB565帧编码为JPEG（多张图像同时调用时依次进行）
+ * @param       src: 源帧（大端RGB565，与摄像头帧缓冲字节序一致）
+ * @param       src_len: 源帧字节数
+ * @param       width/height: 宽高
+ * @param       quality: JPEG质量1-100
+ * @param       out: 输出缓冲，由本函数分配，调用者用free释放
+ * @param       out_len: 输出字节数
+ * @retval      ESP_OK: 成功, ESP_ERR_INVALID_ARG: 参数无效, ESP_ERR_NO_MEM: 内存不足, ESP_FAIL: 编码失败
+ */
+esp_err_t jpeg_strip_encode(const uint8_t *src, size_t src_len, uint16_t width, uint16_t height,
+                            uint8_t quality, uint8_t **out, size_t *out_len)
+{
+    if (!src || !out || !out_len || width == 0 || height == 0 || src_len < (size_t)width * height * 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *out = NULL;
+    *out_len = 0;
+
+    /* 条高取MCU行的整数倍，使各条大致等高 */
+    uint32_t mcu_rows = (height + JPEG_STRIP_MCU_ROWS - 1) / JPEG_STRIP_MCU_ROWS;
+    uint32_t strip_rows = ((mcu_rows + JPEG_STRIP_COUNT - 1) / JPEG_STRIP_COUNT) * JPEG_STRIP_MCU_ROWS;
+    uint32_t strip_count = (height + strip_rows - 1) / strip_rows;
+
+    if (!s_jpeg.worker || strip_count < 2) {
+        if (s_jpeg.lock) {
+            xSemaphoreTake(s_jpeg.lock, portMAX_DELAY);
+        }
+        esp_err_t ret = jpeg_strip_encode_whole(src, src_len, width, height, quality, out, out_len);
+        if (s_jpeg.lock) {
+            xSemaphoreGive(s_jpeg.lock);
+        }
+        return ret;
+    }
+
+    xSemaphoreTake(s_jpeg.lock, portMAX_DELAY);
+    int64_t start_us = esp_timer_get_time();
+
+    /* 质量变化时静态表要重建，须在辅助任务参与之前单核完成 */
+    if (quality != s_jpeg.warm_quality && !jpeg_strip_warm_up(quality)) {
+        esp_err_t ret = jpeg_strip_encode_whole(src, src_len, width, height, quality, out, out_len);
+        xSemaphoreGive(s_jpeg.lock);
+        return ret;
+    }
+
+    /* 作业之间next_strip不小于JPEG_STRIP_COUNT，晚醒的辅助任务领不到条，可以安全改写作业参数 */
+    s_jpeg.src = src;
+    s_jpeg.width = width;
+    s_jpeg.height = height;
+    s_jpeg.strip_rows = (uint16_t)strip_rows;
+    s_jpeg.quality = quality;
+    s_jpeg.strip_count = strip_count;
+    memset(s_jpeg.parts, 0, sizeof(s_jpeg.parts));
+    __atomic_store_n(&s_jpeg.done_strips, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_jpeg.next_strip, 0, __ATOMIC_RELEASE);
+
+    /* 两边先到先取：辅助任务因核1繁忙迟迟不运行时，调用者独自编完全部条，不等它；
+     * 只等辅助任务已领到、正在编码的条 */
+    xTaskNotifyGive(s_jpeg.worker);
+    jpeg_strip_run(false);
+    while (__atomic_load_n(&s_jpeg.done_strips, __ATOMIC_ACQUIRE) < strip_count) {
+        xSemaphoreTake(s_jpeg.done, portMAX_DELAY);
+    }
+    __atomic_store_n(&s_jpeg.next_strip, JPEG_STRIP_COUNT, __ATOMIC_RELEASE);
+
+    esp_err_t ret = ESP_OK;
+    for (uint32_t i = 0; i < strip_count; i++) {
+        if (!s_jpeg.parts[i].ok) {
+            ESP_LOGE(TAG, "Strip %lu failed to encode", (unsigned long)i);
+            ret = ESP_FAIL;
+        }
+    }
+    if (ret == ESP_OK) {
+        ret = jpeg_strip_splice(out, out_len);
+    }
+
+    for (uint32_t i = 0; i < strip_count; i++) {
+        free(s_jpeg.parts[i].buf);
+        s_jpeg.parts[i].buf = NULL;
+    }
+
+    if (ret == ESP_FAIL) {
+        /* 拼接校验失败（编码器输出结构与预期不同）时保证仍能得到照片 */
+        ret = jpeg_strip_encode_whole(src, src_len, width, height, quality, out, out_len);
+    } else if (ret == ESP_OK) {
+        s_jpeg.stats.parallel++;
+        s_jpeg.stats.strips += strip_count;
+    }
+    s_jpeg.stats.last_encode_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    xSemaphoreGive(s_jpeg.lock);
+    return ret;
+}
+
+/**
+ * @brief       获取统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void jpeg_strip_get_stats(jpeg_strip_stats_t *stats)
+{
+    stats->parallel = s_jpeg.stats.parallel;
+    stats->fallback = s_jpeg.stats.fallback;
+    stats->strips = s_jpeg.stats.strips;
+    stats->worker_strips = __atomic_load_n(&s_jpeg.stats.worker_strips, __ATOMIC_RELAXED);
+    stats->last_encode_us = s_jpeg.stats.last_encode_us;
+}
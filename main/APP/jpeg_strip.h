@@ -0,0 +1,62 @@
+#ifndef __JPEG_STRIP_H__
+#define __JPEG_STRIP_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 分条并行JPEG编码：按MCU行把RGB565图像切成若干条，由调用者与另一个核上的辅助任务分别编码，
+ * 再以复位标记(RST)把各条的熵编码数据拼成一张标准JPEG */
+#define JPEG_STRIP_COUNT            4           /* 条数，两个核先到先取，一个核繁忙时另一个核多编几条 */
+#define JPEG_STRIP_MCU_ROWS         16          /* 条高须是MCU高度的整数倍（彩色4:2:0为16行） */
+#define JPEG_STRIP_WORKER_CORE      1           /* 辅助编码任务核心（上传任务在核0） */
+#define JPEG_STRIP_WORKER_PRIO      2           /* 与上传任务相同，低于检测流水线 */
+#define JPEG_STRIP_WORKER_STACK     (8 * 1024)  /* fmt2jpg的编码器状态在栈上 */
+
+/**
+ * @brief       编码统计
+ */
+typedef struct {
+    uint32_t parallel;          /*!< 分条并行编码的图像数 */
+    uint32_t fallback;          /*!< 图像太小、辅助任务未运行或拼接校验失败而整帧编码的图像数 */
+    uint32_t strips;            /*!< 编码的条数 */
+    uint32_t worker_strips;     /*!< 其中由辅助任务编码的条数 */
+    uint32_t last_encode_us;    /*!< 最近一张图像的编码+拼接耗时 */
+} jpeg_strip_stats_t;
+
+/**
+ * @brief       按常用质量单核预热编码器后创建辅助编码任务
+ * @param       quality: 预热用的JPEG质量（之后换质量时会在首次编码前重新单核预热）
+ * @retval      ESP_OK: 成功, ESP_ERR_NO_MEM: 失败（编码仍可用，退化为单核）
+ */
+esp_err_t jpeg_strip_init(uint8_t quality);
+
+/**
+ * @brief       把RGB565帧编码为JPEG（多张图像同时调用时依次进行）
+ * @param       src: 源帧（大端RGB565，与摄像头帧缓冲字节序一致）
+ * @param       src_len: 源帧字节数
+ * @param       width/height: 宽高
+ * @param       quality: JPEG质量1-100
+ * @param       out: 输出缓冲，由本函数分配，调用者用free释放
+ * @param       out_len: 输出字节数
+ * @retval      ESP_OK: 成功, ESP_ERR_INVALID_ARG: 参数无效, ESP_ERR_NO_MEM: 内存不足, ESP_FAIL: 编码失败
+ */
+esp_err_t jpeg_strip_encode(const uint8_t *src, size_t src_len, uint16_t width, uint16_t height,
+                            uint8_t quality, uint8_t **out, size_t *out_len);
+
+/**
+ * @brief       获取统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void jpeg_strip_get_stats(jpeg_strip_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JPEG_STRIP_H__ */
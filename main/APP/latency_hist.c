@@ -0,0 +1,175 @@
+#include "latency_hist.h"
+
+#if LATENCY_PROFILE_ENABLE
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG = "LatencyHist";
+
+/**
+ * @brief       单个阶段的对数直方图，所有字段以原子操作更新
+ */
+typedef struct {
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint32_t max_us;
+} latency_hist_t;
+
+static latency_hist_t s_hist[LAT_STAGE_COUNT];
+static TaskHandle_t s_console_task = NULL;
+
+static const char *const s_stage_name[LAT_STAGE_COUNT] = {
+    "capture", "msr01", "mnp01", "distance", "draw", "lcd", "glass2lcd",
+};
+
+/**
+ * @brief       记录一次延迟（无锁，可在任意任务中调用）
+ * @param       stage: 阶段
+ * @param       us: 延迟（us），负数按0计
+ * @retval      无
+ */
+void latency_hist_record(lat_stage_t stage, int64_t us)
+{
+    if ((unsigned)stage >= LAT_STAGE_COUNT) {
+        return;
+    }
+
+    uint32_t v = us <= 0 ? 0 : (us >= UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+    int bucket = v < 2 ? 0 : 31 - __builtin_clz(v);
+    latency_hist_t *h = &s_hist[stage];
+
+    __atomic_fetch_add(&h->buckets[bucket], 1, __ATOMIC_RELAXED);
+
+    uint32_t cur = __atomic_load_n(&h->max_us, __ATOMIC_RELAXED);
+    while (v > cur && !__atomic_compare_exchange_n(&h->max_us, &cur, v, true,
+                                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @brief       由直方图估算分位数（桶内线性插值）
+ * @param       buckets: 桶计数快照
+ * @param       total: 样本总数
+ * @param       pct: 分位（0-100）
+ * @param       max_us: 实测最大值，插值结果不超过它
+ * @retval      估算值（us）
+ */
+static uint32_t latency_hist_percentile(const uint32_t *buckets, uint32_t total, uint32_t pct, uint32_t max_us)
+{
+    uint64_t rank = ((uint64_t)total * pct + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+        if (buckets[b] == 0) {
+            continue;
+        }
+        if (seen + buckets[b] >= rank) {
+            uint64_t lo = b == 0 ? 0 : (1ull << b);
+            uint64_t hi = 1ull << (b + 1);
+            uint64_t v = lo + (hi - lo) * (rank - seen) / buckets[b];
+            return v > max_us ? max_us : (uint32_t)v;
+        }
+        seen += buckets[b];
+    }
+
+    return max_us;
+}
+
+/**
+ * @brief       输出各阶段的样本数、p50/p95/p99及最大值
+ * @retval      无
+ */
+void latency_hist_report(void)
+{
+    ESP_LOGI(TAG, "%-9s %8s %8s %8s %8s %8s", "stage", "count", "p50_us", "p95_us", "p99_us", "max_us");
+
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        uint32_t snap[LATENCY_HIST_BUCKETS];
+        uint32_t total = 0;
+
+        /* 快照期间仍可能有新样本写入，以快照内的桶计数为准 */
+        for (int b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+            snap[b] = __atomic_load_n(&s_hist[s].buckets[b], __ATOMIC_RELAXED);
+            total += snap[b];
+        }
+
+        if (total == 0) {
+            ESP_LOGI(TAG, "%-9s %8d", s_stage_name[s], 0);
+            continue;
+        }
+
+        uint32_t max_us = __atomic_load_n(&s_hist[s].max_us, __ATOMIC_RELAXED);
+        ESP_LOGI(TAG, "%-9s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32,
+                 s_stage_name[s], total,
+                 latency_hist_percentile(snap, total, 50, max_us),
+                 latency_hist_percentile(snap, total, 95, max_us),
+                 latency_hist_percentile(snap, total, 99, max_us),
+                 max_us);
+    }
+}
+
+/**
+ * @brief       清零所有直方图
+ * @retval      无
+ */
+void latency_hist_reset(void)
+{
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        for (int b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+            __atomic_store_n(&s_hist[s].buckets[b], 0, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&s_hist[s].max_us, 0, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief       串口命令任务：轮询控制台输入
+ * @param       arg: 未使用
+ * @retval      无
+ */
+static void latency_console_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        int c = getchar();
+
+        if (c == 'p' || c == 'P') {
+            latency_hist_report();
+        } else if (c == 'r' || c == 'R') {
+            latency_hist_reset();
+            ESP_LOGI(TAG, "Latency histograms reset");
+        } else if (c == EOF) {
+            /* 控制台默认非阻塞，无输入时返回EOF */
+            clearerr(stdin);
+            vTaskDelay(pdMS_TO_TICKS(LATENCY_CONSOLE_POLL_MS));
+        }
+    }
+}
+
+/**
+ * @brief       创建串口命令任务：收到'p'输出统计，'r'清零
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t latency_hist_console_start(void)
+{
+    if (s_console_task) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreatePinnedToCore(latency_console_task, "lat_console", 3 * 1024, NULL, 1,
+                                &s_console_task, 0) != pdPASS) {
+        s_console_task = NULL;
+        ESP_LOGE(TAG, "Failed to create latency console task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Latency profiling enabled: send 'p' to print percentiles, 'r' to reset");
+    return ESP_OK;
+}
+
+#endif /* LATENCY_PROFILE_ENABLE */
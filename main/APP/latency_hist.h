@@ -0,0 +1,81 @@
+#ifndef __LATENCY_HIST_H__
+#define __LATENCY_HIST_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1: 记录各级延迟直方图；0: 所有打点编译为空操作 */
+#ifndef LATENCY_PROFILE_ENABLE
+#define LATENCY_PROFILE_ENABLE      1
+#endif
+
+#define LATENCY_HIST_BUCKETS        32      /* 对数桶：桶b覆盖[2^b, 2^(b+1)) us，桶0含0 */
+#define LATENCY_CONSOLE_POLL_MS     50      /* 串口命令轮询周期 */
+
+/**
+ * @brief       延迟统计的各个阶段
+ */
+typedef enum {
+    LAT_STAGE_CAPTURE = 0,      /*!< esp_camera_fb_get */
+    LAT_STAGE_MSR01,            /*!< 第一级推理（含跟踪区域裁剪） */
+    LAT_STAGE_MNP01,            /*!< 第二级推理 */
+    LAT_STAGE_DISTANCE,         /*!< handle_distance_detection_c */
+    LAT_STAGE_DRAW,             /*!< draw_detection_result */
+    LAT_STAGE_LCD,              /*!< LCD分块发送 */
+    LAT_STAGE_GLASS_TO_LCD,     /*!< 帧采集完成到显示完成 */
+    LAT_STAGE_COUNT
+} lat_stage_t;
+
+#if LATENCY_PROFILE_ENABLE
+
+#define LAT_STAMP()                     esp_timer_get_time()
+#define LAT_RECORD(stage, start_us)     latency_hist_record((stage), esp_timer_get_time() - (start_us))
+
+/**
+ * @brief       记录一次延迟（无锁，可在任意任务中调用）
+ * @param       stage: 阶段
+ * @param       us: 延迟（us），负数按0计
+ * @retval      无
+ */
+void latency_hist_record(lat_stage_t stage, int64_t us);
+
+/**
+ * @brief       输出各阶段的样本数、p50/p95/p99及最大值
+ * @retval      无
+ */
+void latency_hist_report(void);
+
+/**
+ * @brief       清零所有直方图
+ * @retval      无
+ */
+void latency_hist_reset(void);
+
+/**
+ * @brief       创建串口命令任务：收到'p'输出统计，'r'清零
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t latency_hist_console_start(void);
+
+#else
+
+#define LAT_STAMP()                     ((int64_t)0)
+#define LAT_RECORD(stage, start_us)     do { (void)(stage); (void)(start_us); } while (0)
+
+static inline void latency_hist_record(lat_stage_t stage, int64_t us) { (void)stage; (void)us; }
+static inline void latency_hist_report(void) {}
+static inline void latency_hist_reset(void) {}
+static inline esp_err_t latency_hist_console_start(void) { return ESP_OK; }
+
+#endif /* LATENCY_PROFILE_ENABLE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LATENCY_HIST_H__ */
@@ -0,0 +1,512 @@
+#include "lcd_preview.h"
+#include "lcd_stream.h"
+#include "frame_ring.h"
+#include "latency_hist.h"
+#include "image_scaler.h"
+#include "lcd.h"
+#include "system_state_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+
+static const char *TAG = "LcdPreview";
+
+#define LCD_TILE_COLS   (LCD_PREVIEW_WIDTH / LCD_TILE_SIZE)
+#define LCD_TILE_ROWS   (LCD_PREVIEW_HEIGHT / LCD_TILE_SIZE)
+
+_Static_assert(LCD_PREVIEW_WIDTH % LCD_TILE_SIZE == 0, "preview width must be a multiple of the tile size");
+_Static_assert(LCD_PREVIEW_HEIGHT % LCD_TILE_SIZE == 0, "preview height must be a multiple of the tile size");
+_Static_assert(LCD_TILE_SIZE <= LCD_STREAM_LINES, "a tile row band must fit in one DMA line buffer");
+
+/**
+ * @brief       预览状态
+ */
+static struct {
+    rgb565_scale_map_t scale_map;                       /* 缩放映射表（按摄像头分辨率缓存） */
+    uint16_t *band_buf;                                 /* 缩放后的一条分块带（LCD_TILE_SIZE行） */
+    uint32_t tile_hash[LCD_TILE_ROWS][LCD_TILE_COLS];   /* 上次发送时各分块的哈希 */
+    bool hash_valid;                                    /* 分块哈希是否与屏幕内容一致 */
+    uint32_t frames_since_full;                         /* 距上次整屏刷新的帧数 */
+    lcd_preview_stats_t stats;
+} s_preview = {0};
+
+/**
+ * @brief       显示任务与最新帧信箱
+ */
+static struct {
+    frame_ring_t mailbox;               /* 单槽帧环：只保留最新一帧，新帧到达时归还旧帧 */
+    TaskHandle_t task;                  /* 显示任务句柄 */
+    SemaphoreHandle_t lcd_mutex;        /* LCD访问互斥（显示任务与其他绘制者） */
+    uint16_t x, y;                      /* 预览窗口位置 */
+} s_display = {0};
+
+/**
+ * @brief       显示帧率/抖动统计（每次输出后清零，反映最近一个统计窗口）
+ */
+static struct {
+    int64_t window_start_us;            /* 窗口内第一帧显示完成时间 */
+    int64_t last_show_us;               /* 上一帧显示完成时间 */
+    uint32_t frames;                    /* 窗口内显示帧数 */
+    uint32_t intervals;                 /* 窗口内帧间隔个数 */
+    uint64_t interval_sum;              /* 帧间隔之和（us） */
+    uint64_t interval_sq_sum;           /* 帧间隔平方和（us^2） */
+    uint32_t interval_max;              /* 最大帧间隔（us） */
+} s_timing = {0};
+
+/**
+ * @brief       计算一个分块的哈希（FNV-1a，每次处理两个像素，先屏蔽低位噪声）
+ * @param       src: 分块左上角
+ * @param       stride: 行跨度（像素）
+ * @retval      哈希值
+ */
+static uint32_t lcd_tile_hash(const uint16_t *src, int stride)
+{
+    const uint32_t mask = LCD_TILE_HASH_MASK | (LCD_TILE_HASH_MASK << 16);
+    uint32_t hash = 2166136261u;
+
+    for (int r = 0; r < LCD_TILE_SIZE; r++) {
+        const uint32_t *row = (const uint32_t *)(src + (size_t)r * stride);
+        for (int c = 0; c < LCD_TILE_SIZE / 2; c++) {
+            hash = (hash ^ (row[c] & mask)) * 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @brief       把一段分块带中的矩形区域打包成连续数据
+ * @param       dst: 目标（DMA缓冲区）
+ * @param       src: 矩形左上角
+ * @param       stride: 源行跨度（像素）
+ * @param       width: 矩形宽度（像素）
+ * @param       rows: 行数
+ * @retval      无
+ */
+static void lcd_pack_rect(uint16_t *dst, const uint16_t *src, int stride, int width, int rows)
+{
+    for (int r = 0; r < rows; r++) {
+#if LCD_PREVIEW_SWAP_BYTES
+        const uint32_t *s = (const uint32_t *)(src + (size_t)r * stride);
+        uint32_t *d = (uint32_t *)(dst + (size_t)r * width);
+        for (int k = 0; k < width / 2; k++) {
+            uint32_t v = s[k];
+            d[k] = ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu);
+        }
+#else
+        memcpy(dst + (size_t)r * width, src + (size_t)r * stride, (size_t)width * sizeof(uint16_t));
+#endif
+    }
+}
+
+/**
+ * @brief       初始化LCD预览（DMA乒乓缓冲区、分块状态）
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_preview_init(void)
+{
+    /* 先初始化信箱，即使LCD初始化失败，投递的帧也能被正常归还 */
+    if (s_display.mailbox.size == 0) {
+        frame_ring_init(&s_display.mailbox, 1);
+    }
+
+    esp_err_t ret = lcd_stream_init(LCD_PREVIEW_WIDTH);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (!s_preview.band_buf) {
+        s_preview.band_buf = heap_caps_malloc(LCD_PREVIEW_WIDTH * LCD_TILE_SIZE * sizeof(uint16_t),
+                                              MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!s_preview.band_buf) {
+            ESP_LOGE(TAG, "Failed to allocate preview band buffer");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (!s_display.lcd_mutex) {
+        s_display.lcd_mutex = xSemaphoreCreateMutex();
+        if (!s_display.lcd_mutex) {
+            ESP_LOGE(TAG, "Failed to create LCD mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_preview.hash_valid = false;
+    s_preview.stats.tiles_per_frame = LCD_TILE_COLS * LCD_TILE_ROWS;
+
+    ESP_LOGI(TAG, "LCD preview ready: %dx%d, %dx%d tiles, full refresh every %d frames",
+             LCD_PREVIEW_WIDTH, LCD_PREVIEW_HEIGHT, LCD_TILE_COLS, LCD_TILE_ROWS, LCD_TILE_FULL_REFRESH_FRAMES);
+    return ESP_OK;
+}
+
+/**
+ * @brief       显示一帧：必要时缩放到预览尺寸，仅发送内容变化的分块
+ * @param       fb: 摄像头帧（RGB565）
+ * @param       x/y: 预览窗口在屏幕上的位置
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_preview_show_frame(const camera_fb_t *fb, uint16_t x, uint16_t y)
+{
+    if (!fb || !fb->buf || !s_preview.band_buf) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* 检查显示区域是否超出屏幕 */
+    if (x + LCD_PREVIEW_WIDTH > lcd_self.width || y + LCD_PREVIEW_HEIGHT > lcd_self.height) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool native = (fb->width == LCD_PREVIEW_WIDTH && fb->height == LCD_PREVIEW_HEIGHT);
+
+    if (native) {
+        if (fb->len < (size_t)LCD_PREVIEW_WIDTH * LCD_PREVIEW_HEIGHT * 2) {
+            ESP_LOGW(TAG, "Frame buffer too short: %zu bytes", fb->len);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    } else {
+        /* 源/目标尺寸不变时直接复用缓存的行列映射表 */
+#if LCD_PREVIEW_BILINEAR
+        /* 摄像头帧缓冲为大端RGB565，插值前后需要交换字节 */
+        int map_ret = rgb565_scale_map_prepare_bilinear(&s_preview.scale_map, fb->width, fb->height,
+                                                        LCD_PREVIEW_WIDTH, LCD_PREVIEW_HEIGHT, 1);
+#else
+        int map_ret = rgb565_scale_map_prepare(&s_preview.scale_map, fb->width, fb->height,
+                                               LCD_PREVIEW_WIDTH, LCD_PREVIEW_HEIGHT);
+#endif
+        if (map_ret != 0) {
+            ESP_LOGE(TAG, "Failed to prepare scale map for %dx%d", (int)fb->width, (int)fb->height);
+            return ESP_FAIL;
+        }
+    }
+
+    esp_err_t ret = lcd_stream_begin_frame();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    bool full_refresh = !s_preview.hash_valid || ++s_preview.frames_since_full >= LCD_TILE_FULL_REFRESH_FRAMES;
+    if (full_refresh) {
+        s_preview.frames_since_full = 0;
+    }
+
+    /* 全宽窗口一直开到预览底部，连续的全宽分块带可直接续写；-1表示需要重新设置窗口 */
+    int stream_y = -1;
+    uint32_t tiles_sent = 0;
+
+    for (int band = 0; band < LCD_TILE_ROWS && ret == ESP_OK; band++) {
+        int band_y = band * LCD_TILE_SIZE;
+        const uint16_t *band_src;
+
+        if (native) {
+            band_src = (const uint16_t *)fb->buf + (size_t)band_y * LCD_PREVIEW_WIDTH;
+        } else {
+            /* 缩放本条带；上一条带的数据此时正在DMA发送 */
+#if LCD_PREVIEW_BILINEAR
+            scale_rgb565_bilinear_rows(&s_preview.scale_map, (const uint16_t *)fb->buf,
+                                       s_preview.band_buf, band_y, LCD_TILE_SIZE);
+#else
+            scale_rgb565_nearest_rows(&s_preview.scale_map, (const uint16_t *)fb->buf,
+                                      s_preview.band_buf, band_y, LCD_TILE_SIZE);
+#endif
+            band_src = s_preview.band_buf;
+        }
+
+        bool dirty[LCD_TILE_COLS];
+        for (int c = 0; c < LCD_TILE_COLS; c++) {
+            uint32_t hash = lcd_tile_hash(band_src + c * LCD_TILE_SIZE, LCD_PREVIEW_WIDTH);
+            dirty[c] = full_refresh || hash != s_preview.tile_hash[band][c];
+            s_preview.tile_hash[band][c] = hash;
+        }
+
+        /* 按连续的脏分块段发送，每段设置一次窗口 */
+        for (int c = 0; c < LCD_TILE_COLS && ret == ESP_OK; ) {
+            if (!dirty[c]) {
+                c++;
+                continue;
+            }
+
+            int c0 = c;
+            while (c < LCD_TILE_COLS && dirty[c]) {
+                c++;
+            }
+
+            int run_x = c0 * LCD_TILE_SIZE;
+            int run_w = (c - c0) * LCD_TILE_SIZE;
+            size_t run_bytes = (size_t)run_w * LCD_TILE_SIZE * sizeof(uint16_t);
+
+            if (run_w == LCD_PREVIEW_WIDTH) {
+                if (stream_y != band_y) {
+                    ret = lcd_stream_set_window(x, y + band_y, LCD_PREVIEW_WIDTH, LCD_PREVIEW_HEIGHT - band_y);
+                }
+                stream_y = band_y + LCD_TILE_SIZE;
+            } else {
+                ret = lcd_stream_set_window(x + run_x, y + band_y, run_w, LCD_TILE_SIZE);
+                stream_y = -1;
+            }
+
+            if (ret != ESP_OK) {
+                break;
+            }
+
+#if !LCD_PREVIEW_SWAP_BYTES
+            if (native && run_w == LCD_PREVIEW_WIDTH) {
+                /* 整条带在帧缓冲中本身连续，零拷贝发送 */
+                ret = lcd_stream_submit_ext(band_src, run_bytes);
+            } else
+#endif
+            {
+                uint16_t *buf = lcd_stream_acquire();
+                lcd_pack_rect(buf, band_src + run_x, LCD_PREVIEW_WIDTH, run_w, LCD_TILE_SIZE);
+                ret = lcd_stream_submit(buf, run_bytes);
+            }
+
+            tiles_sent += c - c0;
+        }
+    }
+
+    /* 帧缓冲归还前必须等待所有DMA完成 */
+    lcd_stream_end_frame();
+
+    /* 发送失败时屏幕内容未知，下一帧整屏刷新 */
+    s_preview.hash_valid = (ret == ESP_OK);
+
+    s_preview.stats.frames++;
+    s_preview.stats.full_refreshes += full_refresh ? 1 : 0;
+    s_preview.stats.last_tiles_sent = tiles_sent;
+    s_preview.stats.tiles_sent += tiles_sent;
+
+    return ret;
+}
+
+/**
+ * @brief       记录一帧显示完成的时间，累计帧间隔
+ * @retval      无
+ */
+static void lcd_preview_record_timing(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (s_timing.frames == 0) {
+        s_timing.window_start_us = now;
+    } else {
+        uint32_t interval = (uint32_t)(now - s_timing.last_show_us);
+        s_timing.intervals++;
+        s_timing.interval_sum += interval;
+        s_timing.interval_sq_sum += (uint64_t)interval * interval;
+        if (interval > s_timing.interval_max) {
+            s_timing.interval_max = interval;
+        }
+    }
+
+    s_timing.last_show_us = now;
+    s_timing.frames++;
+}
+
+/**
+ * @brief       显示任务：等待信箱投递，显示最新帧后归还帧缓冲
+ * @param       arg: 未使用
+ * @retval      无
+ */
+static void lcd_preview_task(void *arg)
+{
+    (void)arg;
+    bool watchdog_active = false;
+    esp_err_t wdt_ret = esp_task_wdt_add(NULL);
+
+    if (wdt_ret == ESP_OK) {
+        watchdog_active = true;
+    } else {
+        ESP_LOGW(TAG, "Failed to add display task to watchdog: %s", esp_err_to_name(wdt_ret));
+    }
+
+    /* 拍照前状态管理器等待本任务交出信箱中的帧 */
+    system_state_register_client(SYSTEM_CLIENT_LCD);
+
+    while (1) {
+        if (watchdog_active) {
+            esp_task_wdt_reset();
+        }
+
+        /* MSR01级确认暂停后不再有新帧投递，信箱取空即可确认 */
+        bool upstream_paused = !system_can_update_lcd() && system_state_client_paused(SYSTEM_CLIENT_AI);
+
+        /* 最多等待100ms，保证看门狗按时喂 */
+        camera_fb_t *fb = frame_ring_pop(&s_display.mailbox, upstream_paused ? 0 : pdMS_TO_TICKS(100), NULL);
+        if (!fb) {
+            if (upstream_paused) {
+                if (watchdog_active && esp_task_wdt_delete(NULL) == ESP_OK) {
+                    watchdog_active = false;
+                }
+                system_state_ack_pause(SYSTEM_CLIENT_LCD);
+                system_state_wait_resume(SYSTEM_CLIENT_LCD);
+                if (!watchdog_active && esp_task_wdt_add(NULL) == ESP_OK) {
+                    watchdog_active = true;
+                }
+            }
+            continue;
+        }
+
+        /* 拍照上传期间不访问LCD（避免SPI冲突），直接归还帧缓冲 */
+        if (!system_can_update_lcd() || !lcd_preview_lock(100)) {
+            s_preview.stats.frames_skipped++;
+        } else {
+            int64_t lat_start = LAT_STAMP();
+            if (lcd_preview_show_frame(fb, s_display.x, s_display.y) == ESP_OK) {
+                LAT_RECORD(LAT_STAGE_LCD, lat_start);
+                /* 摄像头驱动以esp_timer时间戳记录帧采集时间 */
+                LAT_RECORD(LAT_STAGE_GLASS_TO_LCD, (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec);
+                lcd_preview_record_timing();
+            } else {
+                ESP_LOGD(TAG, "LCD preview frame not shown");
+            }
+            lcd_preview_unlock();
+        }
+
+        esp_camera_fb_return(fb);
+
+        if (s_timing.frames >= LCD_PREVIEW_STATS_FRAMES) {
+            lcd_preview_log_stats();
+        }
+    }
+}
+
+/**
+ * @brief       创建显示任务（LCD_PREVIEW_TASK_PRIO/LCD_PREVIEW_TASK_CORE），从帧信箱取最新帧显示
+ * @param       x/y: 预览窗口在屏幕上的位置
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_preview_start_task(uint16_t x, uint16_t y)
+{
+    if (s_display.task) {
+        return ESP_OK;
+    }
+
+    if (!s_preview.band_buf) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_display.x = x;
+    s_display.y = y;
+
+    if (xTaskCreatePinnedToCore(lcd_preview_task, "lcd_preview", LCD_PREVIEW_TASK_STACK, NULL,
+                                LCD_PREVIEW_TASK_PRIO, &s_display.task, LCD_PREVIEW_TASK_CORE) != pdPASS) {
+        s_display.task = NULL;
+        ESP_LOGE(TAG, "Failed to create display task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Display task started on core %d, priority %d", LCD_PREVIEW_TASK_CORE, LCD_PREVIEW_TASK_PRIO);
+    return ESP_OK;
+}
+
+/**
+ * @brief       把一帧投递到显示信箱（只保留最新一帧，被替换的旧帧立即归还摄像头驱动）
+ * @note        帧的所有权转交给显示任务，调用者不得再访问或归还该帧
+ * @param       fb: 摄像头帧
+ * @retval      无
+ */
+void lcd_preview_post_frame(camera_fb_t *fb)
+{
+    if (!fb) {
+        return;
+    }
+
+    /* 显示跟不上时丢弃旧帧，摄像头驱动不会因帧缓冲被占满而停顿 */
+    frame_ring_push(&s_display.mailbox, fb);
+}
+
+/**
+ * @brief       获取LCD访问权（显示任务之外绘制屏幕前调用）
+ * @param       timeout_ms: 最长等待时间
+ * @retval      true: 成功, false: 超时
+ */
+bool lcd_preview_lock(uint32_t timeout_ms)
+{
+    if (!s_display.lcd_mutex) {
+        return true;
+    }
+
+    return xSemaphoreTake(s_display.lcd_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+/**
+ * @brief       释放LCD访问权
+ * @retval      无
+ */
+void lcd_preview_unlock(void)
+{
+    if (s_display.lcd_mutex) {
+        xSemaphoreGive(s_display.lcd_mutex);
+    }
+}
+
+/**
+ * @brief       使分块缓存失效，下一帧整屏刷新（在预览区域上绘制了其他内容后调用）
+ * @retval      无
+ */
+void lcd_preview_invalidate(void)
+{
+    s_preview.hash_valid = false;
+}
+
+/**
+ * @brief       获取预览统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void lcd_preview_get_stats(lcd_preview_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_preview.stats;
+    }
+}
+
+/**
+ * @brief       输出预览、DMA传输以及显示帧率/抖动统计
+ * @note        帧率与抖动按统计窗口计算，输出后窗口清零
+ * @retval      无
+ */
+void lcd_preview_log_stats(void)
+{
+    lcd_stream_stats_t lcd_stats;
+    lcd_stream_get_stats(&lcd_stats);
+
+    if (lcd_stats.frames == 0 || s_preview.stats.frames == 0) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "LCD stream: %" PRIu32 " frames, avg frame %" PRIu64 " us, fill %" PRIu64
+             " us, DMA wait %" PRIu64 " us, saved %" PRIu64 " us/frame, %" PRIu64 " bytes/frame",
+             lcd_stats.frames, lcd_stats.frame_us / lcd_stats.frames,
+             lcd_stats.fill_us / lcd_stats.frames, lcd_stats.wait_us / lcd_stats.frames,
+             lcd_stats.saved_us / lcd_stats.frames, lcd_stats.bytes / lcd_stats.frames);
+    ESP_LOGI(TAG, "LCD tiles: last %" PRIu32 "/%" PRIu32 ", avg %" PRIu64 " per frame, %" PRIu32 " full refreshes",
+             s_preview.stats.last_tiles_sent, s_preview.stats.tiles_per_frame,
+             s_preview.stats.tiles_sent / s_preview.stats.frames, s_preview.stats.full_refreshes);
+
+    frame_ring_stats_t ring;
+    frame_ring_get_stats(&s_display.mailbox, &ring);
+
+    if (s_timing.intervals > 0) {
+        int64_t span_us = s_timing.last_show_us - s_timing.window_start_us;
+        double mean = (double)s_timing.interval_sum / s_timing.intervals;
+        double var = (double)s_timing.interval_sq_sum / s_timing.intervals - mean * mean;
+        double fps = span_us > 0 ? s_timing.intervals * 1000000.0 / span_us : 0.0;
+
+        ESP_LOGI(TAG, "LCD display: %.1f fps, interval avg %.1f ms, jitter %.1f ms, max %.1f ms, "
+                 "%" PRIu32 " replaced, %" PRIu32 " skipped, mailbox residency avg %" PRIu32 " us max %" PRIu32 " us",
+                 fps, mean / 1000.0, (var > 0.0 ? sqrt(var) : 0.0) / 1000.0, s_timing.interval_max / 1000.0,
+                 ring.dropped, s_preview.stats.frames_skipped,
+                 ring.popped ? (uint32_t)(ring.residency_us / ring.popped) : 0, ring.residency_max_us);
+    }
+
+    memset(&s_timing, 0, sizeof(s_timing));
+}
@@ -0,0 +1,113 @@
+#ifndef __LCD_PREVIEW_H__
+#define __LCD_PREVIEW_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LCD_PREVIEW_WIDTH               320     /* 预览窗口宽度 */
+#define LCD_PREVIEW_HEIGHT              240     /* 预览窗口高度 */
+
+/* 预览缩放方式：1使用Q8定点双线性插值，0使用最近邻 */
+#define LCD_PREVIEW_BILINEAR            1
+
+/* 原生320x240帧：0直接从帧缓冲DMA（面板与摄像头字节序一致），1先交换字节再发送 */
+#define LCD_PREVIEW_SWAP_BYTES          0
+
+#define LCD_TILE_SIZE                   16      /* 变化检测分块边长（像素） */
+#define LCD_TILE_FULL_REFRESH_FRAMES    30      /* 每N帧强制整屏刷新一次 */
+
+/* 分块哈希前的像素掩码（大端RGB565按本机读出的顺序）：
+ * 0x9CE7 即 0xE79C 交换字节，保留R/B高3位、G高4位，忽略传感器噪声引起的低位抖动 */
+#define LCD_TILE_HASH_MASK              0x9CE7u
+
+/* 显示任务：运行在core 0，高于同核的MNP01(4)与距离检测/绘制(5)级，推理负载不打断预览帧；
+ * 等待帧信箱与SPI DMA完成时阻塞，让出的CPU仍归流水线使用 */
+#define LCD_PREVIEW_TASK_PRIO           6
+#define LCD_PREVIEW_TASK_CORE           0
+#define LCD_PREVIEW_TASK_STACK          (4 * 1024)
+#define LCD_PREVIEW_STATS_FRAMES        200     /* 每显示N帧输出一次帧率与抖动统计 */
+
+/**
+ * @brief       LCD预览统计（累计值）
+ */
+typedef struct {
+    uint32_t frames;            /*!< 已显示帧数 */
+    uint32_t full_refreshes;    /*!< 整屏刷新次数 */
+    uint32_t last_tiles_sent;   /*!< 最近一帧发送的分块数 */
+    uint64_t tiles_sent;        /*!< 累计发送的分块数 */
+    uint32_t tiles_per_frame;   /*!< 每帧分块总数 */
+    uint32_t frames_skipped;    /*!< 因LCD被占用（拍照上传）而未显示的帧数 */
+} lcd_preview_stats_t;
+
+/**
+ * @brief       初始化LCD预览（DMA乒乓缓冲区、分块状态）
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_preview_init(void);
+
+/**
+ * @brief       显示一帧：必要时缩放到预览尺寸，仅发送内容变化的分块
+ * @param       fb: 摄像头帧（RGB565）
+ * @param       x/y: 预览窗口在屏幕上的位置
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_preview_show_frame(const camera_fb_t *fb, uint16_t x, uint16_t y);
+
+/**
+ * @brief       创建显示任务（LCD_PREVIEW_TASK_PRIO/LCD_PREVIEW_TASK_CORE），从帧信箱取最新帧显示
+ * @param       x/y: 预览窗口在屏幕上的位置
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_preview_start_task(uint16_t x, uint16_t y);
+
+/**
+ * @brief       把一帧投递到显示信箱（只保留最新一帧，被替换的旧帧立即归还摄像头驱动）
+ * @note        帧的所有权转交给显示任务，调用者不得再访问或归还该帧
+ * @param       fb: 摄像头帧
+ * @retval      无
+ */
+void lcd_preview_post_frame(camera_fb_t *fb);
+
+/**
+ * @brief       获取LCD访问权（显示任务之外绘制屏幕前调用）
+ * @param       timeout_ms: 最长等待时间
+ * @retval      true: 成功, false: 超时
+ */
+bool lcd_preview_lock(uint32_t timeout_ms);
+
+/**
+ * @brief       释放LCD访问权
+ * @retval      无
+ */
+void lcd_preview_unlock(void);
+
+/**
+ * @brief       使分块缓存失效，下一帧整屏刷新（在预览区域上绘制了其他内容后调用）
+ * @retval      无
+ */
+void lcd_preview_invalidate(void);
+
+/**
+ * @brief       获取预览统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void lcd_preview_get_stats(lcd_preview_stats_t *stats);
+
+/**
+ * @brief       输出预览、DMA传输以及显示帧率/抖动统计
+ * @retval      无
+ */
+void lcd_preview_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LCD_PREVIEW_H__ */
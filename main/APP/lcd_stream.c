@@ -0,0 +1,273 @@
+#include "lcd_stream.h"
+#include "lcd.h"
+#include "driver/spi_master.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdbool.h>
+
+static const char *TAG = "LcdStream";
+
+/**
+ * @brief       乒乓缓冲区与SPI事务（常驻，避免每帧malloc）
+ * @note        仅供单一任务调用；传输使用BSP的MY_LCD_Handle排队DMA，
+ *              完成由SPI驱动的事务结果队列（中断中投递）通知
+ */
+static struct {
+    uint16_t *buf[LCD_STREAM_BUF_COUNT];
+    spi_transaction_t trans[LCD_STREAM_BUF_COUNT];
+    size_t buf_size;
+    int next;                   /* 下一个要填充的缓冲区 */
+    int in_flight;              /* 已提交未完成的事务数 */
+    int freq_khz;               /* SPI实际时钟，用于折算传输耗时 */
+    bool frame_open;            /* 是否处于begin/end之间 */
+    int64_t frame_start_us;
+    int64_t fill_start_us;
+    uint64_t frame_bytes;
+    uint64_t frame_fill_us;
+    uint64_t frame_wait_us;
+    lcd_stream_stats_t stats;
+} s_stream = {0};
+
+/**
+ * @brief       等待最早提交的一个事务完成
+ * @retval      无
+ */
+static void lcd_stream_wait_one(void)
+{
+    spi_transaction_t *done = NULL;
+    int64_t t0 = esp_timer_get_time();
+
+    esp_err_t ret = spi_device_get_trans_result(MY_LCD_Handle, &done, portMAX_DELAY);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI transaction result error: %s", esp_err_to_name(ret));
+    }
+
+    s_stream.frame_wait_us += esp_timer_get_time() - t0;
+    s_stream.in_flight--;
+}
+
+/**
+ * @brief       使用下一个事务槽排队一次DMA传输
+ * @param       data: 发送数据
+ * @param       len: 字节数
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+static esp_err_t lcd_stream_queue(const void *data, size_t len)
+{
+    spi_transaction_t *t = &s_stream.trans[s_stream.next];
+    memset(t, 0, sizeof(*t));
+    t->length = len * 8;
+    t->tx_buffer = data;
+
+    LCD_WR(1);  /* 数据模式 */
+    esp_err_t ret = spi_device_queue_trans(MY_LCD_Handle, t, portMAX_DELAY);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue SPI transaction: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    s_stream.in_flight++;
+    s_stream.frame_bytes += len;
+    s_stream.next = (s_stream.next + 1) % LCD_STREAM_BUF_COUNT;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief       初始化LCD流式传输，分配常驻的DMA乒乓缓冲区
+ * @param       line_width: 每行像素数
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_init(uint16_t line_width)
+{
+    if (s_stream.buf[0]) {
+        return ESP_OK;
+    }
+
+    s_stream.buf_size = (size_t)line_width * LCD_STREAM_LINES * sizeof(uint16_t);
+
+    for (int i = 0; i < LCD_STREAM_BUF_COUNT; i++) {
+        s_stream.buf[i] = heap_caps_malloc(s_stream.buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!s_stream.buf[i]) {
+            ESP_LOGE(TAG, "Failed to allocate DMA line buffer %d (%zu bytes)", i, s_stream.buf_size);
+            for (int j = 0; j < i; j++) {
+                heap_caps_free(s_stream.buf[j]);
+                s_stream.buf[j] = NULL;
+            }
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (spi_device_get_actual_freq(MY_LCD_Handle, &s_stream.freq_khz) != ESP_OK) {
+        s_stream.freq_khz = 0;
+    }
+
+    ESP_LOGI(TAG, "LCD stream ready: %d x %zu bytes DMA buffers, SPI %d kHz",
+             LCD_STREAM_BUF_COUNT, s_stream.buf_size, s_stream.freq_khz);
+    return ESP_OK;
+}
+
+/**
+ * @brief       开始一帧：等待上一帧传输完成并开始计时
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_begin_frame(void)
+{
+    if (!s_stream.buf[0]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    while (s_stream.in_flight > 0) {
+        lcd_stream_wait_one();
+    }
+
+    s_stream.frame_open = true;
+    s_stream.frame_start_us = esp_timer_get_time();
+    s_stream.frame_bytes = 0;
+    s_stream.frame_fill_us = 0;
+    s_stream.frame_wait_us = 0;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief       等待已排队的传输完成后设置显示窗口（一帧内可多次调用）
+ * @param       x/y: 窗口起点
+ * @param       width/height: 窗口大小
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_set_window(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+    if (!s_stream.buf[0] || width == 0 || height == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* 设置窗口是命令传输，必须在所有数据DMA结束后进行 */
+    while (s_stream.in_flight > 0) {
+        lcd_stream_wait_one();
+    }
+
+    lcd_set_window(x, y, x + width - 1, y + height - 1);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief       获取下一个可填充的乒乓缓冲区，两块都在传输时阻塞等待最早的一块完成
+ * @retval      缓冲区指针（容纳LCD_STREAM_LINES行），未初始化时返回NULL
+ */
+uint16_t *lcd_stream_acquire(void)
+{
+    if (!s_stream.buf[0]) {
+        return NULL;
+    }
+
+    /* 事务按提交顺序完成，最早提交的正是下一个要复用的缓冲区 */
+    if (s_stream.in_flight >= LCD_STREAM_BUF_COUNT) {
+        lcd_stream_wait_one();
+    }
+
+    s_stream.fill_start_us = esp_timer_get_time();
+    return s_stream.buf[s_stream.next];
+}
+
+/**
+ * @brief       提交已填充的缓冲区进行异步DMA传输，立即返回
+ * @param       buf: lcd_stream_acquire返回的缓冲区
+ * @param       len: 有效字节数
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_submit(uint16_t *buf, size_t len)
+{
+    if (buf != s_stream.buf[s_stream.next] || len == 0 || len > s_stream.buf_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_stream.frame_fill_us += esp_timer_get_time() - s_stream.fill_start_us;
+
+    return lcd_stream_queue(buf, len);
+}
+
+/**
+ * @brief       直接从调用者的缓冲区异步DMA发送（零拷贝），按LCD_BUF_SIZE分段排队
+ * @param       data: 数据指针，在lcd_stream_end_frame返回前必须保持有效
+ * @param       len: 字节数
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_submit_ext(const void *data, size_t len)
+{
+    if (!s_stream.buf[0]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!data || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint8_t *ptr = (const uint8_t *)data;
+
+    while (len > 0) {
+        size_t piece = len > LCD_BUF_SIZE ? LCD_BUF_SIZE : len;
+
+        /* 与乒乓缓冲区共用事务槽，排队深度保持在LCD_STREAM_BUF_COUNT以内 */
+        if (s_stream.in_flight >= LCD_STREAM_BUF_COUNT) {
+            lcd_stream_wait_one();
+        }
+
+        esp_err_t ret = lcd_stream_queue(ptr, piece);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+
+        ptr += piece;
+        len -= piece;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief       结束一帧：等待所有传输完成并累计统计（未开始帧时只等待传输完成）
+ * @retval      无
+ */
+void lcd_stream_end_frame(void)
+{
+    while (s_stream.in_flight > 0) {
+        lcd_stream_wait_one();
+    }
+
+    if (!s_stream.frame_open) {
+        return;
+    }
+    s_stream.frame_open = false;
+
+    uint64_t frame_us = esp_timer_get_time() - s_stream.frame_start_us;
+    uint64_t tx_us = s_stream.freq_khz > 0 ?
+                     (s_stream.frame_bytes * 8 * 1000) / (uint64_t)s_stream.freq_khz : 0;
+
+    s_stream.stats.frames++;
+    s_stream.stats.bytes += s_stream.frame_bytes;
+    s_stream.stats.frame_us += frame_us;
+    s_stream.stats.fill_us += s_stream.frame_fill_us;
+    s_stream.stats.wait_us += s_stream.frame_wait_us;
+    s_stream.stats.tx_us += tx_us;
+
+    /* 串行方式下CPU要为整个传输阻塞，异步方式只阻塞了wait_us，其余被填充时间掩盖 */
+    if (tx_us > s_stream.frame_wait_us) {
+        s_stream.stats.saved_us += tx_us - s_stream.frame_wait_us;
+    }
+}
+
+/**
+ * @brief       获取累计统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void lcd_stream_get_stats(lcd_stream_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_stream.stats;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef __LCD_STREAM_H__
+#define __LCD_STREAM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LCD_STREAM_LINES        16      /* 每个乒乓缓冲区容纳的行数（与LCD预览分块大小一致） */
+#define LCD_STREAM_BUF_COUNT    2       /* 乒乓缓冲区个数 */
+
+/**
+ * @brief       LCD流式传输统计（累计值）
+ */
+typedef struct {
+    uint32_t frames;        /*!< 已传输帧数 */
+    uint64_t bytes;         /*!< 已传输字节数 */
+    uint64_t frame_us;      /*!< 帧总耗时 */
+    uint64_t fill_us;       /*!< 填充缓冲区（缩放）耗时 */
+    uint64_t wait_us;       /*!< 等待DMA完成的阻塞耗时 */
+    uint64_t tx_us;         /*!< 按SPI实际时钟折算的传输耗时 */
+    uint64_t saved_us;      /*!< 与串行“填充+阻塞发送”相比节省的时间 */
+} lcd_stream_stats_t;
+
+/**
+ * @brief       初始化LCD流式传输，分配常驻的DMA乒乓缓冲区
+ * @param       line_width: 每行像素数
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_init(uint16_t line_width);
+
+/**
+ * @brief       开始一帧：等待上一帧传输完成并开始计时
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_begin_frame(void);
+
+/**
+ * @brief       等待已排队的传输完成后设置显示窗口（一帧内可多次调用）
+ * @param       x/y: 窗口起点
+ * @param       width/height: 窗口大小
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_set_window(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+/**
+ * @brief       获取下一个可填充的乒乓缓冲区，两块都在传输时阻塞等待最早的一块完成
+ * @retval      缓冲区指针（容纳LCD_STREAM_LINES行），未初始化时返回NULL
+ */
+uint16_t *lcd_stream_acquire(void);
+
+/**
+ * @brief       提交已填充的缓冲区进行异步DMA传输，立即返回
+ * @param       buf: lcd_stream_acquire返回的缓冲区
+ * @param       len: 有效字节数
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_submit(uint16_t *buf, size_t len);
+
+/**
+ * @brief       直接从调用者的缓冲区异步DMA发送（零拷贝），按LCD_BUF_SIZE分段排队
+ * @param       data: 数据指针，在lcd_stream_end_frame返回前必须保持有效
+ * @param       len: 字节数
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t lcd_stream_submit_ext(const void *data, size_t len);
+
+/**
+ * @brief       结束一帧：等待所有传输完成并累计统计（未开始帧时只等待传输完成）
+ * @retval      无
+ */
+void lcd_stream_end_frame(void);
+
+/**
+ * @brief       获取累计统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void lcd_stream_get_stats(lcd_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LCD_STREAM_H__ */
@@ -0,0 +1,129 @@
+#include "motion_gate.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* Y ≈ 0.299R + 0.587G + 0.114B，按5/6/5位分量换算后放大64倍 */
+#define MOTION_LUMA_R       157
+#define MOTION_LUMA_G       152
+#define MOTION_LUMA_B       60
+
+/**
+ * @brief       从大端RGB565帧生成MOTION_THUMB_W x MOTION_THUMB_H的亮度缩略图（块内隔点采样求平均）
+ * @param       src: 源帧（大端RGB565，与摄像头帧缓冲字节序一致）
+ * @param       width/height: 源帧宽高（不小于缩略图尺寸）
+ * @param       thumb: 输出缩略图
+ * @retval      无
+ */
+void motion_luma_thumb_rgb565be(const uint16_t *src, int width, int height, uint8_t *thumb)
+{
+    int block_w = width / MOTION_THUMB_W;
+    int block_h = height / MOTION_THUMB_H;
+    int step_x = block_w >= 2 ? 2 : 1;
+    int step_y = block_h >= 2 ? 2 : 1;
+    uint32_t samples = (uint32_t)((block_w + step_x - 1) / step_x) * ((block_h + step_y - 1) / step_y);
+
+    for (int ty = 0; ty < MOTION_THUMB_H; ty++) {
+        for (int tx = 0; tx < MOTION_THUMB_W; tx++) {
+            const uint16_t *block = src + (size_t)ty * block_h * width + tx * block_w;
+            uint32_t sum = 0;
+
+            for (int y = 0; y < block_h; y += step_y) {
+                const uint16_t *row = block + (size_t)y * width;
+                for (int x = 0; x < block_w; x += step_x) {
+                    uint16_t p = row[x];
+                    p = (uint16_t)((p >> 8) | (p << 8));
+                    sum += ((p >> 11) & 0x1F) * MOTION_LUMA_R + ((p >> 5) & 0x3F) * MOTION_LUMA_G
+                         + (p & 0x1F) * MOTION_LUMA_B;
+                }
+            }
+
+            thumb[ty * MOTION_THUMB_W + tx] = (uint8_t)((sum / samples) >> 6);
+        }
+    }
+}
+
+/**
+ * @brief       比较两幅缩略图
+ * @param       a/b: 缩略图
+ * @param       cell_threshold: 单格变化阈值
+ * @param       sad: 输出绝对差之和，可为NULL
+ * @retval      变化超过阈值的格数
+ */
+uint32_t motion_thumb_diff(const uint8_t *a, const uint8_t *b, uint8_t cell_threshold, uint32_t *sad)
+{
+    uint32_t changed = 0;
+    uint32_t total = 0;
+
+    for (int i = 0; i < MOTION_THUMB_W * MOTION_THUMB_H; i++) {
+        int d = abs((int)a[i] - (int)b[i]);
+        total += d;
+        changed += d > cell_threshold;
+    }
+
+    if (sad) {
+        *sad = total;
+    }
+
+    return changed;
+}
+
+/**
+ * @brief       初始化运动门控
+ * @param       gate: 门控状态
+ * @retval      无
+ */
+void motion_gate_init(motion_gate_t *gate)
+{
+    memset(gate, 0, sizeof(*gate));
+}
+
+/**
+ * @brief       判断本帧是否需要推理（须在帧上绘制检测框之前调用）
+ * @param       gate: 门控状态
+ * @param       src: 摄像头帧（大端RGB565）
+ * @param       width/height: 帧宽高
+ * @param       now_us: 当前时间（us）
+ * @retval      true: 需要推理, false: 画面静止，可复用上次结果
+ */
+bool motion_gate_check(motion_gate_t *gate, const uint16_t *src, int width, int height, int64_t now_us)
+{
+    gate->checks++;
+
+    if (width < MOTION_THUMB_W || height < MOTION_THUMB_H) {
+        gate->ref_valid = false;
+        return true;
+    }
+
+    motion_luma_thumb_rgb565be(src, width, height, gate->cur);
+
+    if (!gate->ref_valid) {
+        return true;
+    }
+
+    /* 与上次推理帧比较，缓慢的光照漂移也会累积到阈值 */
+    gate->last_changed = motion_thumb_diff(gate->ref, gate->cur, MOTION_CELL_THRESHOLD, NULL);
+    if (gate->last_changed >= MOTION_MIN_CELLS) {
+        return true;
+    }
+
+    if (now_us - gate->last_infer_us >= MOTION_MAX_STALE_US) {
+        gate->stale++;
+        return true;
+    }
+
+    gate->skipped++;
+    return false;
+}
+
+/**
+ * @brief       推理完成后把当前缩略图设为参考
+ * @param       gate: 门控状态
+ * @param       now_us: 推理时间（us）
+ * @retval      无
+ */
+void motion_gate_commit(motion_gate_t *gate, int64_t now_us)
+{
+    memcpy(gate->ref, gate->cur, sizeof(gate->ref));
+    gate->ref_valid = true;
+    gate->last_infer_us = now_us;
+}
@@ -0,0 +1,78 @@
+#ifndef __MOTION_GATE_H__
+#define __MOTION_GATE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOTION_THUMB_W              40          /* 亮度缩略图宽度 */
+#define MOTION_THUMB_H              30          /* 亮度缩略图高度 */
+#define MOTION_CELL_THRESHOLD       12          /* 单格亮度变化超过该值（0-255）视为变化 */
+#define MOTION_MIN_CELLS            6           /* 变化格数达到该值视为有运动 */
+#define MOTION_MAX_STALE_US         2000000     /* 复用检测结果的最长时间，超时强制推理 */
+
+/**
+ * @brief       运动门控状态
+ */
+typedef struct {
+    uint8_t ref[MOTION_THUMB_W * MOTION_THUMB_H];   /*!< 上次推理帧的缩略图 */
+    uint8_t cur[MOTION_THUMB_W * MOTION_THUMB_H];   /*!< 当前帧的缩略图 */
+    bool ref_valid;                                 /*!< ref是否有效 */
+    int64_t last_infer_us;                          /*!< 上次推理时间 */
+    uint32_t last_changed;                          /*!< 最近一次比较的变化格数 */
+    uint32_t checks;                                /*!< 累计门控判断次数 */
+    uint32_t skipped;                               /*!< 因画面静止而跳过的推理次数 */
+    uint32_t stale;                                 /*!< 画面静止但结果过期而强制推理的次数 */
+} motion_gate_t;
+
+/**
+ * @brief       从大端RGB565帧生成MOTION_THUMB_W x MOTION_THUMB_H的亮度缩略图（块内隔点采样求平均）
+ * @param       src: 源帧（大端RGB565，与摄像头帧缓冲字节序一致）
+ * @param       width/height: 源帧宽高（不小于缩略图尺寸）
+ * @param       thumb: 输出缩略图
+ * @retval      无
+ */
+void motion_luma_thumb_rgb565be(const uint16_t *src, int width, int height, uint8_t *thumb);
+
+/**
+ * @brief       比较两幅缩略图
+ * @param       a/b: 缩略图
+ * @param       cell_threshold: 单格变化阈值
+ * @param       sad: 输出绝对差之和，可为NULL
+ * @retval      变化超过阈值的格数
+ */
+uint32_t motion_thumb_diff(const uint8_t *a, const uint8_t *b, uint8_t cell_threshold, uint32_t *sad);
+
+/**
+ * @brief       初始化运动门控
+ * @param       gate: 门控状态
+ * @retval      无
+ */
+void motion_gate_init(motion_gate_t *gate);
+
+/**
+ * @brief       判断本帧是否需要推理（须在帧上绘制检测框之前调用）
+ * @param       gate: 门控状态
+ * @param       src: 摄像头帧（大端RGB565）
+ * @param       width/height: 帧宽高
+ * @param       now_us: 当前时间（us）
+ * @retval      true: 需要推理, false: 画面静止，可复用上次结果
+ */
+bool motion_gate_check(motion_gate_t *gate, const uint16_t *src, int width, int height, int64_t now_us);
+
+/**
+ * @brief       推理完成后把当前缩略图设为参考
+ * @param       gate: 门控状态
+ * @param       now_us: 推理时间（us）
+ * @retval      无
+ */
+void motion_gate_commit(motion_gate_t *gate, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MOTION_GATE_H__ */
@@ -0,0 +1,501 @@
+#include "persist_store.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+static const char *TAG = "PersistStore";
+
+/**
+ * @brief       挂起操作类型
+ */
+typedef enum {
+    PERSIST_OP_BLOB = 0,
+    PERSIST_OP_U32,
+    PERSIST_OP_ERASE_NS,
+} persist_op_t;
+
+/**
+ * @brief       挂起表项：同一命名空间/键只保留最新值，seq保证落盘顺序与请求顺序一致
+ */
+typedef struct {
+    bool used;
+    uint8_t op;
+    uint16_t len;
+    uint32_t seq;
+    char ns[PERSIST_NAME_LEN];
+    char key[PERSIST_NAME_LEN];
+    uint8_t data[PERSIST_MAX_BLOB];
+} persist_entry_t;
+
+static persist_entry_t s_pending[PERSIST_MAX_ENTRIES];     /* 等待写入 */
+static persist_entry_t s_inflight[PERSIST_MAX_ENTRIES];    /* 正在写入（读取时仍需可见） */
+static int s_inflight_count = 0;
+static uint32_t s_seq = 0;
+static volatile bool s_flush_now = false;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static persist_stats_t s_stats;
+
+/**
+ * @brief       统计挂起表中的有效项（需持锁）
+ * @retval      项数
+ */
+static int persist_pending_count(void)
+{
+    int n = 0;
+
+    for (int i = 0; i < PERSIST_MAX_ENTRIES; i++) {
+        n += s_pending[i].used;
+    }
+
+    return n;
+}
+
+/**
+ * @brief       挂起一次写/擦请求
+ * @param       op: 操作类型
+ * @param       ns: 命名空间
+ * @param       key: 键名（擦除时忽略）
+ * @param       data: 数据（擦除时忽略）
+ * @param       len: 字节数
+ * @retval      ESP_OK: 已挂起, 其他: 失败
+ */
+static esp_err_t persist_enqueue(persist_op_t op, const char *ns, const char *key, const void *data, size_t len)
+{
+    if (ns == NULL || strlen(ns) >= PERSIST_NAME_LEN || len > PERSIST_MAX_BLOB ||
+        (op != PERSIST_OP_ERASE_NS && (key == NULL || strlen(key) >= PERSIST_NAME_LEN || data == NULL))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    persist_entry_t *slot = NULL;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    for (int i = 0; i < PERSIST_MAX_ENTRIES; i++) {
+        persist_entry_t *e = &s_pending[i];
+
+        if (!e->used || strcmp(e->ns, ns) != 0) {
+            continue;
+        }
+        if (op == PERSIST_OP_ERASE_NS) {
+            /* 之后整个命名空间都会被擦除，先前挂起的写入无需落盘 */
+            e->used = false;
+            s_stats.coalesced++;
+        } else if (e->op != PERSIST_OP_ERASE_NS && strcmp(e->key, key) == 0) {
+            slot = e;
+            s_stats.coalesced++;
+        }
+    }
+
+    for (int i = 0; slot == NULL && i < PERSIST_MAX_ENTRIES; i++) {
+        if (!s_pending[i].used) {
+            slot = &s_pending[i];
+        }
+    }
+
+    if (slot == NULL) {
+        xSemaphoreGive(s_lock);
+        ESP_LOGW(TAG, "Pending table full, dropping write %s/%s", ns, key ? key : "*");
+        return ESP_ERR_NO_MEM;
+    }
+
+    slot->used = true;
+    slot->op = op;
+    slot->len = len;
+    slot->seq = ++s_seq;
+    strcpy(slot->ns, ns);
+    if (op == PERSIST_OP_ERASE_NS) {
+        slot->key[0] = '\0';
+    } else {
+        strcpy(slot->key, key);
+        memcpy(slot->data, data, len);
+    }
+    s_stats.requests++;
+
+    xSemaphoreGive(s_lock);
+
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+}
+
+/**
+ * @brief       挂起一个二进制值，由后台任务合并后写入并提交
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       data: 数据
+ * @param       len: 字节数
+ * @retval      ESP_OK: 已挂起, 其他: 失败
+ */
+esp_err_t persist_set_blob(const char *ns, const char *key, const void *data, size_t len)
+{
+    return persist_enqueue(PERSIST_OP_BLOB, ns, key, data, len);
+}
+
+/**
+ * @brief       挂起一个u32值
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       value: 值
+ * @retval      ESP_OK: 已挂起, 其他: 失败
+ */
+esp_err_t persist_set_u32(const char *ns, const char *key, uint32_t value)
+{
+    return persist_enqueue(PERSIST_OP_U32, ns, key, &value, sizeof(value));
+}
+
+/**
+ * @brief       挂起擦除整个命名空间
+ * @param       ns: 命名空间
+ * @retval      ESP_OK: 已挂起, 其他: 失败
+ */
+esp_err_t persist_erase_namespace(const char *ns)
+{
+    return persist_enqueue(PERSIST_OP_ERASE_NS, ns, NULL, NULL, 0);
+}
+
+/**
+ * @brief       在挂起/写入中的表里查找键（需持锁）
+ * @param       table: 表
+ * @param       count: 表长
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       erased: 输出，命名空间是否有挂起的擦除
+ * @retval      找到的项，没有时为NULL
+ */
+static const persist_entry_t *persist_lookup(const persist_entry_t *table, int count,
+                                             const char *ns, const char *key, bool *erased)
+{
+    const persist_entry_t *found = NULL;
+
+    for (int i = 0; i < count; i++) {
+        const persist_entry_t *e = &table[i];
+
+        if (!e->used || strcmp(e->ns, ns) != 0) {
+            continue;
+        }
+        if (e->op == PERSIST_OP_ERASE_NS) {
+            *erased = true;
+        } else if (strcmp(e->key, key) == 0) {
+            found = e;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief       读取值：挂起表 > 写入中 > NVS
+ * @param       op: 期望的类型
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       data: 输出缓冲
+ * @param       len: 输入缓冲大小，输出实际长度
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+static esp_err_t persist_read(persist_op_t op, const char *ns, const char *key, void *data, size_t *len)
+{
+    if (ns == NULL || key == NULL || data == NULL || len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_lock) {
+        const persist_entry_t *e = NULL;
+        bool erased = false;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        e = persist_lookup(s_pending, PERSIST_MAX_ENTRIES, ns, key, &erased);
+        if (e == NULL && !erased) {
+            e = persist_lookup(s_inflight, s_inflight_count, ns, key, &erased);
+        }
+        if (e != NULL) {
+            esp_err_t ret = ESP_OK;
+            if (e->op != op || e->len > *len) {
+                ret = ESP_ERR_NVS_INVALID_LENGTH;
+            } else {
+                memcpy(data, e->data, e->len);
+                *len = e->len;
+            }
+            xSemaphoreGive(s_lock);
+            return ret;
+        }
+        xSemaphoreGive(s_lock);
+
+        if (erased) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(ns, NVS_READONLY, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (op == PERSIST_OP_U32) {
+        ret = *len >= sizeof(uint32_t) ? nvs_get_u32(handle, key, (uint32_t *)data) : ESP_ERR_NVS_INVALID_LENGTH;
+        *len = sizeof(uint32_t);
+    } else {
+        ret = nvs_get_blob(handle, key, data, len);
+    }
+
+    nvs_close(handle);
+    return ret;
+}
+
+/**
+ * @brief       读取二进制值，优先返回尚未落盘的挂起值
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       data: 输出缓冲
+ * @param       len: 输入缓冲大小，输出实际长度
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t persist_get_blob(const char *ns, const char *key, void *data, size_t *len)
+{
+    return persist_read(PERSIST_OP_BLOB, ns, key, data, len);
+}
+
+/**
+ * @brief       读取u32值，优先返回尚未落盘的挂起值
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       value: 输出值
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t persist_get_u32(const char *ns, const char *key, uint32_t *value)
+{
+    size_t len = sizeof(*value);
+    return persist_read(PERSIST_OP_U32, ns, key, value, &len);
+}
+
+/**
+ * @brief       按seq排序一批请求（插入排序，批量不超过PERSIST_MAX_ENTRIES），保证“先擦后写”不被颠倒
+ * @param       batch: 请求
+ * @param       count: 请求数
+ * @retval      无
+ */
+static void persist_sort_by_seq(persist_entry_t *batch, int count)
+{
+    for (int i = 1; i < count; i++) {
+        persist_entry_t tmp = batch[i];
+        int j = i - 1;
+        while (j >= 0 && batch[j].seq > tmp.seq) {
+            batch[j + 1] = batch[j];
+            j--;
+        }
+        batch[j + 1] = tmp;
+    }
+}
+
+/**
+ * @brief       写入一批已按seq排序的请求，每个命名空间只提交一次
+ * @param       batch: 请求
+ * @param       count: 请求数
+ * @retval      无
+ */
+static void persist_write_batch(const persist_entry_t *batch, int count)
+{
+    struct {
+        const char *ns;
+        nvs_handle_t handle;
+    } open[PERSIST_MAX_ENTRIES];
+    int open_count = 0;
+    int64_t start_us = esp_timer_get_time();
+    uint32_t writes = 0;
+    uint32_t commits = 0;
+    uint32_t failures = 0;
+
+    for (int i = 0; i < count; i++) {
+        const persist_entry_t *e = &batch[i];
+        nvs_handle_t handle = 0;
+        int h;
+
+        for (h = 0; h < open_count && strcmp(open[h].ns, e->ns) != 0; h++) {
+        }
+        if (h == open_count) {
+            esp_err_t ret = nvs_open(e->ns, NVS_READWRITE, &handle);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Error opening NVS namespace %s: %s", e->ns, esp_err_to_name(ret));
+                failures++;
+                continue;
+            }
+            open[open_count].ns = e->ns;
+            open[open_count].handle = handle;
+            open_count++;
+        }
+        handle = open[h].handle;
+
+        esp_err_t ret;
+        switch (e->op) {
+            case PERSIST_OP_BLOB:
+                ret = nvs_set_blob(handle, e->key, e->data, e->len);
+                break;
+            case PERSIST_OP_U32: {
+                uint32_t v;
+                memcpy(&v, e->data, sizeof(v));
+                ret = nvs_set_u32(handle, e->key, v);
+                break;
+            }
+            default:
+                ret = nvs_erase_all(handle);
+                break;
+        }
+
+        if (ret == ESP_OK) {
+            writes++;
+        } else {
+            ESP_LOGE(TAG, "Error writing %s/%s: %s", e->ns, e->key, esp_err_to_name(ret));
+            failures++;
+        }
+    }
+
+    for (int h = 0; h < open_count; h++) {
+        esp_err_t ret = nvs_commit(open[h].handle);
+        if (ret == ESP_OK) {
+            commits++;
+        } else {
+            ESP_LOGE(TAG, "Error committing %s: %s", open[h].ns, esp_err_to_name(ret));
+            failures++;
+        }
+        nvs_close(open[h].handle);
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.writes += writes;
+    s_stats.commits += commits;
+    s_stats.failures += failures;
+    s_stats.last_commit_us = (uint32_t)(esp_timer_get_time() - start_us);
+    xSemaphoreGive(s_lock);
+
+    ESP_LOGD(TAG, "Persisted %d entries in %" PRIu32 " us", count, s_stats.last_commit_us);
+}
+
+/**
+ * @brief       后台写入任务：收到请求后等待一小段时间合并，再整批写入
+ * @param       arg: 未使用
+ * @retval      无
+ */
+static void persist_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (!s_flush_now) {
+            vTaskDelay(pdMS_TO_TICKS(PERSIST_COALESCE_MS));
+        }
+        s_flush_now = false;
+        ulTaskNotifyTake(pdTRUE, 0);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_inflight_count = 0;
+        for (int i = 0; i < PERSIST_MAX_ENTRIES; i++) {
+            if (s_pending[i].used) {
+                s_inflight[s_inflight_count++] = s_pending[i];
+                s_pending[i].used = false;
+            }
+        }
+        /* 排序会搬动整条记录，须在锁内完成，读者才不会看到搬了一半的条目 */
+        persist_sort_by_seq(s_inflight, s_inflight_count);
+        xSemaphoreGive(s_lock);
+
+        /* 写入期间s_inflight不再改动，读者持锁只读 */
+        if (s_inflight_count > 0) {
+            persist_write_batch(s_inflight, s_inflight_count);
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_inflight_count = 0;
+        xSemaphoreGive(s_lock);
+    }
+}
+
+/**
+ * @brief       唤醒后台任务立即写入，并等待挂起表清空
+ * @param       timeout_ms: 最长等待时间
+ * @retval      ESP_OK: 已全部落盘, ESP_ERR_TIMEOUT: 超时
+ */
+esp_err_t persist_flush(uint32_t timeout_ms)
+{
+    if (s_task == NULL) {
+        return ESP_OK;
+    }
+
+    s_flush_now = true;
+    xTaskNotifyGive(s_task);
+
+    int64_t deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (1) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool idle = persist_pending_count() == 0 && s_inflight_count == 0;
+        xSemaphoreGive(s_lock);
+
+        if (idle) {
+            return ESP_OK;
+        }
+        if (esp_timer_get_time() >= deadline) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+/**
+ * @brief       获取写入统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void persist_get_stats(persist_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    if (s_lock) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        *stats = s_stats;
+        xSemaphoreGive(s_lock);
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+/**
+ * @brief       创建后台写入任务（需在nvs_flash_init之后调用）
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t persist_init(void)
+{
+    if (s_task) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create persist lock");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreatePinnedToCore(persist_task, "persist", PERSIST_TASK_STACK, NULL, PERSIST_TASK_PRIO,
+                                &s_task, PERSIST_TASK_CORE) != pdPASS) {
+        s_task = NULL;
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        ESP_LOGE(TAG, "Failed to create persist task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Persist store started (coalesce window %d ms)", PERSIST_COALESCE_MS);
+    return ESP_OK;
+}
@@ -0,0 +1,101 @@
+#ifndef __PERSIST_STORE_H__
+#define __PERSIST_STORE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERSIST_MAX_ENTRIES         8       /* 同时挂起的键值数上限，同名键覆盖不占新槽 */
+#define PERSIST_MAX_BLOB            64      /* 单个值的最大字节数 */
+#define PERSIST_NAME_LEN            16      /* 命名空间/键名最大长度（含结束符，NVS限制15字符） */
+#define PERSIST_COALESCE_MS         200     /* 收到首个写请求后等待合并的时间 */
+#define PERSIST_TASK_PRIO           2
+#define PERSIST_TASK_CORE           0
+#define PERSIST_TASK_STACK          (4 * 1024)
+
+/**
+ * @brief       写入统计
+ */
+typedef struct {
+    uint32_t requests;          /*!< 写/擦请求数 */
+    uint32_t coalesced;         /*!< 被后续同名写覆盖、未单独落盘的请求数 */
+    uint32_t writes;            /*!< 实际写入NVS的键数 */
+    uint32_t commits;           /*!< nvs_commit次数 */
+    uint32_t failures;          /*!< 写入或提交失败次数 */
+    uint32_t last_commit_us;    /*!< 最近一批写入+提交耗时 */
+} persist_stats_t;
+
+/**
+ * @brief       创建后台写入任务（需在nvs_flash_init之后调用）
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t persist_init(void);
+
+/**
+ * @brief       挂起一个二进制值，由后台任务合并后写入并提交，调用方不等待Flash
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       data: 数据
+ * @param       len: 字节数，不超过PERSIST_MAX_BLOB
+ * @retval      ESP_OK: 已挂起, ESP_ERR_INVALID_ARG: 参数无效, ESP_ERR_NO_MEM: 挂起表已满
+ */
+esp_err_t persist_set_blob(const char *ns, const char *key, const void *data, size_t len);
+
+/**
+ * @brief       挂起一个u32值
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       value: 值
+ * @retval      同persist_set_blob
+ */
+esp_err_t persist_set_u32(const char *ns, const char *key, uint32_t value);
+
+/**
+ * @brief       挂起擦除整个命名空间（同时丢弃该命名空间此前挂起的写请求）
+ * @param       ns: 命名空间
+ * @retval      同persist_set_blob
+ */
+esp_err_t persist_erase_namespace(const char *ns);
+
+/**
+ * @brief       读取二进制值，优先返回尚未落盘的挂起值
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       data: 输出缓冲
+ * @param       len: 输入缓冲大小，输出实际长度
+ * @retval      ESP_OK: 成功, ESP_ERR_NVS_NOT_FOUND: 不存在, 其他: NVS错误
+ */
+esp_err_t persist_get_blob(const char *ns, const char *key, void *data, size_t *len);
+
+/**
+ * @brief       读取u32值，优先返回尚未落盘的挂起值
+ * @param       ns: 命名空间
+ * @param       key: 键名
+ * @param       value: 输出值
+ * @retval      ESP_OK: 成功, ESP_ERR_NVS_NOT_FOUND: 不存在, 其他: NVS错误
+ */
+esp_err_t persist_get_u32(const char *ns, const char *key, uint32_t *value);
+
+/**
+ * @brief       唤醒后台任务立即写入，并等待挂起表清空（如重启前调用）
+ * @param       timeout_ms: 最长等待时间
+ * @retval      ESP_OK: 已全部落盘, ESP_ERR_TIMEOUT: 超时
+ */
+esp_err_t persist_flush(uint32_t timeout_ms);
+
+/**
+ * @brief       获取写入统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void persist_get_stats(persist_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERSIST_STORE_H__ */
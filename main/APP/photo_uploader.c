@@ -8,12 +8,43 @@
 #include "lwip/err.h"
 #include "lwip/sys.h"
 #include "esp_camera.h"
+#include "jpeg_strip.h"
 #include "camera.h"
+#include "system_state_manager.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include <string.h>
+#include <strings.h>
 #include <inttypes.h>
 
+#define PHOTO_CAPTURE_ATTEMPTS  3   /* 取帧失败时的尝试次数，每次由驱动等待下一帧 */
+
 static const char *TAG = "PhotoUploader";
 
+/**
+ * @brief 上传队列中的一项
+ */
+typedef struct {
+    segmented_photo_t *photo;
+    int64_t submit_us;
+} photo_upload_job_t;
+
+/* 后台上传任务 */
+static QueueHandle_t s_upload_queue = NULL;
+static TaskHandle_t s_upload_task = NULL;
+static uint32_t s_upload_pending = 0;
+static photo_upload_stats_t s_upload_stats = {0};
+
+/* 上传会话：各次上传共用一个HTTP客户端，连接在请求之间保持，失效时在下次上传时重连 */
+static struct {
+    esp_http_client_handle_t client;
+    SemaphoreHandle_t lock;         /* 串行化会话上的请求 */
+    bool connected;                 /* 上一请求结束后连接仍保持 */
+    bool new_connection;            /* 本次打开时建立了新连接（由HTTP_EVENT_ON_CONNECTED置位） */
+    bool server_close;              /* 服务器响应要求关闭连接 */
+    upload_session_stats_t stats;
+} s_session = {0};
+
 /* WiFi连接状态 */
 static bool wifi_connected = false;
 static EventGroupHandle_t wifi_event_group;
@@ -143,6 +174,7 @@ esp_err_t http_event_handler(esp_http_client_event_t *evt)
         case HTTP_EVENT_ON_CONNECTED:
             connection_start_time = esp_timer_get_time();
             data_sent = 0;
+            s_session.new_connection = true;
             ESP_LOGI(TAG, "✅ HTTP_EVENT_ON_CONNECTED - connection established");
             break;
         case HTTP_EVENT_HEADER_SENT:
@@ -150,6 +182,9 @@ esp_err_t http_event_handler(esp_http_client_event_t *evt)
             break;
         case HTTP_EVENT_ON_HEADER:
             ESP_LOGI(TAG, "📥 HTTP_EVENT_ON_HEADER, key=%s, value=%s", evt->header_key, evt->header_value);
+            if (strcasecmp(evt->header_key, "Connection") == 0 && strcasecmp(evt->header_value, "close") == 0) {
+                s_session.server_close = true;
+            }
             break;
         case HTTP_EVENT_ON_DATA:
             data_sent += evt->data_len;
@@ -176,7 +211,8 @@ esp_err_t http_event_handler(esp_http_client_event_t *evt)
 }
 
 /**
- * @brief 安全拍照（在摄像头任务暂停后）
+ * @brief 安全拍照（在各任务确认释放摄像头之后调用）
+ * @note 调用时流水线已交还全部帧，驱动中排队的帧即为最新帧，不再做固定延时
  */
 camera_fb_t* capture_photo_safe(void)
 {
@@ -191,30 +227,12 @@ camera_fb_t* capture_photo_safe(void)
         return NULL;
     }
     
-    // 确保摄像头任务已经暂停，等待足够时间让缓冲区稳定
-    vTaskDelay(pdMS_TO_TICKS(200));
-    
-    // 清理可能的残留缓冲区
-    camera_fb_t *temp_fb = esp_camera_fb_get();
-    if (temp_fb) {
-        esp_camera_fb_return(temp_fb);
-        ESP_LOGI(TAG, "Cleared residual camera buffer");
-    }
-    
-    // 短暂延迟后获取新的干净帧
-    vTaskDelay(pdMS_TO_TICKS(100));
-    
-    // 获取摄像头帧，重试机制
-    camera_fb_t *fb = esp_camera_fb_get();
-    if (!fb) {
-        ESP_LOGW(TAG, "Failed to capture photo on first attempt, retrying...");
-        vTaskDelay(pdMS_TO_TICKS(200));
+    // 获取摄像头帧，esp_camera_fb_get本身会等待下一帧，失败时直接重试
+    camera_fb_t *fb = NULL;
+    for (int attempt = 1; attempt <= PHOTO_CAPTURE_ATTEMPTS && !fb; attempt++) {
         fb = esp_camera_fb_get();
-        
         if (!fb) {
-            ESP_LOGW(TAG, "Failed to capture photo on second attempt, final retry...");
-            vTaskDelay(pdMS_TO_TICKS(300));
-            fb = esp_camera_fb_get();
+            ESP_LOGW(TAG, "Failed to capture photo on attempt %d/%d", attempt, PHOTO_CAPTURE_ATTEMPTS);
         }
     }
     
@@ -307,6 +325,9 @@ segmented_photo_t* create_segmented_photo(camera_fb_t *original_fb)
     seg_photo->format = original_fb->format;
     seg_photo->width = original_fb->width;
     seg_photo->height = original_fb->height;
+    seg_photo->timestamp = original_fb->timestamp;
+    seg_photo->release_source = NULL;
+    seg_photo->source = NULL;
     
     // 分段复制数据
     size_t offset = 0;
@@ -348,18 +369,135 @@ segmented_photo_t* create_segmented_photo(camera_fb_t *original_fb)
     return seg_photo;
 }
 
+/**
+ * @brief 以借用的缓冲构造照片（不复制）
+ */
+segmented_photo_t* create_borrowed_photo(const camera_fb_t *fb, void (*release_source)(void *source), void *source)
+{
+    if (!fb || !fb->buf || fb->len == 0 || !release_source) {
+        ESP_LOGE(TAG, "Invalid borrowed frame buffer");
+        return NULL;
+    }
+
+    segmented_photo_t *seg_photo = malloc(sizeof(segmented_photo_t));
+    if (!seg_photo) {
+        ESP_LOGE(TAG, "Failed to allocate segmented photo structure");
+        return NULL;
+    }
+
+    // 唯一的分段直接指向借用的缓冲，上传时按16KB小块从原处发送
+    seg_photo->segments = malloc(sizeof(uint8_t*));
+    seg_photo->segment_sizes = malloc(sizeof(size_t));
+    if (!seg_photo->segments || !seg_photo->segment_sizes) {
+        ESP_LOGE(TAG, "Failed to allocate segment arrays");
+        if (seg_photo->segments) free(seg_photo->segments);
+        if (seg_photo->segment_sizes) free(seg_photo->segment_sizes);
+        free(seg_photo);
+        return NULL;
+    }
+
+    seg_photo->segments[0] = fb->buf;
+    seg_photo->segment_sizes[0] = fb->len;
+    seg_photo->segment_count = 1;
+    seg_photo->total_size = fb->len;
+    seg_photo->format = fb->format;
+    seg_photo->width = fb->width;
+    seg_photo->height = fb->height;
+    seg_photo->timestamp = fb->timestamp;
+    seg_photo->release_source = release_source;
+    seg_photo->source = source;
+
+    ESP_LOGI(TAG, "✅ Borrowed %zu bytes for zero-copy upload", fb->len);
+    return seg_photo;
+}
+
+/**
+ * @brief 释放照片独占的整块缓冲（JPEG编码结果或整帧副本）
+ * @param source 缓冲
+ */
+static void photo_free_buffer(void *source)
+{
+    free(source);
+}
+
+/**
+ * @brief 把一帧复制到一整块PSRAM中，供上传任务在上传前编码（编码需要连续的源数据）
+ * @param fb 源帧
+ * @retval 成功时返回照片指针，PSRAM不足时返回NULL
+ */
+static segmented_photo_t* create_contiguous_photo(const camera_fb_t *fb)
+{
+    uint8_t *buf = heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        ESP_LOGW(TAG, "No contiguous PSRAM block for %zu bytes", fb->len);
+        return NULL;
+    }
+    memcpy(buf, fb->buf, fb->len);
+
+    camera_fb_t copy_fb = *fb;
+    copy_fb.buf = buf;
+    segmented_photo_t *seg_photo = create_borrowed_photo(&copy_fb, photo_free_buffer, buf);
+    if (!seg_photo) {
+        free(buf);
+    }
+    return seg_photo;
+}
+
+/**
+ * @brief 把RGB565帧编码为JPEG照片
+ */
+segmented_photo_t* create_jpeg_photo(const camera_fb_t *fb, uint8_t quality)
+{
+    if (!fb || !fb->buf || fb->format != PIXFORMAT_RGB565) {
+        return NULL;
+    }
+
+    // 按MCU行分条在两个核上编码（RGB565按摄像头字节序读取），输出缓冲优先分配在PSRAM
+    uint8_t *jpg_buf = NULL;
+    size_t jpg_len = 0;
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = jpeg_strip_encode(fb->buf, fb->len, fb->width, fb->height, quality, &jpg_buf, &jpg_len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "JPEG encoding failed (%zux%zu): %s", fb->width, fb->height, esp_err_to_name(err));
+        return NULL;
+    }
+
+    camera_fb_t jpg_fb = {
+        .buf = jpg_buf,
+        .len = jpg_len,
+        .width = fb->width,
+        .height = fb->height,
+        .format = PIXFORMAT_JPEG,
+        .timestamp = fb->timestamp,
+    };
+    segmented_photo_t *seg_photo = create_borrowed_photo(&jpg_fb, photo_free_buffer, jpg_buf);
+    if (!seg_photo) {
+        free(jpg_buf);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "✅ Encoded %zux%zu RGB565 to JPEG (q%u): %zu -> %zu bytes in %" PRId64 " ms",
+             fb->width, fb->height, quality, fb->len, jpg_len, (esp_timer_get_time() - start_us) / 1000);
+    return seg_photo;
+}
+
 /**
  * @brief 释放分段照片
  */
 void release_segmented_photo(segmented_photo_t *seg_photo)
 {
     if (seg_photo) {
-        if (seg_photo->segments) {
+        if (seg_photo->release_source) {
+            // 借用的缓冲交还给其所有者，分段数据不属于照片
+            seg_photo->release_source(seg_photo->source);
+        } else if (seg_photo->segments) {
             for (size_t i = 0; i < seg_photo->segment_count; i++) {
                 if (seg_photo->segments[i]) {
                     free(seg_photo->segments[i]);
                 }
             }
+        }
+        if (seg_photo->segments) {
             free(seg_photo->segments);
         }
         if (seg_photo->segment_sizes) {
@@ -377,11 +515,8 @@ segmented_photo_t* capture_photo_segmented(void)
 {
     ESP_LOGI(TAG, "📸 Capturing photo with segmented storage...");
     
-    // 首先测试PSRAM可用性
-    test_psram_availability();
-    
     // 获取原始摄像头帧
-    camera_fb_t *original_fb = esp_camera_fb_get();
+    camera_fb_t *original_fb = capture_photo_safe();
     if (!original_fb) {
         ESP_LOGE(TAG, "Failed to get camera frame");
         return NULL;
@@ -396,8 +531,16 @@ segmented_photo_t* capture_photo_segmented(void)
         return NULL;
     }
     
-    // 创建分段照片
-    segmented_photo_t *seg_photo = create_segmented_photo(original_fb);
+    // 摄像头帧缓冲只有fb_count个，不借给上传，复制后立即归还，不让流水线缺帧
+    segmented_photo_t *seg_photo = NULL;
+
+    // 需要编码的帧整块复制，由上传任务在恢复检测之后编码，拍照路径上不做编码
+    if (PHOTO_JPEG_QUALITY > 0 && original_fb->format == PIXFORMAT_RGB565) {
+        seg_photo = create_contiguous_photo(original_fb);
+    }
+    if (!seg_photo) {
+        seg_photo = create_segmented_photo(original_fb);
+    }
     
     // 立即释放原始帧
     esp_camera_fb_return(original_fb);
@@ -427,197 +570,225 @@ void release_copied_photo(camera_fb_t *copy_fb)
 }
 
 /**
- * @brief 测试网络连接性能
+ * @brief 按图像格式选择Content-Type
  */
-static void test_network_performance(void)
+static const char *upload_content_type(pixformat_t format)
 {
-    ESP_LOGI(TAG, "=== Network Performance Test ===");
-    
-    // 简单的连接测试
-    esp_http_client_config_t test_config = {
-        .url = SERVER_URL,
-        .method = HTTP_METHOD_HEAD,
-        .timeout_ms = 5000,
-    };
-    
-    esp_http_client_handle_t test_client = esp_http_client_init(&test_config);
-    if (test_client) {
-        int64_t start_time = esp_timer_get_time();
-        esp_err_t err = esp_http_client_perform(test_client);
-        int64_t end_time = esp_timer_get_time();
-        
-        if (err == ESP_OK) {
-            int status_code = esp_http_client_get_status_code(test_client);
-            int64_t latency = (end_time - start_time) / 1000;
-            ESP_LOGI(TAG, "✅ Server connectivity test: %d status, %lld ms latency", status_code, latency);
-            printf("🌐 Network latency to server: %lld ms\r\n", latency);
-        } else {
-            ESP_LOGW(TAG, "❌ Server connectivity test failed: %s", esp_err_to_name(err));
-        }
-        
-        esp_http_client_cleanup(test_client);
+    if (format == PIXFORMAT_JPEG) {
+        ESP_LOGI(TAG, "Uploading JPEG format photo");
+        return "image/jpeg";
     }
-    
-    ESP_LOGI(TAG, "=== End Network Test ===");
+
+    ESP_LOGW(TAG, "Unknown format %d, uploading as binary", format);
+    return "application/octet-stream";
 }
 
 /**
- * @brief 上传分段照片到服务器
+ * @brief 在会话上完成一次POST：打开（必要时建立连接）、发送各数据块、读完响应
+ * @param parts/part_sizes/part_count: 数据块
+ * @param total: 总字节数
+ * @param format/width/height: 图像信息
+ * @param reused: 输出，本次请求开始时会话是否持有已建立的连接
+ * @retval ESP_OK: 收到HTTP响应, ESP_FAIL: 失败（连接已关闭）
  */
-esp_err_t upload_segmented_photo(segmented_photo_t *seg_photo)
+static esp_err_t upload_session_attempt(const uint8_t *const *parts, const size_t *part_sizes, size_t part_count,
+                                        size_t total, pixformat_t format, size_t width, size_t height, bool *reused)
 {
-    if (!seg_photo) {
-        ESP_LOGE(TAG, "Cannot upload NULL segmented photo");
-        return ESP_FAIL;
-    }
-    
-    // 检查WiFi连接状态
-    if (!wifi_connected) {
-        ESP_LOGW(TAG, "WiFi not connected, cannot upload photo");
-        return ESP_FAIL;
-    }
-    
-    // 测试网络性能
-    test_network_performance();
-    
-    const char *content_type;
-    if (seg_photo->format == PIXFORMAT_JPEG) {
-        content_type = "image/jpeg";
-        ESP_LOGI(TAG, "Uploading JPEG format photo");
-    } else {
-        ESP_LOGW(TAG, "Unknown format %d, uploading as binary", seg_photo->format);
-        content_type = "application/octet-stream";
-    }
+    *reused = s_session.connected;
 
-    // 配置HTTP客户端 - upload_segmented_photo函数
-    esp_http_client_config_t config = {
-        .url = SERVER_URL,
-        .event_handler = http_event_handler,
-        .method = HTTP_METHOD_POST,
-        .timeout_ms = 60000,  // 增加到60秒超时，但添加更多调试信息
-        .buffer_size = 16384,   // 激进增加缓冲区到16KB最大化传输效率
-        .buffer_size_tx = 16384,
-        .keep_alive_enable = true,   // 启用Keep-Alive提高连接效率
-        .disable_auto_redirect = true,
-        .is_async = false,  // 确保同步模式
-    };
+    if (!s_session.client) {
+        esp_http_client_config_t config = {
+            .url = SERVER_URL,
+            .event_handler = http_event_handler,
+            .method = HTTP_METHOD_POST,
+            .timeout_ms = 60000,
+            .buffer_size = 16384,
+            .buffer_size_tx = 16384,
+            .keep_alive_enable = true,   // TCP保活，配合HTTP长连接
+            .disable_auto_redirect = true,
+            .is_async = false,
+        };
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
-        return ESP_FAIL;
+        s_session.client = esp_http_client_init(&config);
+        if (!s_session.client) {
+            ESP_LOGE(TAG, "Failed to initialize HTTP client");
+            return ESP_FAIL;
+        }
+        s_session.connected = false;
+        *reused = false;
     }
 
-    esp_err_t err = ESP_OK;
-    
-    // 设置HTTP头
-    esp_http_client_set_header(client, "Content-Type", content_type);
-    
-    char content_length_str[32];
-    snprintf(content_length_str, sizeof(content_length_str), "%zu", seg_photo->total_size);
-    esp_http_client_set_header(client, "Content-Length", content_length_str);
-    
-    // 发送POST请求
-    err = esp_http_client_open(client, seg_photo->total_size);
+    esp_http_client_handle_t client = s_session.client;
+
+    // 设置HTTP头（原始RGB565数据可能是缩小后的预录帧，附带尺寸供服务器解码）
+    esp_http_client_set_header(client, "Content-Type", upload_content_type(format));
+
+    char dim_str[16];
+    snprintf(dim_str, sizeof(dim_str), "%zu", width);
+    esp_http_client_set_header(client, "X-Image-Width", dim_str);
+    snprintf(dim_str, sizeof(dim_str), "%zu", height);
+    esp_http_client_set_header(client, "X-Image-Height", dim_str);
+
+    // 已有连接时直接发送请求行，否则在此建立TCP连接（Content-Length由open设置）
+    s_session.new_connection = false;
+    s_session.server_close = false;
+    int64_t open_start = esp_timer_get_time();
+    esp_err_t err = esp_http_client_open(client, total);
+    uint32_t open_us = (uint32_t)(esp_timer_get_time() - open_start);
+
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
-        goto cleanup;
+        goto fail;
     }
 
-    ESP_LOGI(TAG, "Starting photo upload - total size: %zu bytes", seg_photo->total_size);
-    
-    // 记录开始时间
-    int64_t upload_start_time = esp_timer_get_time();
-    
+    s_session.stats.last_open_us = open_us;
+    s_session.stats.last_reused = !s_session.new_connection;
+    if (s_session.new_connection) {
+        s_session.stats.connects++;
+        s_session.stats.connect_us += open_us;
+    } else {
+        s_session.stats.reuses++;
+        s_session.stats.reuse_us += open_us;
+    }
+
+    ESP_LOGI(TAG, "Starting photo upload - total size: %zu bytes", total);
+
     // 逐块发送数据
+    int64_t upload_start_time = esp_timer_get_time();
     size_t total_written = 0;
-    
-    for (size_t i = 0; i < seg_photo->segment_count; i++) {
-        // 验证当前块
-        if (!seg_photo->segments[i] || seg_photo->segment_sizes[i] == 0) {
+    const size_t mini_chunk_size = 16384;
+
+    for (size_t i = 0; i < part_count; i++) {
+        if (!parts[i] || part_sizes[i] == 0) {
             ESP_LOGE(TAG, "Invalid segment %zu", i);
-            err = ESP_FAIL;
-            goto cleanup;
+            goto fail;
         }
-        
-        ESP_LOGD(TAG, "Uploading segment %zu/%zu (%zu bytes)", 
-                 i + 1, seg_photo->segment_count, seg_photo->segment_sizes[i]);
-        
-        // 分小块发送每个段 - 进一步增加块大小提高效率
+
         size_t chunk_written = 0;
-        const size_t mini_chunk_size = 16384;  // 增加到16KB提高上传效率
-        
-        while (chunk_written < seg_photo->segment_sizes[i]) {
-            size_t write_len = (seg_photo->segment_sizes[i] - chunk_written) > mini_chunk_size ? 
-                              mini_chunk_size : (seg_photo->segment_sizes[i] - chunk_written);
-            
-            int wlen = esp_http_client_write(client, 
-                                            (const char*)(seg_photo->segments[i] + chunk_written), 
-                                            write_len);
+        while (chunk_written < part_sizes[i]) {
+            size_t write_len = (part_sizes[i] - chunk_written) > mini_chunk_size ?
+                               mini_chunk_size : (part_sizes[i] - chunk_written);
+
+            int wlen = esp_http_client_write(client, (const char *)(parts[i] + chunk_written), write_len);
             if (wlen < 0) {
                 ESP_LOGE(TAG, "Failed to write segment %zu data at offset %zu", i, chunk_written);
-                err = ESP_FAIL;
-                goto cleanup;
+                goto fail;
             }
-            
+
             chunk_written += wlen;
             total_written += wlen;
-            
-            // 移除不必要的延时以提高上传速度
         }
-        
-        ESP_LOGI(TAG, "Chunk %zu uploaded, total: %zu/%zu bytes", 
-                 i + 1, total_written, seg_photo->total_size);
-        
-        // 移除块间延时以提高上传速度
     }
-    
-    ESP_LOGI(TAG, "All chunks sent, total: %zu bytes", total_written);
-    
+
     // 计算上传速度
     int64_t upload_time = (esp_timer_get_time() - upload_start_time) / 1000; // 转换为毫秒
     if (upload_time > 0) {
         double speed_kbps = (double)(total_written * 8) / upload_time; // kbps
-        ESP_LOGI(TAG, "📊 Upload performance: %lld ms, %.2f kbps", upload_time, speed_kbps);
-        printf("📊 Upload speed: %.2f kbps (%lld ms for %zu bytes)\r\n", speed_kbps, upload_time, total_written);
+        ESP_LOGI(TAG, "📊 Upload performance: %" PRId64 " ms, %.2f kbps", upload_time, speed_kbps);
+        printf("📊 Upload speed: %.2f kbps (%" PRId64 " ms for %zu bytes)\r\n", speed_kbps, upload_time, total_written);
     }
 
-    // 获取响应
-    int content_length = esp_http_client_fetch_headers(client);
+    // 获取响应，并读完响应体，下一次请求才能复用连接
+    int content_length = (int)esp_http_client_fetch_headers(client);
     int status_code = esp_http_client_get_status_code(client);
-    
+    esp_http_client_flush_response(client, NULL);
+
     ESP_LOGI(TAG, "HTTP Status: %d, Content-Length: %d", status_code, content_length);
 
+    if (status_code <= 0) {
+        ESP_LOGE(TAG, "Photo upload failed - no valid HTTP response");
+        printf("❌ Photo upload failed - no HTTP response\r\n");
+        goto fail;
+    }
+
     if (status_code >= 200 && status_code < 300) {
-        ESP_LOGI(TAG, "✅ Segmented photo uploaded successfully! Status: %d", status_code);
+        ESP_LOGI(TAG, "✅ Photo uploaded successfully! Status: %d", status_code);
         printf("📸 Server confirmed photo upload successful (Status: %d)\r\n", status_code);
-        err = ESP_OK;
-    } else if (status_code > 0) {
+    } else {
         ESP_LOGW(TAG, "Photo upload completed with status: %d", status_code);
         printf("⚠️  Photo upload completed with status: %d\r\n", status_code);
-        err = ESP_OK;
+    }
+
+    // 服务器要求关闭（如HTTP/1.0）时关闭，下次上传再连接
+    if (s_session.server_close) {
+        esp_http_client_close(client);
+        s_session.connected = false;
     } else {
-        ESP_LOGE(TAG, "Photo upload failed - no valid HTTP response");
-        printf("❌ Photo upload failed - no HTTP response\r\n");
-        err = ESP_FAIL;
+        s_session.connected = true;
+    }
+    return ESP_OK;
+
+fail:
+    esp_http_client_close(client);
+    s_session.connected = false;
+    return ESP_FAIL;
+}
+
+/**
+ * @brief 通过长连接会话上传一组数据块，复用的连接失效时重连并重试一次
+ * @param parts/part_sizes/part_count: 数据块
+ * @param total: 总字节数
+ * @param format/width/height: 图像信息
+ * @retval ESP_OK: 收到HTTP响应, ESP_ERR_INVALID_STATE: 未初始化, ESP_FAIL: 失败
+ */
+static esp_err_t upload_session_post(const uint8_t *const *parts, const size_t *part_sizes, size_t part_count,
+                                     size_t total, pixformat_t format, size_t width, size_t height)
+{
+    if (!s_session.lock) {
+        ESP_LOGE(TAG, "Upload session not initialized");
+        return ESP_ERR_INVALID_STATE;
     }
 
-cleanup:
-    if (client) {
-        ESP_LOGI(TAG, "Cleaning up HTTP client");
-        esp_http_client_cleanup(client);
+    xSemaphoreTake(s_session.lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_FAIL;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = false;
+
+        s_session.stats.requests++;
+        err = upload_session_attempt(parts, part_sizes, part_count, total, format, width, height, &reused);
+        if (err == ESP_OK || !reused) {
+            break;
+        }
+
+        // 空闲期间服务器可能已关闭长连接，数据仍在内存中，重新连接后整体重发
+        s_session.stats.retries++;
+        ESP_LOGW(TAG, "Kept-alive connection failed, reconnecting and retrying");
     }
-    
+
+    upload_session_stats_t st = s_session.stats;
+    xSemaphoreGive(s_session.lock);
+
+    ESP_LOGI(TAG, "🔌 Connection %s, open %" PRIu32 " us; avg new %" PRIu32 " us (%" PRIu32 "), avg reused %" PRIu32
+             " us (%" PRIu32 "), %" PRIu32 " retries",
+             st.last_reused ? "reused" : "new", st.last_open_us,
+             st.connects ? (uint32_t)(st.connect_us / st.connects) : 0, st.connects,
+             st.reuses ? (uint32_t)(st.reuse_us / st.reuses) : 0, st.reuses, st.retries);
+
     return err;
 }
 
 /**
- * @brief 上传预先拍好的照片到服务器（保留原函数用于兼容性）
+ * @brief 获取上传会话统计
  */
-esp_err_t upload_photo(camera_fb_t *fb)
+void upload_session_get_stats(upload_session_stats_t *stats)
 {
-    if (!fb) {
-        ESP_LOGE(TAG, "Cannot upload NULL photo");
+    if (s_session.lock) {
+        xSemaphoreTake(s_session.lock, portMAX_DELAY);
+    }
+    *stats = s_session.stats;
+    if (s_session.lock) {
+        xSemaphoreGive(s_session.lock);
+    }
+}
+
+/**
+ * @brief 上传分段照片到服务器
+ */
+esp_err_t upload_segmented_photo(segmented_photo_t *seg_photo)
+{
+    if (!seg_photo) {
+        ESP_LOGE(TAG, "Cannot upload NULL segmented photo");
         return ESP_FAIL;
     }
     
@@ -626,101 +797,33 @@ esp_err_t upload_photo(camera_fb_t *fb)
         ESP_LOGW(TAG, "WiFi not connected, cannot upload photo");
         return ESP_FAIL;
     }
-    
-    ESP_LOGI(TAG, "Uploading photo: %zu bytes", fb->len);
-    
-    // 根据格式设置Content-Type
-    const char* content_type;
-    if (fb->format == PIXFORMAT_JPEG) {
-        content_type = "image/jpeg";
-        ESP_LOGI(TAG, "Uploading JPEG format photo");
-    } else {
-        ESP_LOGW(TAG, "Unknown format %d, uploading as binary", fb->format);
-        content_type = "application/octet-stream";
-    }
 
-    // 配置HTTP客户端 - upload_photo函数
-    esp_http_client_config_t config = {
-        .url = SERVER_URL,
-        .event_handler = http_event_handler,
-        .method = HTTP_METHOD_POST,
-        .timeout_ms = 30000,  // 30秒超时，适应大照片上传
-        .buffer_size = 8192,   // 进一步增加缓冲区到8KB提高传输效率
-        .buffer_size_tx = 8192,
-        .keep_alive_enable = true,   // 启用Keep-Alive提高连接效率
-        .disable_auto_redirect = true,
-    };
+    return upload_session_post((const uint8_t *const *)seg_photo->segments, seg_photo->segment_sizes,
+                               seg_photo->segment_count, seg_photo->total_size,
+                               seg_photo->format, seg_photo->width, seg_photo->height);
+}
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+/**
+ * @brief 上传预先拍好的照片到服务器（保留原函数用于兼容性）
+ */
+esp_err_t upload_photo(camera_fb_t *fb)
+{
+    if (!fb) {
+        ESP_LOGE(TAG, "Cannot upload NULL photo");
         return ESP_FAIL;
     }
-
-    esp_err_t err = ESP_OK;
-    
-    // 设置HTTP头
-    esp_http_client_set_header(client, "Content-Type", content_type);
-    
-    char content_length_str[32];
-    snprintf(content_length_str, sizeof(content_length_str), "%zu", fb->len);
-    esp_http_client_set_header(client, "Content-Length", content_length_str);
-    
-    // 发送POST请求
-    err = esp_http_client_open(client, fb->len);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
-        goto cleanup;
-    }
-
-    // 分块发送图片数据 - 进一步增加块大小提高效率
-    size_t total_written = 0;
-    const size_t chunk_size = 16384;  // 增加到16KB提高上传效率
     
-    while (total_written < fb->len) {
-        size_t write_len = (fb->len - total_written) > chunk_size ? 
-                          chunk_size : (fb->len - total_written);
-        
-        int wlen = esp_http_client_write(client, 
-                                        (const char*)(fb->buf + total_written), 
-                                        write_len);
-        if (wlen < 0) {
-            ESP_LOGE(TAG, "Failed to write HTTP data at offset %zu", total_written);
-            err = ESP_FAIL;
-            goto cleanup;
-        }
-        
-        total_written += wlen;
-        
-        // 移除不必要的延时以提高上传速度
+    // 检查WiFi连接状态
+    if (!wifi_connected) {
+        ESP_LOGW(TAG, "WiFi not connected, cannot upload photo");
+        return ESP_FAIL;
     }
     
-    ESP_LOGI(TAG, "Sent %zu bytes to server", total_written);
-
-    // 获取响应
-    int content_length = esp_http_client_fetch_headers(client);
-    int status_code = esp_http_client_get_status_code(client);
-    
-    ESP_LOGI(TAG, "HTTP Status: %d, Content-Length: %d", status_code, content_length);
-
-    if (status_code >= 200 && status_code < 300) {
-        ESP_LOGI(TAG, "✅ Photo uploaded successfully! Status: %d", status_code);
-        err = ESP_OK;
-    } else if (status_code > 0) {
-        ESP_LOGW(TAG, "Photo upload completed with status: %d", status_code);
-        err = ESP_OK;
-    } else {
-        ESP_LOGE(TAG, "Photo upload failed - no valid HTTP response");
-        err = ESP_FAIL;
-    }
+    ESP_LOGI(TAG, "Uploading photo: %zu bytes", fb->len);
 
-cleanup:
-    if (client) {
-        ESP_LOGI(TAG, "Cleaning up HTTP client");
-        esp_http_client_cleanup(client);
-    }
-    
-    return err;
+    const uint8_t *part = fb->buf;
+    size_t part_size = fb->len;
+    return upload_session_post(&part, &part_size, 1, fb->len, fb->format, fb->width, fb->height);
 }
 
 /**
@@ -745,6 +848,132 @@ esp_err_t capture_and_upload_photo(void)
     return ESP_OK;
 }
 
+/**
+ * @brief 上传前把连续存放的RGB565照片（预录帧或拍照时的整帧副本）编码为JPEG，并立即归还原缓冲
+ * @param photo 照片
+ * @retval 编码后的照片；无需编码或编码失败时原样返回（失败时上传原始数据）
+ */
+static segmented_photo_t *photo_upload_encode(segmented_photo_t *photo)
+{
+    if (PHOTO_JPEG_QUALITY == 0 || photo->format != PIXFORMAT_RGB565 || photo->segment_count != 1) {
+        return photo;
+    }
+
+    camera_fb_t fb = {
+        .buf = photo->segments[0],
+        .len = photo->segment_sizes[0],
+        .width = photo->width,
+        .height = photo->height,
+        .format = photo->format,
+        .timestamp = photo->timestamp,
+    };
+
+    int64_t start_us = esp_timer_get_time();
+    segmented_photo_t *jpeg = create_jpeg_photo(&fb, PHOTO_JPEG_QUALITY);
+    if (!jpeg) {
+        ESP_LOGW(TAG, "JPEG encoding failed, uploading raw RGB565");
+        return photo;
+    }
+
+    s_upload_stats.encoded++;
+    s_upload_stats.last_encode_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    release_segmented_photo(photo);
+
+    jpeg_strip_stats_t strip;
+    jpeg_strip_get_stats(&strip);
+    ESP_LOGI(TAG, "JPEG strips: %" PRIu32 " parallel / %" PRIu32 " whole-frame encodes, %" PRIu32 " of %" PRIu32
+             " strips on worker core", strip.parallel, strip.fallback, strip.worker_strips, strip.strips);
+    return jpeg;
+}
+
+/**
+ * @brief 后台上传任务：逐张上传队列中的照片并释放
+ */
+static void photo_upload_task(void *arg)
+{
+    (void)arg;
+    photo_upload_job_t job;
+
+    while (1) {
+        xQueueReceive(s_upload_queue, &job, portMAX_DELAY);
+
+        int64_t start_us = esp_timer_get_time();
+        uint32_t queue_ms = (uint32_t)((start_us - job.submit_us) / 1000);
+        if (queue_ms > s_upload_stats.max_queue_ms) {
+            s_upload_stats.max_queue_ms = queue_ms;
+        }
+
+        job.photo = photo_upload_encode(job.photo);
+
+        ESP_LOGI(TAG, "📤 Uploading queued photo (%zu bytes, waited %" PRIu32 " ms)", job.photo->total_size, queue_ms);
+        esp_err_t ret = upload_segmented_photo(job.photo);
+        release_segmented_photo(job.photo);
+
+        s_upload_stats.last_upload_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+        if (ret == ESP_OK) {
+            s_upload_stats.uploaded++;
+        } else {
+            s_upload_stats.failed++;
+        }
+
+        __atomic_sub_fetch(&s_upload_pending, 1, __ATOMIC_ACQ_REL);
+        system_photo_upload_complete(ret);
+
+        ESP_LOGI(TAG, "Upload stats: %" PRIu32 " submitted, %" PRIu32 " uploaded, %" PRIu32 " failed, %" PRIu32
+                 " dropped, last %" PRIu32 " ms, max queue wait %" PRIu32 " ms, %" PRIu32 " encoded (last %" PRIu32 " ms)",
+                 s_upload_stats.submitted, s_upload_stats.uploaded, s_upload_stats.failed,
+                 s_upload_stats.dropped, s_upload_stats.last_upload_ms, s_upload_stats.max_queue_ms,
+                 s_upload_stats.encoded, s_upload_stats.last_encode_ms);
+    }
+}
+
+/**
+ * @brief 把照片交给后台上传任务（不阻塞）
+ */
+esp_err_t photo_upload_submit(segmented_photo_t *seg_photo)
+{
+    if (!seg_photo) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_upload_queue) {
+        __atomic_add_fetch(&s_upload_stats.dropped, 1, __ATOMIC_RELAXED);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    photo_upload_job_t job = {
+        .photo = seg_photo,
+        .submit_us = esp_timer_get_time(),
+    };
+
+    /* 先计数再入队，避免上传任务先完成导致计数下溢 */
+    __atomic_add_fetch(&s_upload_pending, 1, __ATOMIC_ACQ_REL);
+    if (xQueueSend(s_upload_queue, &job, 0) != pdTRUE) {
+        __atomic_sub_fetch(&s_upload_pending, 1, __ATOMIC_ACQ_REL);
+        __atomic_add_fetch(&s_upload_stats.dropped, 1, __ATOMIC_RELAXED);
+        return ESP_ERR_NO_MEM;
+    }
+
+    __atomic_add_fetch(&s_upload_stats.submitted, 1, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+/**
+ * @brief 已入队但尚未上传完成的照片数
+ */
+uint32_t photo_upload_pending(void)
+{
+    return __atomic_load_n(&s_upload_pending, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 获取后台上传统计
+ */
+void photo_upload_get_stats(photo_upload_stats_t *stats)
+{
+    *stats = s_upload_stats;
+}
+
 /**
  * @brief 初始化照片上传系统
  */
@@ -752,6 +981,36 @@ esp_err_t photo_uploader_init(void)
 {
     ESP_LOGI(TAG, "Initializing photo uploader system...");
     
+    // 上传会话锁须在上传任务运行前创建
+    if (!s_session.lock) {
+        s_session.lock = xSemaphoreCreateMutex();
+        if (!s_session.lock) {
+            ESP_LOGE(TAG, "Failed to create upload session lock");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    // 辅助编码任务失败时编码退化为单核，不影响上传
+    if (jpeg_strip_init(PHOTO_JPEG_QUALITY > 0 ? PHOTO_JPEG_QUALITY : 80) != ESP_OK) {
+        ESP_LOGW(TAG, "Strip JPEG worker not started, encoding on one core");
+    }
+    
+    // 先创建后台上传任务：WiFi稍后连上时照片仍可排队上传
+    if (!s_upload_task) {
+        s_upload_queue = xQueueCreate(PHOTO_UPLOAD_QUEUE_LEN, sizeof(photo_upload_job_t));
+        if (!s_upload_queue ||
+            xTaskCreatePinnedToCore(photo_upload_task, "photo_upload", PHOTO_UPLOAD_TASK_STACK, NULL,
+                                    PHOTO_UPLOAD_TASK_PRIO, &s_upload_task, PHOTO_UPLOAD_TASK_CORE) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create photo upload task");
+            if (s_upload_queue) {
+                vQueueDelete(s_upload_queue);
+                s_upload_queue = NULL;
+            }
+            s_upload_task = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
     // 初始化WiFi
     esp_err_t ret = wifi_init();
     if (ret != ESP_OK) {
@@ -759,6 +1018,9 @@ esp_err_t photo_uploader_init(void)
         return ret;
     }
 
+    // PSRAM可用性只需在启动时检查一次，不放在拍照路径上
+    test_psram_availability();
+
     ESP_LOGI(TAG, "Photo uploader system initialized successfully");
     return ESP_OK;
 }
@@ -16,6 +16,15 @@
 extern "C" {
 #endif
 
+/* 后台上传任务：照片入队后由该任务上传并释放，检测流水线不必等待网络 */
+#define PHOTO_UPLOAD_QUEUE_LEN      2           /* 排队照片上限，满时新照片被丢弃 */
+#define PHOTO_UPLOAD_TASK_PRIO      2           /* 低于检测流水线各级 */
+#define PHOTO_UPLOAD_TASK_CORE      0
+#define PHOTO_UPLOAD_TASK_STACK     (8 * 1024)  /* 需容纳HTTP客户端与JPEG编码 */
+
+/* 上传前把RGB565照片编码为JPEG（服务器只接受JPEG，体积也只有原始数据的几分之一） */
+#define PHOTO_JPEG_QUALITY          80          /* JPEG质量1-100，0表示不编码、上传原始数据 */
+
 /**
  * @brief WiFi配置 - 在wifi_config.h文件中修改
  */
@@ -34,7 +43,7 @@ esp_err_t wifi_init(void);
 bool wifi_is_connected(void);
 
 /**
- * @brief 安全拍照（在摄像头任务暂停后）
+ * @brief 安全拍照（在各任务确认释放摄像头之后调用，无固定延时）
  * @retval 成功时返回camera_fb_t指针，失败时返回NULL
  */
 camera_fb_t* capture_photo_safe(void);
@@ -57,8 +66,34 @@ typedef struct {
     size_t height;              /*!< 图像高度 */
     pixformat_t format;         /*!< 图像格式 */
     struct timeval timestamp;   /*!< 时间戳 */
+    void (*release_source)(void *source); /*!< 非NULL时唯一的分段直接指向借用的缓冲，释放照片时调用以归还 */
+    void *source;               /*!< 传给release_source的参数 */
 } segmented_photo_t;
 
+/**
+ * @brief 把一帧复制为分段照片（不归还原帧）
+ * @param original_fb 源帧，可以是摄像头帧或指向其他缓冲的描述
+ * @retval 成功时返回分段照片指针，失败时返回NULL
+ */
+segmented_photo_t* create_segmented_photo(camera_fb_t *original_fb);
+
+/**
+ * @brief 以借用的缓冲构造照片（不复制），上传后由release_segmented_photo调用release_source归还
+ * @param fb 描述借用数据的帧（只读取其字段，无需在调用后保持有效）
+ * @param release_source 归还函数，不可为NULL
+ * @param source 传给release_source的参数
+ * @retval 成功时返回照片指针，失败时返回NULL（缓冲未被接管，仍由调用者归还）
+ */
+segmented_photo_t* create_borrowed_photo(const camera_fb_t *fb, void (*release_source)(void *source), void *source);
+
+/**
+ * @brief 把RGB565帧编码为JPEG照片（不归还原帧），编码结果占用单独分配的缓冲
+ * @param fb 源帧，数据须连续
+ * @param quality JPEG质量1-100
+ * @retval 成功时返回照片指针，格式不支持或内存不足时返回NULL
+ */
+segmented_photo_t* create_jpeg_photo(const camera_fb_t *fb, uint8_t quality);
+
 /**
  * @brief 安全的分段拍照函数 - 将照片分成小块存储，避免大块内存问题
  * @retval 成功时返回分段照片指针，失败时返回NULL
@@ -79,7 +114,7 @@ esp_err_t upload_segmented_photo(segmented_photo_t *seg_photo);
 void release_copied_photo(camera_fb_t *copy_fb);
 
 /**
- * @brief 释放分段照片
+ * @brief 释放分段照片（借用的缓冲交还其所有者）
  * @param seg_photo 需要释放的分段照片指针
  */
 void release_segmented_photo(segmented_photo_t *seg_photo);
@@ -103,6 +138,59 @@ esp_err_t capture_and_upload_photo(void);
  */
 esp_err_t photo_uploader_init(void);
 
+/**
+ * @brief 后台上传统计
+ */
+typedef struct {
+    uint32_t submitted;         /*!< 入队照片数 */
+    uint32_t uploaded;          /*!< 上传成功数 */
+    uint32_t failed;            /*!< 上传失败数 */
+    uint32_t dropped;           /*!< 队列满或任务未运行而被拒绝的照片数 */
+    uint32_t last_upload_ms;    /*!< 最近一次上传耗时 */
+    uint32_t max_queue_ms;      /*!< 照片在队列中等待的最长时间 */
+    uint32_t encoded;           /*!< 上传前编码为JPEG的照片数 */
+    uint32_t last_encode_ms;    /*!< 最近一次JPEG编码耗时 */
+} photo_upload_stats_t;
+
+/**
+ * @brief 上传会话统计（连接开销 = 打开请求的耗时，新建连接含TCP握手，复用连接只含发送请求头）
+ */
+typedef struct {
+    uint32_t requests;          /*!< 发出的请求数（含重试） */
+    uint32_t connects;          /*!< 新建连接次数 */
+    uint32_t reuses;            /*!< 复用已有连接的次数 */
+    uint32_t retries;           /*!< 复用的连接已失效、重连后重发的次数 */
+    uint64_t connect_us;        /*!< 新建连接时打开请求的耗时之和 */
+    uint64_t reuse_us;          /*!< 复用连接时打开请求的耗时之和 */
+    uint32_t last_open_us;      /*!< 最近一次打开请求的耗时 */
+    bool last_reused;           /*!< 最近一次是否复用了连接 */
+} upload_session_stats_t;
+
+/**
+ * @brief 获取上传会话统计
+ * @param stats 输出
+ */
+void upload_session_get_stats(upload_session_stats_t *stats);
+
+/**
+ * @brief 把照片交给后台上传任务（不阻塞）
+ * @param seg_photo 分段照片，成功入队后所有权转交给上传任务，由其上传后释放
+ * @retval ESP_OK: 已入队, ESP_ERR_INVALID_STATE: 上传任务未运行, ESP_ERR_NO_MEM: 队列已满（照片仍归调用者）
+ */
+esp_err_t photo_upload_submit(segmented_photo_t *seg_photo);
+
+/**
+ * @brief 已入队但尚未上传完成的照片数
+ * @retval 照片数
+ */
+uint32_t photo_upload_pending(void);
+
+/**
+ * @brief 获取后台上传统计
+ * @param stats 输出
+ */
+void photo_upload_get_stats(photo_upload_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
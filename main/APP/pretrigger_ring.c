@@ -0,0 +1,269 @@
+#include "pretrigger_ring.h"
+#include "image_scaler.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "PreTrigger";
+
+_Static_assert(PRETRIGGER_RING_FRAMES >= 2, "pre-trigger ring needs a spare slot while one is being read");
+_Static_assert(PRETRIGGER_MIN_DECIMATION >= 1, "decimation must be at least 1");
+
+/**
+ * @brief       帧槽：seq为0表示空或正在写入；pins>0时生产者跳过该槽
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    uint16_t width;
+    uint16_t height;
+    pixformat_t format;
+    int64_t timestamp_us;
+    uint32_t seq;
+    uint8_t pins;
+} pretrigger_slot_t;
+
+/**
+ * @brief       帧环状态：槽元数据由自旋锁保护，像素数据在锁外写入（写入中的槽seq为0，不会被取用）
+ */
+static struct {
+    pretrigger_slot_t slots[PRETRIGGER_RING_FRAMES];
+    size_t slot_bytes;                  /* 每槽容量 */
+    uint32_t write_idx;                 /* 下一个写入位置（仅生产者） */
+    uint32_t last_seq;                  /* 最近存入帧的序号 */
+    rgb565_scale_map_t scale_map;       /* 缩小映射表（仅生产者，按摄像头分辨率缓存） */
+    pretrigger_ring_stats_t stats;
+    portMUX_TYPE lock;
+} s_ring = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/**
+ * @brief       按预算在PSRAM中分配各帧槽
+ * @retval      ESP_OK: 成功, ESP_ERR_NO_MEM: PSRAM不足
+ */
+esp_err_t pretrigger_ring_init(void)
+{
+    if (s_ring.slots[0].buf) {
+        return ESP_OK;
+    }
+
+    s_ring.slot_bytes = PRETRIGGER_RING_BUDGET / PRETRIGGER_RING_FRAMES;
+
+    for (int i = 0; i < PRETRIGGER_RING_FRAMES; i++) {
+        s_ring.slots[i].buf = heap_caps_malloc(s_ring.slot_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_ring.slots[i].buf) {
+            ESP_LOGE(TAG, "Failed to allocate slot %d (%zu bytes) in PSRAM", i, s_ring.slot_bytes);
+            for (int j = 0; j < i; j++) {
+                heap_caps_free(s_ring.slots[j].buf);
+                s_ring.slots[j].buf = NULL;
+            }
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "Pre-trigger ring: %d frames x %zu bytes in PSRAM", PRETRIGGER_RING_FRAMES, s_ring.slot_bytes);
+    return ESP_OK;
+}
+
+/**
+ * @brief       选择一个未被取用的槽并标记为写入中
+ * @retval      槽指针，所有槽都被占用时返回NULL
+ */
+static pretrigger_slot_t *pretrigger_ring_claim(void)
+{
+    pretrigger_slot_t *slot = NULL;
+
+    portENTER_CRITICAL(&s_ring.lock);
+    for (int i = 0; i < PRETRIGGER_RING_FRAMES; i++) {
+        uint32_t idx = (s_ring.write_idx + i) % PRETRIGGER_RING_FRAMES;
+        if (s_ring.slots[idx].pins == 0) {
+            slot = &s_ring.slots[idx];
+            slot->seq = 0;
+            s_ring.write_idx = idx + 1;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_ring.lock);
+
+    return slot;
+}
+
+/**
+ * @brief       缩小并存入一帧（仅后处理级调用），正被取用的槽不会被覆盖
+ * @param       fb: 摄像头帧，调用期间须保持有效
+ * @retval      ESP_OK: 已存入, ESP_ERR_INVALID_STATE: 未初始化, ESP_ERR_NOT_SUPPORTED: 格式不支持,
+ *              ESP_ERR_INVALID_SIZE: 放不下, ESP_ERR_NO_MEM: 所有槽都被占用
+ */
+esp_err_t pretrigger_ring_record(const camera_fb_t *fb)
+{
+    if (!s_ring.slots[0].buf || !fb || !fb->buf) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    int dst_w = fb->width;
+    int dst_h = fb->height;
+    size_t len;
+    uint32_t decimation = 1;
+
+    if (fb->format == PIXFORMAT_RGB565) {
+        /* 取放得下的最小缩小倍数 */
+        decimation = PRETRIGGER_MIN_DECIMATION;
+        while ((size_t)(fb->width / decimation) * (fb->height / decimation) * 2 > s_ring.slot_bytes) {
+            decimation++;
+        }
+        dst_w = fb->width / decimation;
+        dst_h = fb->height / decimation;
+        len = (size_t)dst_w * dst_h * 2;
+        if (len == 0) {
+            s_ring.stats.skipped++;
+            return ESP_ERR_INVALID_SIZE;
+        }
+    } else if (fb->format == PIXFORMAT_JPEG) {
+        /* 已压缩的帧原样保存 */
+        len = fb->len;
+        if (len > s_ring.slot_bytes) {
+            s_ring.stats.skipped++;
+            return ESP_ERR_INVALID_SIZE;
+        }
+    } else {
+        s_ring.stats.skipped++;
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    pretrigger_slot_t *slot = pretrigger_ring_claim();
+    if (!slot) {
+        s_ring.stats.skipped++;
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (fb->format == PIXFORMAT_JPEG) {
+        memcpy(slot->buf, fb->buf, len);
+    } else {
+#if PRETRIGGER_BILINEAR
+        /* 摄像头帧缓冲为大端RGB565 */
+        int map_ret = rgb565_scale_map_prepare_bilinear(&s_ring.scale_map, fb->width, fb->height, dst_w, dst_h, 1);
+        if (map_ret == 0) {
+            map_ret = scale_rgb565_bilinear_rows(&s_ring.scale_map, (const uint16_t *)fb->buf,
+                                                 (uint16_t *)slot->buf, 0, dst_h);
+        }
+#else
+        int map_ret = rgb565_scale_map_prepare(&s_ring.scale_map, fb->width, fb->height, dst_w, dst_h);
+        if (map_ret == 0) {
+            map_ret = scale_rgb565_nearest_rows(&s_ring.scale_map, (const uint16_t *)fb->buf,
+                                                (uint16_t *)slot->buf, 0, dst_h);
+        }
+#endif
+        if (map_ret != 0) {
+            /* 槽保持seq为0（空），下次写入时复用 */
+            s_ring.stats.skipped++;
+            return ESP_FAIL;
+        }
+    }
+
+    portENTER_CRITICAL(&s_ring.lock);
+    slot->len = len;
+    slot->width = (uint16_t)dst_w;
+    slot->height = (uint16_t)dst_h;
+    slot->format = fb->format;
+    /* 摄像头驱动以esp_timer时间戳记录帧采集时间 */
+    slot->timestamp_us = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+    s_ring.last_seq = (s_ring.last_seq + 1) ? s_ring.last_seq + 1 : 1;
+    slot->seq = s_ring.last_seq;
+    portEXIT_CRITICAL(&s_ring.lock);
+
+    s_ring.stats.recorded++;
+    s_ring.stats.decimation = decimation;
+    s_ring.stats.record_us += (uint64_t)(esp_timer_get_time() - start_us);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief       最近存入帧的序号（在后处理级中调用即为正在处理的帧）
+ * @retval      序号，0表示尚无帧
+ */
+uint32_t pretrigger_ring_latest_seq(void)
+{
+    portENTER_CRITICAL(&s_ring.lock);
+    uint32_t seq = s_ring.last_seq;
+    portEXIT_CRITICAL(&s_ring.lock);
+
+    return seq;
+}
+
+/**
+ * @brief       取用一帧，归还前该槽不会被覆盖
+ * @param       seq: 帧序号，0表示最新一帧
+ * @param       frame: 输出
+ * @retval      ESP_OK: 成功, ESP_ERR_NOT_FOUND: 该帧已被覆盖或尚无帧
+ */
+esp_err_t pretrigger_ring_acquire(uint32_t seq, pretrigger_frame_t *frame)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&s_ring.lock);
+    if (seq == 0) {
+        seq = s_ring.last_seq;
+    }
+    for (int i = 0; seq != 0 && i < PRETRIGGER_RING_FRAMES; i++) {
+        pretrigger_slot_t *slot = &s_ring.slots[i];
+        if (slot->seq == seq) {
+            slot->pins++;
+            frame->buf = slot->buf;
+            frame->len = slot->len;
+            frame->width = slot->width;
+            frame->height = slot->height;
+            frame->format = slot->format;
+            frame->timestamp_us = slot->timestamp_us;
+            frame->seq = slot->seq;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    if (ret == ESP_OK) {
+        s_ring.stats.acquired++;
+    } else {
+        s_ring.stats.misses++;
+    }
+    portEXIT_CRITICAL(&s_ring.lock);
+
+    return ret;
+}
+
+/**
+ * @brief       归还取用的帧
+ * @param       frame: pretrigger_ring_acquire的输出
+ * @retval      无
+ */
+void pretrigger_ring_release(const pretrigger_frame_t *frame)
+{
+    if (!frame || !frame->buf) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_ring.lock);
+    for (int i = 0; i < PRETRIGGER_RING_FRAMES; i++) {
+        pretrigger_slot_t *slot = &s_ring.slots[i];
+        if (slot->buf == frame->buf && slot->pins > 0) {
+            slot->pins--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_ring.lock);
+}
+
+/**
+ * @brief       获取统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void pretrigger_ring_get_stats(pretrigger_ring_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_ring.lock);
+    *stats = s_ring.stats;
+    portEXIT_CRITICAL(&s_ring.lock);
+}
@@ -0,0 +1,90 @@
+#ifndef __PRETRIGGER_RING_H__
+#define __PRETRIGGER_RING_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 报警预录帧环：后处理级把每个检测帧缩小后存入PSRAM，报警时直接取触发帧，无需暂停摄像头重新拍照 */
+#define PRETRIGGER_RING_FRAMES      4                   /* 保留最近N帧，至少2帧（一帧被取用时仍可写入） */
+#define PRETRIGGER_RING_BUDGET      (1024 * 1024)       /* PSRAM总预算（字节），平分给各帧槽 */
+#define PRETRIGGER_MIN_DECIMATION   2                   /* 最小缩小倍数，槽容量不足时自动加大 */
+#define PRETRIGGER_BILINEAR         0                   /* 1: 双线性缩小（画质好，耗时多）；0: 最近邻 */
+
+/**
+ * @brief       取出的预录帧（只读视图，须用pretrigger_ring_release归还）
+ */
+typedef struct {
+    const uint8_t *buf;         /*!< 图像数据（RGB565按摄像头字节序，或原样保存的JPEG） */
+    size_t len;                 /*!< 字节数 */
+    uint16_t width;             /*!< 宽度 */
+    uint16_t height;            /*!< 高度 */
+    pixformat_t format;         /*!< 格式 */
+    int64_t timestamp_us;       /*!< 摄像头采集时间（esp_timer） */
+    uint32_t seq;               /*!< 帧序号，从1开始 */
+} pretrigger_frame_t;
+
+/**
+ * @brief       统计
+ */
+typedef struct {
+    uint32_t recorded;          /*!< 存入帧数 */
+    uint32_t skipped;           /*!< 格式不支持、放不下或所有槽都被占用而未存入的帧数 */
+    uint32_t acquired;          /*!< 被取用次数 */
+    uint32_t misses;            /*!< 请求的帧已被覆盖的次数 */
+    uint32_t decimation;        /*!< 最近一帧的缩小倍数 */
+    uint64_t record_us;         /*!< 存入耗时之和 */
+} pretrigger_ring_stats_t;
+
+/**
+ * @brief       按预算在PSRAM中分配各帧槽
+ * @retval      ESP_OK: 成功, ESP_ERR_NO_MEM: PSRAM不足
+ */
+esp_err_t pretrigger_ring_init(void);
+
+/**
+ * @brief       缩小并存入一帧（仅后处理级调用），正被取用的槽不会被覆盖
+ * @param       fb: 摄像头帧，调用期间须保持有效
+ * @retval      ESP_OK: 已存入, ESP_ERR_INVALID_STATE: 未初始化, ESP_ERR_NOT_SUPPORTED: 格式不支持,
+ *              ESP_ERR_INVALID_SIZE: 放不下, ESP_ERR_NO_MEM: 所有槽都被占用
+ */
+esp_err_t pretrigger_ring_record(const camera_fb_t *fb);
+
+/**
+ * @brief       最近存入帧的序号（在后处理级中调用即为正在处理的帧）
+ * @retval      序号，0表示尚无帧
+ */
+uint32_t pretrigger_ring_latest_seq(void);
+
+/**
+ * @brief       取用一帧，归还前该槽不会被覆盖
+ * @param       seq: 帧序号，0表示最新一帧
+ * @param       frame: 输出
+ * @retval      ESP_OK: 成功, ESP_ERR_NOT_FOUND: 该帧已被覆盖或尚无帧
+ */
+esp_err_t pretrigger_ring_acquire(uint32_t seq, pretrigger_frame_t *frame);
+
+/**
+ * @brief       归还取用的帧
+ * @param       frame: pretrigger_ring_acquire的输出
+ * @retval      无
+ */
+void pretrigger_ring_release(const pretrigger_frame_t *frame);
+
+/**
+ * @brief       获取统计
+ * @param       stats: 输出
+ * @retval      无
+ */
+void pretrigger_ring_get_stats(pretrigger_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PRETRIGGER_RING_H__ */
@@ -12,119 +12,417 @@
 #include "system_state_manager.h"
 #include "esp_log.h"
 #include "esp_timer.h"
-#include "esp_task_wdt.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "photo_uploader.h"
 #include "buzzer.h"
 #include "esp_face_detection.hpp"
+#include "pretrigger_ring.h"
+#include "trace_log.h"
 #include <inttypes.h>
+#include <stdlib.h>
 
 static const char *TAG = "SystemStateMgr";
 
+/* 排队及正在上传的照片各钉住一个预录帧槽，须给写入留出空槽 */
+_Static_assert(PRETRIGGER_RING_FRAMES > PHOTO_UPLOAD_QUEUE_LEN + 1,
+               "pre-trigger ring too small for the photos pinned by the upload queue");
+
+/* 全局状态字段的原子读写 */
+#define STATE_LOAD(field)           __atomic_load_n(&g_system_state.field, __ATOMIC_ACQUIRE)
+#define STATE_STORE(field, value)   __atomic_store_n(&g_system_state.field, (value), __ATOMIC_RELEASE)
+
+/**
+ * @brief 状态任务事件
+ */
+typedef enum {
+    SYSTEM_EVENT_PHOTO_REQUEST = 0,    /*!< 请求拍照上传，arg: 1使用预存照片；frame_seq: 触发报警的预录帧 */
+    SYSTEM_EVENT_PAUSE_ACK,            /*!< 任务确认暂停，arg: system_client_t */
+} system_event_type_t;
+
+typedef struct {
+    system_event_type_t type;
+    uint32_t arg;
+    uint32_t frame_seq;                /*!< 预录帧序号，0表示无 */
+} system_event_t;
+
 /* 全局状态管理器实例 */
 system_state_manager_t g_system_state = {0};
 
+static QueueHandle_t s_event_queue = NULL;
+static TaskHandle_t s_state_task = NULL;
+static TaskHandle_t s_clients[SYSTEM_CLIENT_COUNT];
+static uint32_t s_registered_clients = 0;      /* 已登记的任务位图 */
+
+/**
+ * @brief 投递事件到状态任务（不阻塞，队列满时丢弃）
+ * @param type 事件类型
+ * @param arg 事件参数
+ * @param frame_seq 预录帧序号，0表示无
+ */
+static void system_post_event(system_event_type_t type, uint32_t arg, uint32_t frame_seq)
+{
+    system_event_t ev = { .type = type, .arg = arg, .frame_seq = frame_seq };
+
+    if (s_event_queue == NULL || xQueueSend(s_event_queue, &ev, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Event %d dropped (state manager not ready or queue full)", (int)type);
+    }
+}
+
+/**
+ * @brief 通知位图中的已登记任务
+ * @param mask 任务位图
+ */
+static void system_notify_clients(uint32_t mask)
+{
+    for (int i = 0; i < SYSTEM_CLIENT_COUNT; i++) {
+        TaskHandle_t task = __atomic_load_n(&s_clients[i], __ATOMIC_ACQUIRE);
+        if ((mask & (1u << i)) && task) {
+            xTaskNotifyGive(task);
+        }
+    }
+}
+
+/**
+ * @brief 所有已登记任务是否都已确认暂停
+ */
+static bool system_all_clients_paused(void)
+{
+    uint32_t registered = __atomic_load_n(&s_registered_clients, __ATOMIC_ACQUIRE);
+    return (STATE_LOAD(paused_clients) & registered) == registered;
+}
+
+/**
+ * @brief 切回人脸识别模式并唤醒所有等待恢复的任务
+ */
+static void system_resume_clients(void)
+{
+    STATE_STORE(photo_upload_requested, false);
+    STATE_STORE(face_detection_paused, false);
+    STATE_STORE(mode_switch_timestamp, (uint32_t)(esp_timer_get_time() / 1000));
+    STATE_STORE(current_mode, SYSTEM_MODE_FACE_DETECTION);
+
+    /* 先切换模式再通知：任务在检查模式与开始等待之间收到的通知会被计数，不会丢失 */
+    system_notify_clients(STATE_LOAD(paused_clients));
+}
+
+/**
+ * @brief 拍照（如无预存照片）后立即恢复人脸识别，照片交给后台上传任务
+ * @param request_us 请求时间，用于统计请求到拍照完成的延迟
+ */
+static void system_capture_and_upload(int64_t request_us)
+{
+    segmented_photo_t *photo = STATE_LOAD(captured_photo);
+
+    if (!photo) {
+        TRACE_LOG(TRACE_EV_SYS_CAPTURE);
+        photo = capture_photo_segmented();
+
+        if (!photo) {
+            ESP_LOGE(TAG, "❌ Failed to capture photo, aborting upload and returning to face detection");
+            TRACE_LOG(TRACE_EV_SYS_CAPTURE_DONE, 0);
+            system_resume_clients();
+            TRACE_LOG(TRACE_EV_SYS_RESUME);
+            return;
+        }
+
+        TRACE_LOG(TRACE_EV_SYS_CAPTURE_DONE, 1);
+        ESP_LOGI(TAG, "✅ Real-time photo captured %" PRId64 " ms after request, total size: %zu bytes",
+                 (esp_timer_get_time() - request_us) / 1000, photo->total_size);
+    }
+
+    /* 照片已在内存中，摄像头不再需要独占：先恢复检测、距离监测与预览，再排队上传 */
+    STATE_STORE(captured_photo, NULL);
+    system_resume_clients();
+    TRACE_LOG(TRACE_EV_SYS_RESUME);
+
+    STATE_STORE(photo_upload_in_progress, true);
+    if (photo_upload_submit(photo) != ESP_OK) {
+        ESP_LOGW(TAG, "❌ Upload queue full or uploader not running, dropping photo");
+        release_segmented_photo(photo);
+        STATE_STORE(photo_upload_in_progress, photo_upload_pending() > 0);
+    }
+}
+
+/**
+ * @brief 归还上传完的预录帧
+ * @param source 取用时保存的pretrigger_frame_t
+ */
+static void system_release_pretrigger_frame(void *source)
+{
+    pretrigger_ring_release((pretrigger_frame_t *)source);
+    free(source);
+}
+
+/**
+ * @brief 钉住预录帧环中的一帧作为照片，上传时直接从槽中发送，上传完才归还
+ * @param frame_seq 触发报警的帧序号，已被覆盖时退而取最新一帧
+ * @retval 照片，环中无帧或内存不足时返回NULL
+ */
+static segmented_photo_t *system_take_pretrigger_photo(uint32_t frame_seq)
+{
+    pretrigger_frame_t frame;
+
+    if (frame_seq == 0 || pretrigger_ring_acquire(frame_seq, &frame) != ESP_OK) {
+        if (pretrigger_ring_acquire(0, &frame) != ESP_OK) {
+            return NULL;
+        }
+        ESP_LOGW(TAG, "Alarm frame %" PRIu32 " already overwritten, using newest frame %" PRIu32,
+                 frame_seq, frame.seq);
+    }
+
+    pretrigger_frame_t *pinned = malloc(sizeof(*pinned));
+    if (!pinned) {
+        pretrigger_ring_release(&frame);
+        return NULL;
+    }
+    *pinned = frame;
+
+    /* 以摄像头帧描述包装预录帧，照片直接引用槽内数据 */
+    camera_fb_t fb = {
+        .buf = (uint8_t *)frame.buf,
+        .len = frame.len,
+        .width = frame.width,
+        .height = frame.height,
+        .format = frame.format,
+        .timestamp = {
+            .tv_sec = frame.timestamp_us / 1000000,
+            .tv_usec = frame.timestamp_us % 1000000,
+        },
+    };
+    segmented_photo_t *photo = create_borrowed_photo(&fb, system_release_pretrigger_frame, pinned);
+    if (!photo) {
+        system_release_pretrigger_frame(pinned);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "📸 Using pre-trigger frame %" PRIu32 " (%ux%u, captured %" PRId64 " ms before request)",
+             frame.seq, frame.width, frame.height, (esp_timer_get_time() - frame.timestamp_us) / 1000);
+    return photo;
+}
+
+/**
+ * @brief 处理拍照请求：有预录帧或预存照片时直接上传，否则暂停人脸识别并通知各任务尽快确认
+ * @param use_saved 是否使用预存照片
+ * @param frame_seq 触发报警的预录帧序号，0表示无
+ * @retval true 请求已受理（照片已就绪或已进入等待暂停确认阶段）
+ * @retval false 请求被忽略
+ */
+static bool system_begin_photo_upload(bool use_saved, uint32_t frame_seq)
+{
+    /* 上一张照片仍在后台上传时照常受理，由上传队列深度限制积压 */
+    if (STATE_LOAD(current_mode) != SYSTEM_MODE_FACE_DETECTION || STATE_LOAD(photo_upload_requested)) {
+        ESP_LOGW(TAG, "Photo capture already in progress (mode: %d, requested: %d)",
+                 STATE_LOAD(current_mode), STATE_LOAD(photo_upload_requested));
+        return false;
+    }
+
+    if (use_saved && !STATE_LOAD(captured_photo)) {
+        ESP_LOGW(TAG, "No pre-saved photo available, capturing a new one");
+    }
+
+    if (!STATE_LOAD(captured_photo)) {
+        STATE_STORE(captured_photo, system_take_pretrigger_photo(frame_seq));
+    }
+
+    STATE_STORE(photo_upload_requested, true);
+
+    /* 照片已就绪，不需要暂停摄像头 */
+    if (STATE_LOAD(captured_photo)) {
+        TRACE_LOG(TRACE_EV_SYS_UPLOAD_REQUEST, 1);
+        return true;
+    }
+
+    ESP_LOGI(TAG, "📸 Photo upload requested - pausing AI tasks to capture a new photo");
+    TRACE_LOG(TRACE_EV_SYS_UPLOAD_REQUEST, 0);
+
+    STATE_STORE(face_detection_paused, true);
+    STATE_STORE(mode_switch_timestamp, (uint32_t)(esp_timer_get_time() / 1000));
+    STATE_STORE(current_mode, SYSTEM_MODE_TRANSITIONING);
+
+    /* 阻塞在帧环上的任务被唤醒后立即进入暂停分支 */
+    system_notify_clients(~STATE_LOAD(paused_clients));
+    return true;
+}
+
+/**
+ * @brief 状态任务：由事件驱动模式切换，所有任务确认释放摄像头后立即拍照
+ * @param arg 未使用
+ */
+static void system_state_task(void *arg)
+{
+    (void)arg;
+    system_event_t ev;
+    int64_t request_us = 0;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+
+        if (STATE_LOAD(current_mode) == SYSTEM_MODE_TRANSITIONING) {
+            int64_t left_ms = SYSTEM_PAUSE_TIMEOUT_MS - (esp_timer_get_time() - request_us) / 1000;
+            wait = left_ms > 0 ? pdMS_TO_TICKS(left_ms) : 0;
+        }
+
+        if (xQueueReceive(s_event_queue, &ev, wait) != pdTRUE) {
+            /* 等待确认超时：与原先的固定等待一样直接拍照，避免请求被卡住 */
+            ESP_LOGW(TAG, "Pause ack timeout (acked 0x%" PRIx32 ", registered 0x%" PRIx32 "), capturing anyway",
+                     STATE_LOAD(paused_clients), __atomic_load_n(&s_registered_clients, __ATOMIC_ACQUIRE));
+            system_capture_and_upload(request_us);
+            continue;
+        }
+
+        switch (ev.type) {
+            case SYSTEM_EVENT_PHOTO_REQUEST:
+                if (!system_begin_photo_upload(ev.arg != 0, ev.frame_seq)) {
+                    break;
+                }
+                request_us = esp_timer_get_time();
+                if (STATE_LOAD(captured_photo) || system_all_clients_paused()) {
+                    system_capture_and_upload(request_us);
+                }
+                break;
+
+            case SYSTEM_EVENT_PAUSE_ACK:
+                if (STATE_LOAD(current_mode) != SYSTEM_MODE_TRANSITIONING) {
+                    break;
+                }
+                if (system_all_clients_paused()) {
+                    ESP_LOGI(TAG, "🔄 All tasks released the camera %" PRId64 " us after request",
+                             esp_timer_get_time() - request_us);
+                    system_capture_and_upload(request_us);
+                } else {
+                    /* 下游任务等待上游确认后才能确认，唤醒它们重新检查 */
+                    system_notify_clients(~STATE_LOAD(paused_clients));
+                }
+                break;
+
+            default:
+                ESP_LOGW(TAG, "Unknown system event: %d", (int)ev.type);
+                break;
+        }
+    }
+}
+
 /**
  * @brief 初始化系统状态管理器
  */
 esp_err_t system_state_manager_init(void)
 {
-    g_system_state.current_mode = SYSTEM_MODE_FACE_DETECTION;
-    g_system_state.photo_upload_requested = false;
-    g_system_state.face_detection_paused = false;
-    g_system_state.mode_switch_timestamp = 0;
-    g_system_state.alarm_start_timestamp = 0;
-    g_system_state.alarm_timeout_enabled = false;
-    g_system_state.photo_upload_in_progress = false;
-    g_system_state.captured_photo = NULL;  // 初始化实时照片指针
-    
+    STATE_STORE(photo_upload_requested, false);
+    STATE_STORE(face_detection_paused, false);
+    STATE_STORE(mode_switch_timestamp, 0);
+    STATE_STORE(alarm_start_timestamp, 0);
+    STATE_STORE(alarm_timeout_enabled, false);
+    STATE_STORE(photo_upload_in_progress, false);
+    STATE_STORE(captured_photo, NULL);  // 初始化实时照片指针
+    STATE_STORE(current_mode, SYSTEM_MODE_FACE_DETECTION);
+
+    if (s_state_task) {
+        return ESP_OK;
+    }
+
+    s_event_queue = xQueueCreate(SYSTEM_STATE_QUEUE_LEN, sizeof(system_event_t));
+    if (s_event_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create state event queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreatePinnedToCore(system_state_task, "sys_state", SYSTEM_STATE_TASK_STACK, NULL,
+                                SYSTEM_STATE_TASK_PRIO, &s_state_task, SYSTEM_STATE_TASK_CORE) != pdPASS) {
+        s_state_task = NULL;
+        vQueueDelete(s_event_queue);
+        s_event_queue = NULL;
+        ESP_LOGE(TAG, "Failed to create state task");
+        return ESP_ERR_NO_MEM;
+    }
+
     ESP_LOGI(TAG, "System state manager initialized - starting in face detection mode");
     return ESP_OK;
 }
 
 /**
- * @brief 请求切换到拍照上传模式（新流程：分段安全数据复制）
+ * @brief 登记当前任务为摄像头使用者
  */
-void system_request_photo_upload(void)
+void system_state_register_client(system_client_t client)
 {
-    if (g_system_state.current_mode == SYSTEM_MODE_FACE_DETECTION && 
-        !g_system_state.photo_upload_requested && 
-        !g_system_state.photo_upload_in_progress) {
-        
-        ESP_LOGI(TAG, "📸 Photo upload requested - will pause AI tasks first");
-        printf("📸 Photo upload requested - pausing AI tasks for safe camera access...\r\n");
-        
-        // 设置状态切换标志，让AI任务自行暂停
-        g_system_state.photo_upload_requested = true;
-        g_system_state.face_detection_paused = true;
-        g_system_state.current_mode = SYSTEM_MODE_TRANSITIONING;
-        g_system_state.mode_switch_timestamp = esp_timer_get_time() / 1000; // 转换为毫秒
-        
-        printf("🔄 Switching to transitioning mode - AI tasks will pause automatically...\r\n");
-        
-    } else {
-        ESP_LOGW(TAG, "Photo upload already requested or in progress (mode: %d, requested: %d, in_progress: %d)", 
-                 g_system_state.current_mode, 
-                 g_system_state.photo_upload_requested,
-                 g_system_state.photo_upload_in_progress);
+    if (client >= SYSTEM_CLIENT_COUNT) {
+        return;
     }
+
+    __atomic_store_n(&s_clients[client], xTaskGetCurrentTaskHandle(), __ATOMIC_RELEASE);
+    __atomic_fetch_or(&s_registered_clients, 1u << client, __ATOMIC_ACQ_REL);
 }
 
 /**
- * @brief 请求拍照上传（使用已保存的实时照片）
+ * @brief 确认当前任务已停止访问摄像头帧
  */
-void system_request_photo_upload_with_saved_photo(void)
+void system_state_ack_pause(system_client_t client)
 {
-    if (g_system_state.current_mode == SYSTEM_MODE_FACE_DETECTION && 
-        !g_system_state.photo_upload_requested && 
-        !g_system_state.photo_upload_in_progress) {
-        
-        if (g_system_state.captured_photo) {
-            ESP_LOGI(TAG, "📸 Photo upload requested with pre-saved real-time photo");
-            printf("📸 Using pre-saved real-time photo for upload...\r\n");
-            
-            // 直接开始模式切换流程，无需重新拍照
-            printf("🖥️  Pausing LCD display for photo upload...\r\n");
-            g_system_state.photo_upload_requested = true;
-            g_system_state.face_detection_paused = true;
-            g_system_state.current_mode = SYSTEM_MODE_TRANSITIONING;
-            g_system_state.mode_switch_timestamp = esp_timer_get_time() / 1000; // 转换为毫秒
-            
-            printf("🔄 Switching to photo upload mode with pre-saved photo...\r\n");
-        } else {
-            ESP_LOGW(TAG, "No pre-saved photo available, falling back to regular safe copy photo upload");
-            system_request_photo_upload();
-        }
-    } else {
-        ESP_LOGW(TAG, "Photo upload already requested or in progress (mode: %d, requested: %d, in_progress: %d)", 
-                 g_system_state.current_mode, 
-                 g_system_state.photo_upload_requested,
-                 g_system_state.photo_upload_in_progress);
+    if (client >= SYSTEM_CLIENT_COUNT) {
+        return;
     }
+
+    __atomic_fetch_or(&g_system_state.paused_clients, 1u << client, __ATOMIC_ACQ_REL);
+    system_post_event(SYSTEM_EVENT_PAUSE_ACK, client, 0);
 }
 
 /**
- * @brief 完成拍照上传，切换回人脸识别模式
+ * @brief 阻塞等待恢复人脸识别模式
  */
-void system_photo_upload_complete(void)
+void system_state_wait_resume(system_client_t client)
 {
-    ESP_LOGI(TAG, "📸 Photo upload completed - switching back to face detection");
-    g_system_state.photo_upload_requested = false;
-    g_system_state.face_detection_paused = false;
-    g_system_state.current_mode = SYSTEM_MODE_FACE_DETECTION;
-    g_system_state.mode_switch_timestamp = esp_timer_get_time() / 1000;
-    
-    // 清理可能残留的分段照片
-    if (g_system_state.captured_photo) {
-        ESP_LOGI(TAG, "Cleaning up remaining segmented photo");
-        release_segmented_photo(g_system_state.captured_photo);
-        g_system_state.captured_photo = NULL;
+    /* 通知可能来自帧环或其他唤醒，只以模式为准 */
+    while (!system_can_do_face_detection()) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     }
-    
-    printf("🔄 Switching back to face detection mode...\r\n");
+
+    if (client < SYSTEM_CLIENT_COUNT) {
+        __atomic_fetch_and(&g_system_state.paused_clients, ~(1u << client), __ATOMIC_ACQ_REL);
+    }
+}
+
+/**
+ * @brief 查询某任务是否已确认暂停
+ */
+bool system_state_client_paused(system_client_t client)
+{
+    return client < SYSTEM_CLIENT_COUNT && (STATE_LOAD(paused_clients) & (1u << client)) != 0;
 }
 
+/**
+ * @brief 请求切换到拍照上传模式（由状态任务暂停各任务后拍照）
+ */
+void system_request_photo_upload(void)
+{
+    /* 由后处理级在距离检测中调用，此时最新的预录帧就是触发报警的这一帧 */
+    system_post_event(SYSTEM_EVENT_PHOTO_REQUEST, 0, pretrigger_ring_latest_seq());
+}
+
+/**
+ * @brief 请求拍照上传（使用已保存的实时照片，没有时重新拍照）
+ */
+void system_request_photo_upload_with_saved_photo(void)
+{
+    system_post_event(SYSTEM_EVENT_PHOTO_REQUEST, 1, 0);
+}
+
+/**
+ * @brief 后台上传任务完成一张照片后调用
+ */
+void system_photo_upload_complete(esp_err_t result)
+{
+    TRACE_LOG(TRACE_EV_SYS_UPLOAD_DONE, result == ESP_OK);
+    if (result == ESP_OK) {
+        ESP_LOGI(TAG, "✅ Photo upload successful");
+    } else {
+        ESP_LOGW(TAG, "❌ Photo upload failed");
+    }
+
+    STATE_STORE(photo_upload_in_progress, photo_upload_pending() > 0);
+}
+
+
 /**
  * @brief 报警器自动关闭任务
  */
@@ -136,9 +434,9 @@ static void alarm_auto_stop_task(void *pvParameters)
     vTaskDelay(pdMS_TO_TICKS(delay_ms));
     
     ESP_LOGW(TAG, "⏰ Alarm auto-stop timer expired - stopping buzzer now");
-    printf("⏰ %d-second alarm completed - stopping buzzer\r\n", (int)(delay_ms/1000));
+    TRACE_LOG(TRACE_EV_SYS_ALARM_EXPIRED, (int32_t)(delay_ms / 1000));
     buzzer_alarm(0);
-    g_system_state.alarm_timeout_enabled = false;
+    STATE_STORE(alarm_timeout_enabled, false);
     
     ESP_LOGI(TAG, "⏰ Alarm auto-stop task completed and deleted");
     vTaskDelete(NULL); // 删除自己
@@ -149,8 +447,8 @@ static void alarm_auto_stop_task(void *pvParameters)
  */
 void system_start_alarm_timeout(uint32_t timeout_ms)
 {
-    g_system_state.alarm_start_timestamp = esp_timer_get_time() / 1000;
-    g_system_state.alarm_timeout_enabled = true;
+    STATE_STORE(alarm_start_timestamp, (uint32_t)(esp_timer_get_time() / 1000));
+    STATE_STORE(alarm_timeout_enabled, true);
     
     // 创建一个专门的任务来处理报警自动关闭
     xTaskCreate(alarm_auto_stop_task, "alarm_stop", 2048, (void*)timeout_ms, 5, NULL);
@@ -163,7 +461,7 @@ void system_start_alarm_timeout(uint32_t timeout_ms)
  */
 void system_stop_alarm_timeout(void)
 {
-    g_system_state.alarm_timeout_enabled = false;
+    STATE_STORE(alarm_timeout_enabled, false);
     ESP_LOGD(TAG, "Alarm timeout stopped");
 }
 
@@ -172,8 +470,8 @@ void system_stop_alarm_timeout(void)
  */
 bool system_can_update_lcd(void)
 {
-    // 在拍照上传期间禁用LCD显示，避免SPI冲突
-    return (g_system_state.current_mode == SYSTEM_MODE_FACE_DETECTION);
+    // 独占拍照期间禁用LCD显示，避免SPI冲突
+    return (STATE_LOAD(current_mode) == SYSTEM_MODE_FACE_DETECTION);
 }
 
 /**
@@ -181,7 +479,7 @@ bool system_can_update_lcd(void)
  */
 system_mode_t system_get_current_mode(void)
 {
-    return g_system_state.current_mode;
+    return STATE_LOAD(current_mode);
 }
 
 /**
@@ -189,8 +487,8 @@ system_mode_t system_get_current_mode(void)
  */
 bool system_can_do_face_detection(void)
 {
-    return (g_system_state.current_mode == SYSTEM_MODE_FACE_DETECTION && 
-            !g_system_state.face_detection_paused);
+    return (STATE_LOAD(current_mode) == SYSTEM_MODE_FACE_DETECTION &&
+            !STATE_LOAD(face_detection_paused));
 }
 
 /**
@@ -198,146 +496,5 @@ bool system_can_do_face_detection(void)
  */
 bool system_need_photo_upload(void)
 {
-    return g_system_state.photo_upload_requested;
-}
-
-/**
- * @brief 系统状态管理任务处理函数
- */
-void system_state_task_handler(void)
-{
-    static uint32_t last_log_time = 0;
-    uint32_t current_time = esp_timer_get_time() / 1000; // 转换为毫秒
-    
-    // 报警自动关闭现在由专门的任务处理，这里不需要检查了
-    
-    switch (g_system_state.current_mode) {
-        case SYSTEM_MODE_FACE_DETECTION:
-            // 正常人脸识别模式，无需特殊处理
-            break;
-            
-        case SYSTEM_MODE_TRANSITIONING:
-            // 模式切换中，检查是否需要执行拍照上传
-            if (g_system_state.photo_upload_requested && !g_system_state.photo_upload_in_progress) {
-                // 确保AI任务有足够时间暂停，避免摄像头资源冲突
-                uint32_t elapsed_time = current_time - g_system_state.mode_switch_timestamp;
-                if (elapsed_time < 500) { // 等待500ms让AI任务完全暂停
-                    ESP_LOGD(TAG, "Waiting for AI tasks to pause completely... (%d ms elapsed)", (int)elapsed_time);
-                    break;
-                }
-                
-                ESP_LOGI(TAG, "🔄 AI tasks should be paused now, starting photo capture...");
-                printf("🚫 LCD display DISABLED for SPI exclusive access\r\n");
-                printf("⏸️  Face detection PAUSED for camera exclusive access\r\n");
-                
-                // AI任务现在应该已经暂停，可以安全拍照
-                printf("📸 CAPTURING REAL-TIME PHOTO with segmented safe storage...\r\n");
-                segmented_photo_t *segmented_photo = capture_photo_segmented();
-                
-                if (segmented_photo) {
-                    ESP_LOGI(TAG, "✅ Real-time photo safely captured in segments, total size: %zu bytes", 
-                             segmented_photo->total_size);
-                    
-                    // 保存分段照片到全局变量
-                    g_system_state.captured_photo = segmented_photo;
-                    
-                    // 切换到上传模式
-                    g_system_state.current_mode = SYSTEM_MODE_PHOTO_UPLOAD;
-                    g_system_state.photo_upload_in_progress = true;
-                    printf("🔄 Photo captured successfully, switching to upload mode...\r\n");
-                } else {
-                    ESP_LOGE(TAG, "❌ Failed to capture photo, aborting upload and returning to face detection");
-                    printf("❌ Failed to capture photo, returning to face detection mode\r\n");
-                    
-                    // 拍照失败，返回人脸识别模式
-                    g_system_state.photo_upload_requested = false;
-                    g_system_state.face_detection_paused = false;
-                    g_system_state.current_mode = SYSTEM_MODE_FACE_DETECTION;
-                }
-            }
-            break;
-            
-        case SYSTEM_MODE_PHOTO_UPLOAD:
-            // 执行照片上传（使用预先拍好的实时照片）
-            if (g_system_state.photo_upload_in_progress) {
-                ESP_LOGI(TAG, "📸 Uploading pre-captured real-time photo...");
-                
-                // 通知主任务暂时退出看门狗监控，因为照片上传耗时较长
-                bool was_watchdog_active = main_watchdog_active;
-                if (main_watchdog_active) {
-                    esp_err_t ret = esp_task_wdt_delete(xTaskGetCurrentTaskHandle());
-                    if (ret == ESP_OK) {
-                        main_watchdog_active = false;
-                        ESP_LOGI(TAG, "Main task temporarily removed from watchdog for photo upload");
-                    }
-                }
-                
-                esp_err_t upload_ret = ESP_FAIL;
-                
-                // 使用预先分段保存的实时照片进行上传
-                if (g_system_state.captured_photo) {
-                    ESP_LOGI(TAG, "Using pre-captured segmented photo for upload, total size: %zu bytes", 
-                             g_system_state.captured_photo->total_size);
-                    upload_ret = upload_segmented_photo(g_system_state.captured_photo);
-                    
-                    // 使用安全的释放函数释放分段照片内存
-                    ESP_LOGI(TAG, "Releasing segmented photo memory");
-                    release_segmented_photo(g_system_state.captured_photo);
-                    g_system_state.captured_photo = NULL;
-                } else {
-                    ESP_LOGE(TAG, "No pre-captured photo available, upload failed");
-                    upload_ret = ESP_FAIL;
-                }
-                
-                // 重新加入看门狗监控
-                if (was_watchdog_active && !main_watchdog_active) {
-                    esp_err_t ret = esp_task_wdt_add(xTaskGetCurrentTaskHandle());
-                    if (ret == ESP_OK) {
-                        main_watchdog_active = true;
-                        ESP_LOGI(TAG, "Main task re-added to watchdog after photo upload");
-                    }
-                }
-                
-                // 处理上传结果
-                if (upload_ret == ESP_OK) {
-                    printf("✅ Photo uploaded successfully! ✅\r\n");
-                    ESP_LOGI(TAG, "✅ Photo upload successful");
-                } else {
-                    printf("❌ Photo upload failed! ❌\r\n");
-                    ESP_LOGW(TAG, "❌ Photo upload failed");
-                }
-                
-                // 无论成功失败都要停止报警并切换回人脸识别模式
-                ESP_LOGI(TAG, "Stopping alarm and switching back to face detection mode");
-                buzzer_alarm(0); // 确保停止报警
-                
-                // 完成上传，立即切换回人脸识别模式
-                g_system_state.photo_upload_in_progress = false;
-                printf("🖥️  LCD display RE-ENABLED - resuming normal operation\r\n");
-                printf("▶️  Face detection RESUMED - camera access restored\r\n");
-                
-                // 不需要手动恢复任务，任务会检测到 system_can_do_face_detection() 返回 true
-                // 并自动恢复正常运行和看门狗状态
-                
-                system_photo_upload_complete();
-            }
-            break;
-            
-        default:
-            ESP_LOGW(TAG, "Unknown system mode: %d", g_system_state.current_mode);
-            // 强制切换回人脸识别模式
-            g_system_state.current_mode = SYSTEM_MODE_FACE_DETECTION;
-            break;
-    }
-    
-    // 每5秒打印一次状态日志（用于调试）
-    if (current_time - last_log_time > 5000) {
-        if (g_system_state.current_mode != SYSTEM_MODE_FACE_DETECTION) {
-            ESP_LOGD(TAG, "System mode: %d, Photo requested: %d, Face detection paused: %d", 
-                     g_system_state.current_mode, 
-                     g_system_state.photo_upload_requested,
-                     g_system_state.face_detection_paused);
-        }
-        last_log_time = current_time;
-    }
+    return STATE_LOAD(photo_upload_requested);
 }
@@ -21,17 +21,34 @@
 extern "C" {
 #endif
 
+#define SYSTEM_STATE_TASK_PRIO      6           /* 高于流水线各级，暂停确认到达后立即处理 */
+#define SYSTEM_STATE_TASK_CORE      0
+#define SYSTEM_STATE_TASK_STACK     (4 * 1024)  /* 只做拍照与分段复制，上传由后台上传任务执行 */
+#define SYSTEM_STATE_QUEUE_LEN      8           /* 事件队列深度 */
+#define SYSTEM_PAUSE_TIMEOUT_MS     1000        /* 等待暂停确认的上限，超时后仍执行拍照 */
+
 /**
  * @brief 系统工作模式枚举
  */
 typedef enum {
-    SYSTEM_MODE_FACE_DETECTION = 0,    /*!< 人脸识别模式 */
-    SYSTEM_MODE_PHOTO_UPLOAD = 1,      /*!< 拍照上传模式 */
-    SYSTEM_MODE_TRANSITIONING = 2      /*!< 模式切换中 */
+    SYSTEM_MODE_FACE_DETECTION = 0,    /*!< 人脸识别模式（后台上传期间也处于此模式） */
+    SYSTEM_MODE_TRANSITIONING = 2      /*!< 暂停各任务后独占摄像头拍照中（1原为上传模式，上传已移至后台） */
 } system_mode_t;
 
+/**
+ * @brief 占用摄像头帧的任务，拍照前需全部确认已释放
+ * @note 按流水线顺序排列：采集级确认后MSR01级才能取空帧环，MSR01级确认后显示任务才能确认
+ */
+typedef enum {
+    SYSTEM_CLIENT_CAMERA = 0,          /*!< 采集任务 */
+    SYSTEM_CLIENT_AI,                  /*!< MSR01级（收回全部任务单后确认） */
+    SYSTEM_CLIENT_LCD,                 /*!< 显示任务 */
+    SYSTEM_CLIENT_COUNT
+} system_client_t;
+
 /**
  * @brief 系统状态管理器结构体
+ * @note 各字段可能被多个任务同时读写，一律通过__atomic内建函数访问
  */
 typedef struct {
     system_mode_t current_mode;        /*!< 当前工作模式 */
@@ -40,23 +57,51 @@ typedef struct {
     uint32_t mode_switch_timestamp;    /*!< 模式切换时间戳 */
     uint32_t alarm_start_timestamp;    /*!< 报警自动关闭定时器开始时间戳 */
     bool alarm_timeout_enabled;        /*!< 是否启用报警自动关闭定时器 */
-    bool photo_upload_in_progress;     /*!< 拍照上传是否正在进行 */
+    bool photo_upload_in_progress;     /*!< 后台上传队列中是否仍有照片 */
     segmented_photo_t *captured_photo;  /*!< 保存的实时照片（分段数据指针） */
+    uint32_t paused_clients;           /*!< 已确认暂停的任务位图（1 << system_client_t） */
 } system_state_manager_t;
 
 /* 全局状态管理器 */
 extern system_state_manager_t g_system_state;
 
 /**
- * @brief 初始化系统状态管理器
+ * @brief 初始化系统状态管理器，创建事件队列及状态任务
  * @retval ESP_OK 成功
- * @retval ESP_FAIL 失败
+ * @retval ESP_ERR_NO_MEM 队列或任务创建失败
  */
 esp_err_t system_state_manager_init(void);
 
 /**
- * @brief 请求切换到拍照上传模式
- * @note 这将暂停人脸识别，启动拍照上传流程
+ * @brief 登记当前任务为摄像头使用者，拍照前须等待其确认暂停
+ * @param client 任务类别
+ */
+void system_state_register_client(system_client_t client);
+
+/**
+ * @brief 确认当前任务已停止访问摄像头帧（不阻塞）
+ * @param client 任务类别
+ */
+void system_state_ack_pause(system_client_t client);
+
+/**
+ * @brief 阻塞等待恢复人脸识别模式，返回时清除本任务的暂停确认
+ * @note 等待期间不喂看门狗，调用前应先退出看门狗监控
+ * @param client 任务类别
+ */
+void system_state_wait_resume(system_client_t client);
+
+/**
+ * @brief 查询某任务是否已确认暂停（供流水线下游判断上游是否已停止投递）
+ * @param client 任务类别
+ * @retval true 已确认暂停
+ * @retval false 未确认
+ */
+bool system_state_client_paused(system_client_t client);
+
+/**
+ * @brief 请求拍照上传
+ * @note 优先使用触发报警的预录帧；没有时短暂暂停人脸识别拍照，照片交给后台上传任务
  */
 void system_request_photo_upload(void);
 
@@ -80,14 +125,15 @@ void system_stop_alarm_timeout(void);
 /**
  * @brief 获取是否允许LCD显示
  * @retval true 允许LCD显示
- * @retval false LCD显示被暂停（拍照上传中）
+ * @retval false LCD显示被暂停（独占拍照中）
  */
 bool system_can_update_lcd(void);
 
 /**
- * @brief 完成拍照上传，切换回人脸识别模式
+ * @brief 后台上传任务完成一张照片后调用，更新上传状态
+ * @param result 上传结果
  */
-void system_photo_upload_complete(void);
+void system_photo_upload_complete(esp_err_t result);
 
 /**
  * @brief 获取当前系统模式
@@ -109,12 +155,6 @@ bool system_can_do_face_detection(void);
  */
 bool system_need_photo_upload(void);
 
-/**
- * @brief 系统状态管理任务处理函数
- * @note 在主循环中调用，处理模式切换逻辑
- */
-void system_state_task_handler(void);
-
 /* 主任务看门狗相关外部声明 */
 extern bool main_watchdog_active;
 void safe_watchdog_reset(void);
@@ -0,0 +1,222 @@
+#include "trace_log.h"
+
+#if TRACE_LOG_ENABLE
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <inttypes.h>
+
+static const char *TAG = "TraceLog";
+
+/**
+ * @brief       单核环形缓冲：本核写head，输出任务写tail
+ */
+typedef struct {
+    trace_record_t rec[TRACE_LOG_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+} trace_ring_t;
+
+/**
+ * @brief       事件描述：输出格式（各参数均以%s代入）及浮点参数掩码
+ */
+typedef struct {
+    const char *fmt;
+    uint8_t float_mask;
+} trace_desc_t;
+
+static trace_ring_t s_rings[portNUM_PROCESSORS];
+static TaskHandle_t s_drain_task = NULL;
+
+static const trace_desc_t s_desc[TRACE_EV_COUNT] = {
+    [TRACE_EV_NONE]                 = { "?", 0 },
+    [TRACE_EV_FACE_COUNT]           = { "Face detected - Count: %s", 0 },
+    [TRACE_EV_FACE_EYES]            = { "Face %s eyes: L(%s, %s) R(%s, %s)", 0 },
+    [TRACE_EV_FACE_NO_KEYPOINTS]    = { "Face %s: No keypoints detected", 0 },
+    [TRACE_EV_DIST_NOT_READY]       = { "Distance detector not initialized!", 0 },
+    [TRACE_EV_DIST_BATCH]           = { "Processing %s faces for distance detection", 0 },
+    [TRACE_EV_CALIB_NO_KEYPOINTS]   = { "Calibration: face has no keypoints", 0 },
+    [TRACE_EV_CALIB_REJECTED]       = { "Calibration: frame rejected (reason %s, value %s)", 0x02 },
+    [TRACE_EV_CALIB_SAMPLE]         = { "Calibration sample %s: %s px, CI +/-%s%%", 0x06 },
+    [TRACE_EV_DIST_RESULT]          = { "Current distance: %s cm, state: %s", 0x01 },
+    [TRACE_EV_DIST_STATE]           = { "State change: %s -> %s at %s cm", 0x04 },
+    [TRACE_EV_DIST_STILL_CLOSE]     = { "STILL TOO CLOSE: %s cm - Move back!", 0x01 },
+    [TRACE_EV_DIST_UNCALIBRATED]    = { "Distance detector not calibrated (reminder %s)", 0 },
+    [TRACE_EV_BUZZER]               = { "Buzzer alarm: %s", 0 },
+    [TRACE_EV_NO_FACE]              = { "No face detected for %s frames", 0 },
+    [TRACE_EV_NO_FACE_ALARM_OFF]    = { "Face left camera view, alarm off", 0 },
+    [TRACE_EV_SYS_UPLOAD_REQUEST]   = { "Photo upload requested (photo ready without pause: %s)", 0 },
+    [TRACE_EV_SYS_CAPTURE]          = { "LCD and face detection paused, capturing photo", 0 },
+    [TRACE_EV_SYS_CAPTURE_DONE]     = { "Photo capture result: %s", 0 },
+    [TRACE_EV_SYS_UPLOAD_DONE]      = { "Photo upload result: %s", 0 },
+    [TRACE_EV_SYS_RESUME]           = { "LCD and face detection resumed", 0 },
+    [TRACE_EV_SYS_ALARM_EXPIRED]    = { "%s-second alarm completed - stopping buzzer", 0 },
+};
+
+/**
+ * @brief       写入一条记录到当前核的环形缓冲（仅屏蔽本核中断，缓冲满时丢弃新记录）
+ * @param       event: 事件ID
+ * @param       nargs: 参数个数，超过TRACE_LOG_MAX_ARGS的部分被截断
+ * @param       args: 参数
+ * @retval      无
+ */
+void trace_log_write(trace_event_t event, uint8_t nargs, const int32_t *args)
+{
+    if (nargs > TRACE_LOG_MAX_ARGS) {
+        nargs = TRACE_LOG_MAX_ARGS;
+    }
+
+    /* 屏蔽本核中断后既不会被抢占也不会迁核，同一环只有本核写入，无需自旋锁 */
+    UBaseType_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace_ring_t *ring = &s_rings[xPortGetCoreID()];
+    uint32_t head = ring->head;
+
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= TRACE_LOG_RING_SIZE) {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+    } else {
+        trace_record_t *rec = &ring->rec[head & (TRACE_LOG_RING_SIZE - 1)];
+
+        rec->timestamp_us = esp_timer_get_time();
+        rec->event = (uint16_t)event;
+        rec->core = (uint8_t)xPortGetCoreID();
+        rec->nargs = nargs;
+        for (uint8_t i = 0; i < nargs; i++) {
+            rec->args[i] = args[i];
+        }
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+/**
+ * @brief       获取因缓冲满而丢弃的记录数
+ * @retval      丢弃数
+ */
+uint32_t trace_log_get_dropped(void)
+{
+    uint32_t dropped = 0;
+
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        dropped += __atomic_load_n(&s_rings[c].dropped, __ATOMIC_RELAXED);
+    }
+
+    return dropped;
+}
+
+/**
+ * @brief       输出一条记录
+ * @param       rec: 记录
+ * @retval      无
+ */
+static void trace_log_emit(const trace_record_t *rec)
+{
+#if TRACE_LOG_RAW_DUMP
+    const uint8_t *p = (const uint8_t *)rec;
+    char line[2 + 2 * sizeof(*rec) + 3];
+    int n = snprintf(line, sizeof(line), "T:");
+
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        n += snprintf(line + n, sizeof(line) - n, "%02x", p[i]);
+    }
+    snprintf(line + n, sizeof(line) - n, "\r\n");
+    fputs(line, stdout);
+#else
+    const trace_desc_t *desc = rec->event < TRACE_EV_COUNT ? &s_desc[rec->event] : &s_desc[TRACE_EV_NONE];
+    char argv[TRACE_LOG_MAX_ARGS][16] = { { 0 } };
+    char line[160];
+
+    for (int i = 0; i < rec->nargs; i++) {
+        if (desc->float_mask & (1u << i)) {
+            float v;
+            memcpy(&v, &rec->args[i], sizeof(v));
+            snprintf(argv[i], sizeof(argv[i]), "%.1f", v);
+        } else {
+            snprintf(argv[i], sizeof(argv[i]), "%" PRId32, rec->args[i]);
+        }
+    }
+
+    int n = snprintf(line, sizeof(line), "[%" PRId64 ".%06" PRId64 "] C%u ",
+                     rec->timestamp_us / 1000000, rec->timestamp_us % 1000000, (unsigned)rec->core);
+    if (n > 0 && n < (int)sizeof(line)) {
+        n += snprintf(line + n, sizeof(line) - n, desc->fmt, argv[0], argv[1], argv[2], argv[3], argv[4]);
+    }
+    if (n >= (int)sizeof(line) - 2) {
+        n = sizeof(line) - 3;
+    }
+    snprintf(line + n, sizeof(line) - n, "\r\n");
+    fputs(line, stdout);
+#endif
+}
+
+/**
+ * @brief       输出任务：按时间戳合并各核记录后逐条输出
+ * @param       arg: 未使用
+ * @retval      无
+ */
+static void trace_log_drain_task(void *arg)
+{
+    (void)arg;
+    uint32_t reported_dropped = 0;
+
+    while (1) {
+        while (1) {
+            trace_ring_t *next = NULL;
+
+            for (int c = 0; c < portNUM_PROCESSORS; c++) {
+                trace_ring_t *ring = &s_rings[c];
+                uint32_t tail = ring->tail;
+
+                if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+                    continue;
+                }
+                if (next == NULL ||
+                    ring->rec[tail & (TRACE_LOG_RING_SIZE - 1)].timestamp_us <
+                    next->rec[next->tail & (TRACE_LOG_RING_SIZE - 1)].timestamp_us) {
+                    next = ring;
+                }
+            }
+
+            if (next == NULL) {
+                break;
+            }
+
+            trace_log_emit(&next->rec[next->tail & (TRACE_LOG_RING_SIZE - 1)]);
+            __atomic_store_n(&next->tail, next->tail + 1, __ATOMIC_RELEASE);
+        }
+
+        uint32_t dropped = trace_log_get_dropped();
+        if (dropped != reported_dropped) {
+            ESP_LOGW(TAG, "%" PRIu32 " trace records dropped (ring full)", dropped - reported_dropped);
+            reported_dropped = dropped;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(TRACE_LOG_DRAIN_MS));
+    }
+}
+
+/**
+ * @brief       创建低优先级输出任务，按时间顺序合并两个核的记录后输出
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t trace_log_start(void)
+{
+    if (s_drain_task) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreatePinnedToCore(trace_log_drain_task, "trace_drain", 3 * 1024, NULL, TRACE_LOG_TASK_PRIO,
+                                &s_drain_task, TRACE_LOG_TASK_CORE) != pdPASS) {
+        s_drain_task = NULL;
+        ESP_LOGE(TAG, "Failed to create trace drain task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+#endif /* TRACE_LOG_ENABLE */
@@ -0,0 +1,130 @@
+#ifndef __TRACE_LOG_H__
+#define __TRACE_LOG_H__
+
+#include <stdint.h>
+#include <string.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1: 热路径事件写入二进制环形缓冲，由低优先级任务格式化输出；0: 所有打点编译为空操作 */
+#ifndef TRACE_LOG_ENABLE
+#define TRACE_LOG_ENABLE            1
+#endif
+
+/* 1: 输出原始记录的十六进制行（"T:"开头）供主机端解码；0: 在板上格式化为文本 */
+#ifndef TRACE_LOG_RAW_DUMP
+#define TRACE_LOG_RAW_DUMP          0
+#endif
+
+#define TRACE_LOG_RING_SIZE         128     /* 每个核的记录槽数，必须为2的幂 */
+#define TRACE_LOG_MAX_ARGS          5       /* 每条记录的参数个数上限 */
+#define TRACE_LOG_DRAIN_MS          50      /* 输出任务轮询周期 */
+#define TRACE_LOG_TASK_PRIO         1
+#define TRACE_LOG_TASK_CORE         0
+
+/**
+ * @brief       事件ID，新增事件时同步补充trace_log.c中的描述表
+ */
+typedef enum {
+    TRACE_EV_NONE = 0,
+    /* 人脸检测流水线 */
+    TRACE_EV_FACE_COUNT,            /*!< 检测到人脸：数量 */
+    TRACE_EV_FACE_EYES,             /*!< 眼部坐标：序号、左眼x/y、右眼x/y */
+    TRACE_EV_FACE_NO_KEYPOINTS,     /*!< 无关键点：序号 */
+    /* 距离检测 */
+    TRACE_EV_DIST_NOT_READY,        /*!< 检测器未初始化或结果为空 */
+    TRACE_EV_DIST_BATCH,            /*!< 开始处理：人脸数 */
+    TRACE_EV_CALIB_NO_KEYPOINTS,    /*!< 标定帧无关键点 */
+    TRACE_EV_CALIB_REJECTED,        /*!< 标定帧被剔除：原因(1侧脸/2离群)、偏航比例或眼距(浮点) */
+    TRACE_EV_CALIB_SAMPLE,          /*!< 标定帧被接受：序号、眼距(px,浮点)、置信区间(%,浮点) */
+    TRACE_EV_DIST_RESULT,           /*!< 距离(cm,浮点)、状态 */
+    TRACE_EV_DIST_STATE,            /*!< 状态变化：旧、新、距离(cm,浮点) */
+    TRACE_EV_DIST_STILL_CLOSE,      /*!< 持续过近：距离(cm,浮点) */
+    TRACE_EV_DIST_UNCALIBRATED,     /*!< 未标定提醒：次数 */
+    TRACE_EV_BUZZER,                /*!< 蜂鸣器：1开/0关 */
+    TRACE_EV_NO_FACE,               /*!< 连续无人脸帧数 */
+    TRACE_EV_NO_FACE_ALARM_OFF,     /*!< 人脸离开画面，关闭报警 */
+    /* 系统状态管理 */
+    TRACE_EV_SYS_UPLOAD_REQUEST,    /*!< 请求拍照上传：1照片已就绪（预录帧或预存照片），0需暂停后拍照 */
+    TRACE_EV_SYS_CAPTURE,           /*!< 开始独占拍照 */
+    TRACE_EV_SYS_CAPTURE_DONE,      /*!< 拍照结果：1成功/0失败 */
+    TRACE_EV_SYS_UPLOAD_DONE,       /*!< 上传结果：1成功/0失败 */
+    TRACE_EV_SYS_RESUME,            /*!< 恢复人脸检测与LCD */
+    TRACE_EV_SYS_ALARM_EXPIRED,     /*!< 报警超时关闭：秒 */
+    TRACE_EV_COUNT
+} trace_event_t;
+
+/**
+ * @brief       定长二进制记录（32字节），主机端按此布局解码
+ */
+typedef struct {
+    int64_t timestamp_us;                   /*!< esp_timer时间 */
+    uint16_t event;                         /*!< trace_event_t */
+    uint8_t core;                           /*!< 写入时所在的核 */
+    uint8_t nargs;                          /*!< 有效参数个数 */
+    int32_t args[TRACE_LOG_MAX_ARGS];       /*!< 整数参数或浮点位模式 */
+} trace_record_t;
+
+/**
+ * @brief       把浮点数按位存入整数参数，由描述表中的浮点掩码还原
+ * @param       v: 浮点值
+ * @retval      位模式
+ */
+static inline int32_t trace_log_f2i(float v)
+{
+    int32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+#if TRACE_LOG_ENABLE
+
+/* 参数需为整数（或用TRACE_F包装的浮点数），写入只复制几个字，不做任何格式化 */
+#define TRACE_F(v)                  trace_log_f2i((float)(v))
+#define TRACE_LOG(ev, ...)                                                                  \
+    do {                                                                                    \
+        const int32_t trace_args_[] = { 0, ##__VA_ARGS__ };                                 \
+        trace_log_write((ev), (uint8_t)(sizeof(trace_args_) / sizeof(int32_t) - 1),       \
+                        trace_args_ + 1);                                                   \
+    } while (0)
+
+/**
+ * @brief       写入一条记录到当前核的环形缓冲（仅屏蔽本核中断，缓冲满时丢弃新记录）
+ * @param       event: 事件ID
+ * @param       nargs: 参数个数，超过TRACE_LOG_MAX_ARGS的部分被截断
+ * @param       args: 参数
+ * @retval      无
+ */
+void trace_log_write(trace_event_t event, uint8_t nargs, const int32_t *args);
+
+/**
+ * @brief       创建低优先级输出任务，按时间顺序合并两个核的记录后输出
+ * @retval      ESP_OK: 成功, 其他: 失败
+ */
+esp_err_t trace_log_start(void);
+
+/**
+ * @brief       获取因缓冲满而丢弃的记录数
+ * @retval      丢弃数
+ */
+uint32_t trace_log_get_dropped(void);
+
+#else
+
+#define TRACE_F(v)                  0
+#define TRACE_LOG(ev, ...)          do { (void)(ev); } while (0)
+
+static inline void trace_log_write(trace_event_t event, uint8_t nargs, const int32_t *args) { (void)event; (void)nargs; (void)args; }
+static inline esp_err_t trace_log_start(void) { return ESP_OK; }
+static inline uint32_t trace_log_get_dropped(void) { return 0; }
+
+#endif /* TRACE_LOG_ENABLE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TRACE_LOG_H__ */
@@ -32,7 +32,10 @@
 #include "freertos/semphr.h"
 #include "esp_face_detection.hpp"
 #include "face_distance_c_interface.h"
-#include "image_scaler.h"
+#include "lcd_preview.h"
+#include "latency_hist.h"
+#include "trace_log.h"
+#include "persist_store.h"
 #include "buzzer.h"
 #include "photo_uploader.h"
 #include "system_state_manager.h"
@@ -40,10 +43,6 @@
 
 
 i2c_obj_t i2c0_master;
-unsigned long x_i = 0;
-unsigned long x_j = 0;
-extern QueueHandle_t xQueueAIFrameO;
-camera_fb_t *face_ai_frameO = NULL;
 
 // 全局变量存储最新的眼部坐标
 int g_left_eye_x = -1, g_left_eye_y = -1;
@@ -67,112 +66,6 @@ void safe_watchdog_reset(void)
     }
 }
 
-/**
- * @brief       人脸识别（RGB565）带缩放显示
- * @param       x:x轴坐标
- * @param       y:y轴坐标
- * @retval      无
- */
-void lcd_human_detection_camera(uint16_t x, uint16_t y)
-{
-    /* 使用非阻塞方式接收队列，避免主任务被长时间阻塞导致看门狗超时 */
-    if (xQueueReceive(xQueueAIFrameO, &face_ai_frameO, pdMS_TO_TICKS(100))) // 最多等待100ms
-    {
-        // 检查是否允许更新LCD（避免拍照上传期间的SPI冲突）
-        if (!system_can_update_lcd()) {
-            ESP_LOGD("main", "LCD update skipped during photo upload");
-            goto err; // 直接释放帧缓冲，跳过LCD更新
-        }
-        
-        // 目标显示尺寸 - LCD屏幕尺寸
-        int target_width = 320;
-        int target_height = 240;
-        
-        // 检查显示区域是否超出屏幕
-        if (x + target_width > lcd_self.width || y + target_height > lcd_self.height)
-        {
-            goto err;
-        }
-
-        lcd_set_window(x, y, x + target_width - 1, y + target_height - 1);
-
-        // 如果原图像不是320x240，需要缩放
-        if (face_ai_frameO->width != target_width || face_ai_frameO->height != target_height) {
-            
-            // 使用极小的分块缩放，最大限度减少内存使用
-            const int chunk_height = 4;  // 减少到4行，进一步减少内存需求
-            size_t chunk_size = target_width * chunk_height * 2;
-            
-            // 检查内存是否足够
-            uint32_t free_heap = esp_get_free_heap_size();
-            if (free_heap < chunk_size + 20000) { // 预留20KB缓冲
-                ESP_LOGW("main", "Insufficient memory for LCD display: %" PRIu32 " free, %zu needed", 
-                         free_heap, chunk_size + 20000);
-                goto err;
-            }
-            
-            uint16_t* chunk_buf = (uint16_t*)malloc(chunk_size);
-            
-            if (chunk_buf) {
-                for (int y_chunk = 0; y_chunk < target_height; y_chunk += chunk_height) {
-                    int current_chunk_height = (y_chunk + chunk_height > target_height) ? 
-                                             (target_height - y_chunk) : chunk_height;
-                    
-                    // 创建临时缓冲区用于一块的缩放
-                    for (int i = 0; i < current_chunk_height; i++) {
-                        for (int j = 0; j < target_width; j++) {
-                            // 计算源图像中对应的像素位置
-                            int src_x = (j * face_ai_frameO->width) / target_width;
-                            int src_y = ((y_chunk + i) * face_ai_frameO->height) / target_height;
-                            
-                            // 边界检查
-                            if (src_x >= face_ai_frameO->width) src_x = face_ai_frameO->width - 1;
-                            if (src_y >= face_ai_frameO->height) src_y = face_ai_frameO->height - 1;
-                            
-                            chunk_buf[i * target_width + j] = 
-                                ((uint16_t*)face_ai_frameO->buf)[src_y * face_ai_frameO->width + src_x];
-                        }
-                    }
-                    
-                    // 发送这一块数据到LCD
-                    lcd_write_data((uint8_t*)chunk_buf, target_width * current_chunk_height * 2);
-                }
-                
-                free(chunk_buf);
-            } else {
-                ESP_LOGE("main", "Failed to allocate chunk buffer (%zu bytes)", chunk_size);
-                goto err;
-            }
-        } else {
-            // 不需要缩放，直接显示
-            /* lcd_buf存储摄像头整一帧RGB数据 */
-            for (x_j = 0; x_j < face_ai_frameO->width * face_ai_frameO->height; x_j++)
-            {
-                lcd_buf[2 * x_j] = (face_ai_frameO->buf[2 * x_i]) ;
-                lcd_buf[2 * x_j + 1] =  (face_ai_frameO->buf[2 * x_i + 1]);
-                x_i ++;
-            }
-            
-            /* 例如：96*96*2/1536 = 12;分12次发送RGB数据 */
-            for (x_j = 0; x_j < (face_ai_frameO->width * face_ai_frameO->height * 2 / LCD_BUF_SIZE); x_j++)
-            {
-                /* &lcd_buf[j * LCD_BUF_SIZE] 偏移地址发送数据 */
-                lcd_write_data(&lcd_buf[x_j * LCD_BUF_SIZE] , LCD_BUF_SIZE);
-            }
-        }
-        
-err:
-        esp_camera_fb_return(face_ai_frameO);
-        x_i = 0;
-        face_ai_frameO = NULL;
-    }
-    else
-    {
-        /* 队列接收超时，可能是拍照期间或系统繁忙，不需要特殊处理 */
-        ESP_LOGV("main", "No frame available from AI queue (timeout)");
-    }
-}
-
 /**
  * @brief       程序入口
  * @param       无
@@ -180,7 +73,7 @@ err:
  */
 void app_main(void)
 {
-    uint8_t x = 0;
+    uint32_t x = 0;
     esp_err_t ret;
     
     ret = nvs_flash_init();  /* 初始化NVS */
@@ -191,6 +84,11 @@ void app_main(void)
         ret = nvs_flash_init();
     }
 
+    /* 标定与设置的写入由后台任务合并提交，AI任务不等待Flash */
+    if (persist_init() != ESP_OK) {
+        ESP_LOGE("main", "Failed to start persist store");
+    }
+
     led_init();                 /* 初始化LED */
     i2c0_master = iic_init(I2C_NUM_0);   /* 初始化IIC0 */
     spi2_init();                /* 初始化SPI2 */
@@ -199,6 +97,11 @@ void app_main(void)
     
     lcd_init();                 /* 初始化LCD */
     
+    /* 分配LCD预览常驻的DMA乒乓缓冲区及分块状态 */
+    if (lcd_preview_init() != ESP_OK) {
+        ESP_LOGE("main", "Failed to initialize LCD preview");
+    }
+    
     lcd_show_string(30, 50, 200, 16, 16, "ESP32S3", RED);
     lcd_show_string(30, 70, 200, 16, 16, "FACED DETECTIOIN TEST", RED);
     lcd_show_string(30, 90, 200, 16, 16, "ATOM@ALIENTEK", RED);
@@ -232,6 +135,17 @@ void app_main(void)
         vTaskDelay(500);
     }
 
+    /* 创建显示任务，从AI任务投递的信箱中取最新帧显示在屏幕左上角 */
+    if (lcd_preview_start_task(0, 0) != ESP_OK) {
+        ESP_LOGE("main", "Failed to start LCD preview task");
+    }
+
+    /* 串口发送'p'输出各级延迟分位数（关闭LATENCY_PROFILE_ENABLE时为空操作） */
+    latency_hist_console_start();
+
+    /* 热路径的调试事件写入每核二进制环，由低优先级任务统一格式化输出 */
+    trace_log_start();
+
     /* 初始化距离检测系统 */
     if (init_distance_detection_system() != ESP_OK) {
         ESP_LOGE("main", "Failed to initialize distance detection system");
@@ -278,13 +192,7 @@ void app_main(void)
 
     while (1)
     {
-        /* 定期喂看门狗 - 使用安全方法 */
-        safe_watchdog_reset();
-        
-        /* 系统状态管理任务处理 - 处理拍照上传等异步任务 */
-        system_state_task_handler();
-        
-        /* 处理完系统状态后重置看门狗 */
+        /* 定期喂看门狗 - 使用安全方法（拍照上传由状态管理任务按事件处理，不在主循环中轮询） */
         safe_watchdog_reset();
         
         /* 检查可用内存 */
@@ -296,20 +204,15 @@ void app_main(void)
             continue;
         }
         
-        /* 处理图像 - 显示在屏幕中央 */
-        lcd_human_detection_camera(0, 0);
-        
-        /* LCD处理完成后重置看门狗 */
-        safe_watchdog_reset();
-        
         x++;
 
+        /* 主循环每10ms运行一次，画面显示由独立的显示任务完成 */
         if (x % 20 == 0)
         {
             LED_TOGGLE();
         }
 
-        /* 每100帧检查一次WiFi连接状态并更新LCD显示 */
+        /* 每1秒检查一次WiFi连接状态并更新LCD显示 */
         if (x % 100 == 0) {
             static bool last_wifi_status = false;
             bool current_wifi_status = wifi_is_connected();
@@ -318,21 +221,29 @@ void app_main(void)
             if (current_wifi_status != last_wifi_status) {
                 if (current_wifi_status) {
                     printf("WiFi Status: Connected\r\n");
-                    // 在LCD底部显示WiFi状态
-                    lcd_show_string(10, 220, 100, 16, 12, "WiFi: OK", GREEN);
+                    // 在LCD底部显示WiFi状态（与显示任务互斥访问LCD）
+                    if (lcd_preview_lock(100)) {
+                        lcd_show_string(10, 220, 100, 16, 12, "WiFi: OK", GREEN);
+                        lcd_preview_invalidate();
+                        lcd_preview_unlock();
+                    }
                 } else {
                     printf("WiFi Status: Disconnected - Reconnecting...\r\n");
-                    lcd_show_string(10, 220, 100, 16, 12, "WiFi: --", RED);
+                    if (lcd_preview_lock(100)) {
+                        lcd_show_string(10, 220, 100, 16, 12, "WiFi: --", RED);
+                        lcd_preview_invalidate();
+                        lcd_preview_unlock();
+                    }
                 }
                 last_wifi_status = current_wifi_status;
             }
         }
 
         /* 每5秒检查一次距离检测状态 */
-        if (x % 5000 == 0 && is_distance_calibrated()) {
+        if (x % 500 == 0 && is_distance_calibrated()) {
             printf("Distance monitoring active... (Press reset to recalibrate)\r\n");
         }
 
-        vTaskDelay(1);
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
@@ -3,6 +3,7 @@ import datetime
 import subprocess
 from flask import Flask, render_template, request, send_from_directory
 from flask_socketio import SocketIO
+from werkzeug.serving import WSGIRequestHandler
 
 # --- 初始化 ---
 app = Flask(__name__)
@@ -145,4 +146,6 @@ def handle_connect():
 # --- 运行服务器 ---
 if __name__ == '__main__':
     print("数据看板服务器启动于 http://0.0.0.0:5001")
+    # 开发服务器默认HTTP/1.0，每个请求后关闭连接；改为HTTP/1.1，设备可复用同一连接上传
+    WSGIRequestHandler.protocol_version = "HTTP/1.1"
     socketio.run(app, host='0.0.0.0', port=5001)
\ No newline at end of file
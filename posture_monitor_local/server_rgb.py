@@ -9,6 +9,7 @@ import datetime
 import subprocess
 from flask import Flask, render_template, request, send_from_directory
 from flask_socketio import SocketIO
+from werkzeug.serving import WSGIRequestHandler
 
 # --- 初始化 ---
 app = Flask(__name__)
@@ -162,4 +163,6 @@ def handle_connect():
 if __name__ == '__main__':
     print("🚀 智能图像处理服务器启动于 http://0.0.0.0:5001")
     print("📷 支持格式: JPEG, RGB565")
+    # 开发服务器默认HTTP/1.0，每个请求后关闭连接；改为HTTP/1.1，设备可复用同一连接上传
+    WSGIRequestHandler.protocol_version = "HTTP/1.1"
     socketio.run(app, host='0.0.0.0', port=5001)
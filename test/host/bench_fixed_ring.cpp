@@ -0,0 +1,60 @@
+// FixedRing主机基准：每帧写入一个距离并取均值，对比改动前face_distance_detector的std::queue实现
+// （每帧push/pop，再复制整个队列求和两次：getSmoothedDistance与getCurrentDistance各一次）
+#include "fixed_ring.hpp"
+#include <chrono>
+#include <cstdio>
+#include <queue>
+#include <random>
+#include <vector>
+
+static constexpr size_t WINDOW = 7;            // 与FaceDistanceDetector::FILTER_QUEUE_SIZE一致
+static constexpr int FRAMES = 2000000;
+
+static float queue_mean(const std::queue<float>& q)
+{
+    float sum = 0.0f;
+    std::queue<float> temp = q;
+
+    while (!temp.empty()) {
+        sum += temp.front();
+        temp.pop();
+    }
+    return sum / q.size();
+}
+
+int main()
+{
+    std::vector<float> input(FRAMES);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(30.0f, 70.0f);
+    for (float& v : input) {
+        v = dist(rng);
+    }
+
+    volatile float sink = 0.0f;
+    auto t0 = std::chrono::steady_clock::now();
+    std::queue<float> q;
+    for (float v : input) {
+        q.push(v);
+        while (q.size() > WINDOW) {
+            q.pop();
+        }
+        sink = queue_mean(q);
+        sink = queue_mean(q);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    FixedRing<float, WINDOW> ring;
+    for (float v : input) {
+        ring.push(v);
+        sink = ring.mean();
+        sink = ring.mean();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    (void)sink;
+
+    double old_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / FRAMES;
+    double new_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / FRAMES;
+    std::printf("window %zu: std::queue copy %.1f ns/frame, FixedRing %.1f ns/frame (%.1fx)\n",
+                WINDOW, old_ns, new_ns, old_ns / new_ns);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/* LCD预览最近邻缩放主机基准：改动前lcd_human_detection_camera()内联的逐像素整数除法循环
+ * 对比缓存映射表的scale_rgb565_nearest_rows，单位为每微秒输出像素数；计时前先核对两者输出一致 */
+#include "image_scaler.h"
+#include "lcd_preview.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MIN_US        200000      /* 每种情况至少运行的时长 */
+#define BENCH_BAND_ROWS     LCD_TILE_SIZE   /* 与LCD预览的条带高度一致 */
+#define BENCH_OLD_CHUNK     4               /* 改动前预览每次缩放并发送的行数 */
+
+/* 改动前的预览缩放：每个像素两次除法加边界检查，按4行分块写入（此处省去lcd_write_data） */
+static void old_preview_scale(const uint16_t *src, int sw, int sh, uint16_t *dst, int dw, int dh)
+{
+    for (int y_chunk = 0; y_chunk < dh; y_chunk += BENCH_OLD_CHUNK) {
+        int chunk_rows = (y_chunk + BENCH_OLD_CHUNK > dh) ? (dh - y_chunk) : BENCH_OLD_CHUNK;
+        uint16_t *chunk_buf = dst + (size_t)y_chunk * dw;
+
+        for (int i = 0; i < chunk_rows; i++) {
+            for (int j = 0; j < dw; j++) {
+                int src_x = (j * sw) / dw;
+                int src_y = ((y_chunk + i) * sh) / dh;
+
+                if (src_x >= sw) src_x = sw - 1;
+                if (src_y >= sh) src_y = sh - 1;
+
+                chunk_buf[i * dw + j] = src[src_y * sw + src_x];
+            }
+        }
+    }
+}
+
+static int bench_case(int sw, int sh, int dw, int dh)
+{
+    uint16_t *src = malloc((size_t)sw * sh * sizeof(uint16_t));
+    uint16_t *ref = malloc((size_t)dw * dh * sizeof(uint16_t));
+    uint16_t *out = malloc((size_t)dw * dh * sizeof(uint16_t));
+    rgb565_scale_map_t map = {0};
+    int iters;
+    int64_t t0, t1;
+
+    for (int i = 0; i < sw * sh; i++) {
+        src[i] = (uint16_t)(i * 2654435761u >> 16);
+    }
+
+    /* 首帧：建表 */
+    t0 = esp_timer_get_time();
+    rgb565_scale_map_prepare(&map, sw, sh, dw, dh);
+    t1 = esp_timer_get_time();
+    int64_t prepare_us = t1 - t0;
+
+    old_preview_scale(src, sw, sh, ref, dw, dh);
+    for (int y = 0; y < dh; y += BENCH_BAND_ROWS) {
+        int rows = dh - y < BENCH_BAND_ROWS ? dh - y : BENCH_BAND_ROWS;
+        scale_rgb565_nearest_rows(&map, src, out + (size_t)y * dw, y, rows);
+    }
+    int same = memcmp(ref, out, (size_t)dw * dh * sizeof(uint16_t)) == 0;
+
+    iters = 0;
+    t0 = esp_timer_get_time();
+    do {
+        old_preview_scale(src, sw, sh, out, dw, dh);
+        iters++;
+        t1 = esp_timer_get_time();
+    } while (t1 - t0 < BENCH_MIN_US);
+    double old_px_us = (double)iters * dw * dh / (double)(t1 - t0);
+
+    /* 按条带调用，与LCD预览一致；映射表已缓存，每帧只做一次尺寸比较 */
+    iters = 0;
+    t0 = esp_timer_get_time();
+    do {
+        rgb565_scale_map_prepare(&map, sw, sh, dw, dh);
+        for (int y = 0; y < dh; y += BENCH_BAND_ROWS) {
+            int rows = dh - y < BENCH_BAND_ROWS ? dh - y : BENCH_BAND_ROWS;
+            scale_rgb565_nearest_rows(&map, src, out + (size_t)y * dw, y, rows);
+        }
+        iters++;
+        t1 = esp_timer_get_time();
+    } while (t1 - t0 < BENCH_MIN_US);
+    double new_px_us = (double)iters * dw * dh / (double)(t1 - t0);
+
+    printf("%4dx%-4d -> %4dx%-4d  old %7.1f px/us  new %7.1f px/us  (%4.1fx, map build %lld us)%s\n",
+           sw, sh, dw, dh, old_px_us, new_px_us, new_px_us / old_px_us, (long long)prepare_us,
+           same ? "" : "  OUTPUT MISMATCH");
+
+    rgb565_scale_map_release(&map);
+    free(src);
+    free(ref);
+    free(out);
+    return same ? 0 : 1;
+}
+
+int main(void)
+{
+    int bad = 0;
+
+    /* 320x240帧走原生路径不经缩放，这里只测需要缩放到预览窗口的帧尺寸 */
+    bad |= bench_case(640, 480, LCD_PREVIEW_WIDTH, LCD_PREVIEW_HEIGHT);    /* VGA -> LCD预览 */
+    bad |= bench_case(800, 600, LCD_PREVIEW_WIDTH, LCD_PREVIEW_HEIGHT);    /* SVGA -> LCD预览 */
+    bad |= bench_case(160, 120, LCD_PREVIEW_WIDTH, LCD_PREVIEW_HEIGHT);    /* 放大：重复行走memcpy */
+    return bad;
+}
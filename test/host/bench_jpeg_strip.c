@@ -0,0 +1,46 @@
+/* jpeg_strip主机基准：800x600 RGB565整帧fmt2jpg与分条编码的帧率对比（编码器为libjpeg替身，
+ * 绝对值不代表ESP32-S3，只看两条路径的相对开销与双线程收益） */
+#include "jpeg_strip.h"
+#include "img_converters.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_WIDTH                 800
+#define BENCH_HEIGHT                600
+#define BENCH_ITERATIONS            50
+#define BENCH_QUALITY               80
+
+int main(void)
+{
+    size_t len = (size_t)BENCH_WIDTH * BENCH_HEIGHT * 2;
+    uint8_t *src = malloc(len);
+    uint8_t *out;
+    size_t out_len;
+
+    for (size_t i = 0; i < len; i++) {
+        src[i] = (uint8_t)(i * 7 ^ i >> 9);
+    }
+    jpeg_strip_init(BENCH_QUALITY);
+
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        fmt2jpg(src, len, BENCH_WIDTH, BENCH_HEIGHT, PIXFORMAT_RGB565, BENCH_QUALITY, &out, &out_len);
+        free(out);
+    }
+    int64_t t1 = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        jpeg_strip_encode(src, len, BENCH_WIDTH, BENCH_HEIGHT, BENCH_QUALITY, &out, &out_len);
+        free(out);
+    }
+    int64_t t2 = esp_timer_get_time();
+
+    jpeg_strip_stats_t st;
+    jpeg_strip_get_stats(&st);
+    printf("%dx%d q%d: whole %.1f frames/s, strips %.1f frames/s (worker encoded %u of %u strips)\n",
+           BENCH_WIDTH, BENCH_HEIGHT, BENCH_QUALITY,
+           BENCH_ITERATIONS * 1e6 / (double)(t1 - t0), BENCH_ITERATIONS * 1e6 / (double)(t2 - t1),
+           st.worker_strips, st.strips);
+    free(src);
+    return 0;
+}
@@ -0,0 +1,19 @@
+#ifndef __HOST_CHECK_H__
+#define __HOST_CHECK_H__
+
+#include <stdio.h>
+
+/* 失败时打印位置并计数，测试结束时以失败数作为退出码 */
+static int s_check_failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            s_check_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_RESULT() (s_check_failures ? (fprintf(stderr, "%d check(s) failed\n", s_check_failures), 1) : 0)
+
+#endif /* __HOST_CHECK_H__ */
@@ -0,0 +1,160 @@
+// 距离滤波回放：把录制/合成的距离轨迹依次送入三种滤波器，按检测器的进入/退出阈值做状态判决，
+// 统计每次靠近的报警延迟与误报次数
+//   replay_distance_filter [--check] trace.csv...
+// --check时按下方的验收条件返回非0，供ctest使用
+#include "distance_filter.hpp"
+#include "face_distance_c_interface.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 与FaceDistanceDetector中的取值一致
+static constexpr float ENTER_THRESHOLD_CM = 45.0f;
+static constexpr float EXIT_THRESHOLD_CM = 48.0f;
+static constexpr size_t FILTER_QUEUE_SIZE = 7;
+static constexpr float ONE_EURO_MIN_CUTOFF_HZ = 0.3f;
+static constexpr float ONE_EURO_BETA = 0.005f;
+static constexpr float ONE_EURO_D_CUTOFF_HZ = 0.5f;
+static constexpr float KALMAN_ACCEL_VAR = 50.0f;
+static constexpr float KALMAN_MEAS_VAR = 9.0f;
+
+// 验收条件：不漏报，无误报，报警延迟不超过此值；
+// 上电默认滤波器在每条轨迹上的平均报警延迟不得比滑动平均更长
+static constexpr double MAX_LATENCY_MS = 1500.0;
+
+struct Sample {
+    int64_t timestamp_us;
+    float raw_cm;
+    float truth_cm;
+};
+
+struct Result {
+    int approaches = 0;         // 真实距离从阈值外进入阈值内的次数
+    int detected = 0;           // 其中在真实距离退出前报警的次数
+    int false_triggers = 0;     // 真实距离不小于退出阈值时进入报警的次数
+    double latency_sum_ms = 0.0;
+    double latency_max_ms = 0.0;
+};
+
+static bool load_trace(const char* path, std::vector<Sample>& samples)
+{
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+
+    char line[256];
+    while (std::fgets(line, sizeof(line), f)) {
+        Sample s;
+        long long t;
+        if (line[0] == '#' || std::sscanf(line, "%lld,%f,%f", &t, &s.raw_cm, &s.truth_cm) != 3) {
+            continue;
+        }
+        s.timestamp_us = t;
+        samples.push_back(s);
+    }
+    std::fclose(f);
+    return !samples.empty();
+}
+
+static Result replay(DistanceFilter& filter, const std::vector<Sample>& samples)
+{
+    Result r;
+    bool alarm = false;
+    bool truth_close = false;
+    bool pending = false;       // 本次靠近尚未报警
+    int64_t approach_us = 0;
+
+    filter.reset();
+    for (const Sample& s : samples) {
+        // 真值：与检测器相同的迟滞，避免在阈值附近抖动被算作多次靠近
+        if (!truth_close && s.truth_cm < ENTER_THRESHOLD_CM) {
+            truth_close = true;
+            r.approaches++;
+            approach_us = s.timestamp_us;
+            pending = true;
+        } else if (truth_close && s.truth_cm > EXIT_THRESHOLD_CM) {
+            truth_close = false;
+            pending = false;
+        }
+
+        float d = filter.update(s.raw_cm, s.timestamp_us);
+        if (!alarm && d < ENTER_THRESHOLD_CM) {
+            alarm = true;
+            if (s.truth_cm >= EXIT_THRESHOLD_CM) {
+                r.false_triggers++;
+            }
+        } else if (alarm && d > EXIT_THRESHOLD_CM) {
+            alarm = false;
+        }
+
+        if (pending && alarm) {
+            double latency_ms = (s.timestamp_us - approach_us) / 1000.0;
+            r.detected++;
+            r.latency_sum_ms += latency_ms;
+            r.latency_max_ms = std::max(r.latency_max_ms, latency_ms);
+            pending = false;
+        }
+    }
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    bool check = false;
+    int failures = 0;
+
+    MovingAverageFilter<FILTER_QUEUE_SIZE> moving_average;
+    OneEuroFilter one_euro(ONE_EURO_MIN_CUTOFF_HZ, ONE_EURO_BETA, ONE_EURO_D_CUTOFF_HZ);
+    KalmanCvFilter kalman(KALMAN_ACCEL_VAR, KALMAN_MEAS_VAR);
+    // 按face_distance_filter_t顺序排列
+    struct {
+        const char* name;
+        DistanceFilter* filter;
+    } filters[FACE_DISTANCE_FILTER_COUNT] = {
+        {"moving_average", &moving_average},
+        {"one_euro", &one_euro},
+        {"kalman_cv", &kalman},
+    };
+
+    std::printf("%-24s %-15s %9s %8s %12s %12s %6s\n",
+                "trace", "filter", "approach", "detected", "mean_lat_ms", "max_lat_ms", "false");
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--check") == 0) {
+            check = true;
+            continue;
+        }
+
+        std::vector<Sample> samples;
+        if (!load_trace(argv[i], samples)) {
+            failures++;
+            continue;
+        }
+        std::string name = argv[i];
+        name = name.substr(name.find_last_of('/') + 1);
+
+        double mean_ms[FACE_DISTANCE_FILTER_COUNT];
+        for (int k = 0; k < FACE_DISTANCE_FILTER_COUNT; k++) {
+            Result r = replay(*filters[k].filter, samples);
+            mean_ms[k] = r.detected ? r.latency_sum_ms / r.detected : 0.0;
+            std::printf("%-24s %-15s %9d %8d %12.0f %12.0f %6d\n", name.c_str(), filters[k].name,
+                        r.approaches, r.detected, mean_ms[k], r.latency_max_ms, r.false_triggers);
+            if (r.detected != r.approaches || r.false_triggers != 0 || r.latency_max_ms > MAX_LATENCY_MS) {
+                failures++;
+            }
+        }
+
+        if (mean_ms[FACE_DISTANCE_FILTER_DEFAULT] > mean_ms[FACE_DISTANCE_FILTER_MOVING_AVG]) {
+            std::printf("%-24s default filter %s is slower than moving_average (%.0f > %.0f ms)\n",
+                        name.c_str(), filters[FACE_DISTANCE_FILTER_DEFAULT].name,
+                        mean_ms[FACE_DISTANCE_FILTER_DEFAULT], mean_ms[FACE_DISTANCE_FILTER_MOVING_AVG]);
+            failures++;
+        }
+    }
+
+    return check && failures ? 1 : 0;
+}
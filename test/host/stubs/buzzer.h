@@ -0,0 +1,17 @@
+#ifndef __HOST_BUZZER_H__
+#define __HOST_BUZZER_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* BSP蜂鸣器，主机测试中由测试程序实现并记录调用 */
+void buzzer_alarm(uint8_t on);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_BUZZER_H__ */
@@ -0,0 +1,22 @@
+#ifndef __HOST_ESP_HEAP_CAPS_H__
+#define __HOST_ESP_HEAP_CAPS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT             (1 << 2)
+#define MALLOC_CAP_DMA              (1 << 3)
+#define MALLOC_CAP_SPIRAM           (1 << 10)
+#define MALLOC_CAP_INTERNAL         (1 << 11)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_ESP_HEAP_CAPS_H__ */
@@ -0,0 +1,16 @@
+#ifndef __HOST_ESP_ROM_CRC_H__
+#define __HOST_ESP_ROM_CRC_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_ESP_ROM_CRC_H__ */
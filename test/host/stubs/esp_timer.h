@@ -0,0 +1,16 @@
+#ifndef __HOST_ESP_TIMER_H__
+#define __HOST_ESP_TIMER_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_ESP_TIMER_H__ */
@@ -0,0 +1,7 @@
+#ifndef __HOST_ESP_WIFI_H__
+#define __HOST_ESP_WIFI_H__
+
+/* photo_uploader.h会包含此头文件，主机测试不使用其中的声明 */
+#include "esp_err.h"
+
+#endif /* __HOST_ESP_WIFI_H__ */
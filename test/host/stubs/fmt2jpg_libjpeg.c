@@ -0,0 +1,62 @@
+/* 用libjpeg代替esp32-camera的fmt2jpg：基线顺序编码、4:2:0、标准哈夫曼表，不带复位标记，
+ * 输出结构（SOI、DQT/DHT、SOF0、SOS、熵编码数据、EOI）与jpge一致，足以检验分条拼接 */
+#include "img_converters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jpeglib.h>
+
+bool fmt2jpg(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format,
+             uint8_t quality, uint8_t **out, size_t *out_len)
+{
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    unsigned char *mem = NULL;
+    unsigned long mem_len = 0;
+
+    if (format != PIXFORMAT_RGB565 || src_len < (size_t)width * height * 2) {
+        return false;
+    }
+
+    uint8_t *line = malloc((size_t)width * 3);
+    if (!line) {
+        return false;
+    }
+
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &mem, &mem_len);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    for (uint16_t y = 0; y < height; y++) {
+        const uint8_t *row = src + (size_t)y * width * 2;
+        for (uint16_t x = 0; x < width; x++) {
+            uint16_t px = (uint16_t)(row[x * 2] << 8 | row[x * 2 + 1]);     /* 大端RGB565 */
+            line[x * 3] = (uint8_t)((px >> 8) & 0xF8);
+            line[x * 3 + 1] = (uint8_t)((px >> 3) & 0xFC);
+            line[x * 3 + 2] = (uint8_t)((px << 3) & 0xF8);
+        }
+        JSAMPROW rowp = line;
+        jpeg_write_scanlines(&cinfo, &rowp, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    free(line);
+
+    *out = malloc(mem_len);
+    if (!*out) {
+        free(mem);
+        return false;
+    }
+    memcpy(*out, mem, mem_len);
+    *out_len = mem_len;
+    free(mem);
+    return true;
+}
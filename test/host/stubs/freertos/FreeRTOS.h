@@ -0,0 +1,19 @@
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE                      1
+#define pdFALSE                     0
+#define pdPASS                      1
+#define pdFAIL                      0
+#define portMAX_DELAY               0xffffffffu
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms))
+
+#endif /* __HOST_FREERTOS_H__ */
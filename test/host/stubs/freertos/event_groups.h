@@ -0,0 +1,7 @@
+#ifndef __HOST_FREERTOS_EVENT_GROUPS_H__
+#define __HOST_FREERTOS_EVENT_GROUPS_H__
+
+/* photo_uploader.h会包含此头文件，主机测试不使用其中的声明 */
+#include "freertos/FreeRTOS.h"
+
+#endif /* __HOST_FREERTOS_EVENT_GROUPS_H__ */
@@ -0,0 +1,21 @@
+#ifndef __HOST_FREERTOS_SEMPHR_H__
+#define __HOST_FREERTOS_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_FREERTOS_SEMPHR_H__ */
@@ -0,0 +1,22 @@
+#ifndef __HOST_FREERTOS_TASK_H__
+#define __HOST_FREERTOS_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core);
+BaseType_t xTaskNotifyGive(TaskHandle_t handle);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_FREERTOS_TASK_H__ */
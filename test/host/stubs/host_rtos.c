@@ -0,0 +1,182 @@
+/* 在pthread上实现被测模块用到的FreeRTOS/ESP-IDF接口 */
+#include "host_rtos.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned count;
+} host_sem_t;
+
+typedef struct {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+} host_task_t;
+
+static pthread_mutex_t s_notify_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_notify_cond = PTHREAD_COND_INITIALIZER;
+static unsigned s_notify_count;     /* 所有任务共用一个通知计数：被测模块只创建一个任务 */
+static bool s_hold;
+
+static host_sem_t *host_sem_create(unsigned count)
+{
+    host_sem_t *sem = calloc(1, sizeof(*sem));
+
+    if (sem) {
+        pthread_mutex_init(&sem->mutex, NULL);
+        pthread_cond_init(&sem->cond, NULL);
+        sem->count = count;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return host_sem_create(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return host_sem_create(0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks)
+{
+    host_sem_t *sem = handle;
+
+    (void)ticks;
+    pthread_mutex_lock(&sem->mutex);
+    while (sem->count == 0) {
+        pthread_cond_wait(&sem->cond, &sem->mutex);
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->mutex);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle)
+{
+    host_sem_t *sem = handle;
+
+    /* 二值信号量与互斥量的计数都不超过1 */
+    pthread_mutex_lock(&sem->mutex);
+    sem->count = 1;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+    return pdTRUE;
+}
+
+static void *host_task_entry(void *arg)
+{
+    host_task_t *task = arg;
+
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core)
+{
+    host_task_t *task = calloc(1, sizeof(*task));
+
+    (void)name;
+    (void)stack;
+    (void)prio;
+    (void)core;
+    if (!task) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    if (pthread_create(&task->thread, NULL, host_task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    (void)handle;
+    pthread_mutex_lock(&s_notify_mutex);
+    s_notify_count++;
+    pthread_cond_broadcast(&s_notify_cond);
+    pthread_mutex_unlock(&s_notify_mutex);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    uint32_t value;
+
+    (void)ticks;
+    pthread_mutex_lock(&s_notify_mutex);
+    while (s_notify_count == 0 || s_hold) {
+        pthread_cond_wait(&s_notify_cond, &s_notify_mutex);
+    }
+    value = s_notify_count;
+    s_notify_count = clear ? 0 : s_notify_count - 1;
+    pthread_mutex_unlock(&s_notify_mutex);
+    return value;
+}
+
+void host_rtos_hold_tasks(bool hold)
+{
+    pthread_mutex_lock(&s_notify_mutex);
+    s_hold = hold;
+    pthread_cond_broadcast(&s_notify_cond);
+    pthread_mutex_unlock(&s_notify_mutex);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    default:                    return "ESP_ERR";
+    }
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len)
+{
+    /* 与ROM实现相同：反射多项式0xEDB88320，输入输出取反 */
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,21 @@
+#ifndef __HOST_RTOS_H__
+#define __HOST_RTOS_H__
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief       扣住/放开被创建的任务：扣住期间任务收到通知也不运行，模拟其所在核被高优先级任务占满
+ * @param       hold: true扣住, false放开
+ * @retval      无
+ */
+void host_rtos_hold_tasks(bool hold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_RTOS_H__ */
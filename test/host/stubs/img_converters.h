@@ -0,0 +1,19 @@
+#ifndef __HOST_IMG_CONVERTERS_H__
+#define __HOST_IMG_CONVERTERS_H__
+
+#include <stdbool.h>
+#include "esp_camera.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 主机上由fmt2jpg_libjpeg.c用libjpeg实现：基线、4:2:0、标准表，与esp32-camera的jpge输出结构一致 */
+bool fmt2jpg(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format,
+             uint8_t quality, uint8_t **out, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_IMG_CONVERTERS_H__ */
@@ -0,0 +1,9 @@
+#ifndef __HOST_NVS_H__
+#define __HOST_NVS_H__
+
+#include "esp_err.h"
+
+#define ESP_ERR_NVS_BASE            0x1100
+#define ESP_ERR_NVS_NOT_FOUND       (ESP_ERR_NVS_BASE + 0x02)
+
+#endif /* __HOST_NVS_H__ */
@@ -0,0 +1,233 @@
+/* 人脸距离C接口主机测试：用C代码构造face_result_batch_t，经face_distance_c_interface走完
+ * 标定、过近报警、恢复安全、人脸离开与重新上电加载标定；蜂鸣器、系统状态与持久化由本文件的替身记录 */
+#include "face_distance_c_interface.h"
+#include "persist_store.h"
+#include "system_state_manager.h"
+#include "buzzer.h"
+#include "nvs.h"
+#include "host_check.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- 替身：记录检测器对外的调用 ---- */
+
+static int s_buzzer = -1;
+static int s_buzzer_calls;
+static int s_upload_requests;
+static int s_alarm_timeouts;
+static uint32_t s_alarm_timeout_ms;
+
+void buzzer_alarm(uint8_t on)
+{
+    s_buzzer = on;
+    s_buzzer_calls++;
+}
+
+void system_request_photo_upload(void)
+{
+    s_upload_requests++;
+}
+
+void system_start_alarm_timeout(uint32_t timeout_ms)
+{
+    s_alarm_timeouts++;
+    s_alarm_timeout_ms = timeout_ms;
+}
+
+void system_stop_alarm_timeout(void)
+{
+    s_alarm_timeouts--;
+}
+
+/* 内存中的键值存储，模拟写入后可读回的NVS */
+#define FAKE_PERSIST_SLOTS  8
+
+static struct {
+    char ns[16];
+    char key[16];
+    uint8_t data[64];
+    size_t len;
+} s_persist[FAKE_PERSIST_SLOTS];
+
+static int persist_find(const char *ns, const char *key, int create)
+{
+    for (int i = 0; i < FAKE_PERSIST_SLOTS; i++) {
+        if (s_persist[i].len && !strcmp(s_persist[i].ns, ns) && !strcmp(s_persist[i].key, key)) {
+            return i;
+        }
+    }
+    for (int i = 0; create && i < FAKE_PERSIST_SLOTS; i++) {
+        if (!s_persist[i].len) {
+            strncpy(s_persist[i].ns, ns, sizeof(s_persist[i].ns) - 1);
+            strncpy(s_persist[i].key, key, sizeof(s_persist[i].key) - 1);
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t persist_set_blob(const char *ns, const char *key, const void *data, size_t len)
+{
+    int i = persist_find(ns, key, 1);
+    if (i < 0 || len == 0 || len > sizeof(s_persist[i].data)) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(s_persist[i].data, data, len);
+    s_persist[i].len = len;
+    return ESP_OK;
+}
+
+esp_err_t persist_get_blob(const char *ns, const char *key, void *data, size_t *len)
+{
+    int i = persist_find(ns, key, 0);
+    if (i < 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (*len < s_persist[i].len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(data, s_persist[i].data, s_persist[i].len);
+    *len = s_persist[i].len;
+    return ESP_OK;
+}
+
+esp_err_t persist_set_u32(const char *ns, const char *key, uint32_t value)
+{
+    return persist_set_blob(ns, key, &value, sizeof(value));
+}
+
+esp_err_t persist_get_u32(const char *ns, const char *key, uint32_t *value)
+{
+    size_t len = sizeof(*value);
+    return persist_get_blob(ns, key, value, &len);
+}
+
+esp_err_t persist_erase_namespace(const char *ns)
+{
+    for (int i = 0; i < FAKE_PERSIST_SLOTS; i++) {
+        if (s_persist[i].len && !strcmp(s_persist[i].ns, ns)) {
+            memset(&s_persist[i], 0, sizeof(s_persist[i]));
+        }
+    }
+    return ESP_OK;
+}
+
+/* ---- 测试 ---- */
+
+static int64_t s_now_us;
+
+/* 正脸：双眼水平相距eye_px，鼻尖在两眼中垂线上（偏航比例为1） */
+static face_result_batch_t make_batch(int eye_px)
+{
+    face_result_batch_t batch;
+
+    memset(&batch, 0, sizeof(batch));
+    s_now_us += 100000;
+    batch.timestamp_us = s_now_us;
+    batch.count = 1;
+    batch.faces[0].box[0] = 100;
+    batch.faces[0].box[1] = 60;
+    batch.faces[0].box[2] = 100 + eye_px * 2;
+    batch.faces[0].box[3] = 60 + eye_px * 2;
+    batch.faces[0].score = 0.95f;
+    batch.faces[0].has_keypoints = true;
+    int cx = 160, cy = 120;
+    int kp[FACE_RESULT_KEYPOINTS] = {
+        cx - eye_px / 2, cy,                    /* 左眼 */
+        cx - eye_px / 3, cy + eye_px,           /* 左嘴角 */
+        cx, cy + eye_px / 2,                    /* 鼻尖 */
+        cx + eye_px / 2, cy,                    /* 右眼 */
+        cx + eye_px / 3, cy + eye_px,           /* 右嘴角 */
+    };
+    memcpy(batch.faces[0].keypoint, kp, sizeof(kp));
+    return batch;
+}
+
+/* 标定距离50cm时眼距60px，眼距与距离成反比 */
+#define CALIB_EYE_PX    60
+#define EYE_PX_AT(cm)   (CALIB_EYE_PX * 50 / (cm))
+
+static void feed(int eye_px, int frames)
+{
+    for (int i = 0; i < frames; i++) {
+        face_result_batch_t batch = make_batch(eye_px);
+        handle_distance_detection_c(&batch, NULL);
+    }
+}
+
+int main(void)
+{
+    float margin;
+
+    /* 未初始化时各接口安全返回 */
+    handle_distance_detection_c(NULL, NULL);
+    CHECK(!is_distance_calibrated());
+    CHECK(!get_distance_threshold_margin_c(&margin));
+    CHECK(set_distance_filter_c(FACE_DISTANCE_FILTER_ONE_EURO) == ESP_ERR_INVALID_STATE);
+    CHECK(get_distance_filter_c() == FACE_DISTANCE_FILTER_KALMAN);
+
+    CHECK(init_distance_detection_system() == ESP_OK);
+    CHECK(!is_distance_calibrated());
+
+    /* 批次为POD，按值传递后内容不变；未标定时不报警 */
+    face_result_batch_t batch = make_batch(EYE_PX_AT(30));
+    face_result_batch_t copy = batch;
+    handle_distance_detection_c(&batch, NULL);
+    CHECK(memcmp(&batch, &copy, sizeof(batch)) == 0);
+    CHECK(s_buzzer_calls == 0);
+
+    /* 无人脸的批次不计入标定 */
+    start_distance_calibration();
+    face_result_batch_t empty = make_batch(CALIB_EYE_PX);
+    empty.count = 0;
+    handle_distance_detection_c(&empty, NULL);
+    CHECK(!is_distance_calibrated());
+
+    /* 稳定的标定帧在CALIBRATION_MIN_FRAMES帧后收敛 */
+    feed(CALIB_EYE_PX, 20);
+    CHECK(is_distance_calibrated());
+
+    /* 50cm：安全，余量为正 */
+    feed(CALIB_EYE_PX, 10);
+    CHECK(get_distance_threshold_margin_c(&margin));
+    CHECK(margin > 4.0f && margin < 6.0f);
+    CHECK(s_buzzer_calls == 0);
+
+    /* 靠近到35cm：报警、启动3秒超时并请求拍照，只触发一次 */
+    feed(EYE_PX_AT(35), 30);
+    CHECK(s_buzzer == 1 && s_buzzer_calls == 1);
+    CHECK(s_upload_requests == 1);
+    CHECK(s_alarm_timeouts == 1 && s_alarm_timeout_ms == 3000);
+    CHECK(get_distance_threshold_margin_c(&margin) && margin < 0.0f);
+
+    /* 退回60cm：关闭报警并停止超时 */
+    feed(EYE_PX_AT(60), 30);
+    CHECK(s_buzzer == 0 && s_buzzer_calls == 2);
+    CHECK(s_alarm_timeouts == 0);
+
+    /* 报警中人脸离开画面：关闭蜂鸣器 */
+    feed(EYE_PX_AT(35), 30);
+    CHECK(s_buzzer == 1 && s_upload_requests == 2);
+    handle_no_face_detected_c();
+    CHECK(s_buzzer == 0);
+
+    /* 切换滤波器并持久化 */
+    CHECK(set_distance_filter_c(FACE_DISTANCE_FILTER_COUNT) == ESP_ERR_INVALID_ARG);
+    CHECK(set_distance_filter_c(FACE_DISTANCE_FILTER_ONE_EURO) == ESP_OK);
+    CHECK(get_distance_filter_c() == FACE_DISTANCE_FILTER_ONE_EURO);
+
+    /* 重新上电：标定与滤波器选择从持久化存储加载（校验CRC） */
+    deinit_distance_detection_system();
+    CHECK(!is_distance_calibrated());
+    CHECK(init_distance_detection_system() == ESP_OK);
+    CHECK(is_distance_calibrated());
+    CHECK(get_distance_filter_c() == FACE_DISTANCE_FILTER_ONE_EURO);
+
+    /* 重置标定后不再计算距离 */
+    reset_distance_calibration();
+    CHECK(!is_distance_calibrated());
+    CHECK(!get_distance_threshold_margin_c(&margin));
+
+    deinit_distance_detection_system();
+    return CHECK_RESULT();
+}
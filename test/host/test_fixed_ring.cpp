@@ -0,0 +1,149 @@
+// FixedRing主机测试：回绕顺序、淘汰后的最值单调队列、浮点累加和的周期重算，均与逐项暴力计算比较
+#include "fixed_ring.hpp"
+#include "host_check.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+
+// 顺序、最旧/最新值与最值须精确相同
+template <typename T, size_t N>
+static bool matches_order(const FixedRing<T, N>& ring, const std::deque<T>& ref)
+{
+    if (ring.size() != ref.size()) {
+        return false;
+    }
+    if (ref.empty()) {
+        return ring.empty() && ring.sum() == T() && ring.min() == T() && ring.max() == T();
+    }
+    for (size_t i = 0; i < ref.size(); i++) {
+        if (ring[i] != ref[i]) {
+            return false;
+        }
+    }
+    return ring.oldest() == ref.front() && ring.newest() == ref.back() &&
+           ring.min() == *std::min_element(ref.begin(), ref.end()) &&
+           ring.max() == *std::max_element(ref.begin(), ref.end());
+}
+
+// 浮点均值与方差在给定绝对误差内与双精度暴力计算一致
+template <size_t N>
+static bool matches_moments(const FixedRing<float, N>& ring, const std::deque<float>& ref,
+                            double mean_tol, double var_tol)
+{
+    double sum = 0.0, sum_sq = 0.0;
+    for (float v : ref) {
+        sum += v;
+        sum_sq += (double)v * v;
+    }
+    double mean = sum / ref.size();
+    double var = std::max(0.0, sum_sq / ref.size() - mean * mean);
+
+    return std::fabs((double)ring.mean() - mean) <= mean_tol && std::fabs((double)ring.variance() - var) <= var_tol;
+}
+
+template <typename T, size_t N>
+static void push_both(FixedRing<T, N>& ring, std::deque<T>& ref, T v)
+{
+    ring.push(v);
+    ref.push_back(v);
+    if (ref.size() > N) {
+        ref.pop_front();
+    }
+}
+
+static void test_wraparound()
+{
+    FixedRing<int, 4> ring;
+    std::deque<int> ref;
+
+    CHECK(ring.empty() && ring.capacity() == 4);
+    for (int v = 1; v <= 10; v++) {
+        push_both(ring, ref, v);
+        CHECK(matches_order(ring, ref));
+        CHECK(ring.full() == (v >= 4));
+    }
+    /* 写入10次后窗口为7..10，最旧值在槽2 */
+    CHECK(ring[0] == 7 && ring[3] == 10 && ring.sum() == 34 && ring.mean() == 8);
+
+    ring.clear();
+    ref.clear();
+    CHECK(matches_order(ring, ref));
+    push_both(ring, ref, -3);
+    CHECK(matches_order(ring, ref));
+}
+
+static void test_wedge_after_eviction()
+{
+    /* 最值位于最旧槽时被覆盖：单调递减后再递增，每次写入都淘汰当前最小/最大值 */
+    FixedRing<int, 5> ring;
+    std::deque<int> ref;
+    const int pattern[] = {9, 8, 7, 6, 5, 4, 3, 4, 5, 6, 7, 8, 9, 9, 9, 1, 9, 9, 9, 9, 9, 2, 2, 2, 2, 2, 2};
+
+    for (int v : pattern) {
+        push_both(ring, ref, v);
+        CHECK(matches_order(ring, ref));
+    }
+
+    /* 随机小值域序列：大量相等值，检验相等元素的保留与出队 */
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(0, 3);
+    FixedRing<int, 7> ring7;
+    std::deque<int> ref7;
+    for (int i = 0; i < 20000; i++) {
+        push_both(ring7, ref7, dist(rng));
+        CHECK(matches_order(ring7, ref7));
+    }
+}
+
+static void test_resync_drift()
+{
+    /* 大值滑出窗口后，累加和的舍入误差在下一次重算时清零 */
+    FixedRing<float, 8> ring;
+    for (int i = 0; i < 8; i++) {
+        ring.push(1.0e7f);
+    }
+    for (int i = 0; i < 8; i++) {
+        ring.push(0.1f);
+    }
+    float exact = 0.0f;
+    for (int i = 0; i < 8; i++) {
+        exact += 0.1f;
+    }
+    CHECK(ring.mean() == exact / 8.0f);
+    CHECK(ring.variance() < 1e-6f);
+
+    /* 长时间运行：量级跳变的随机序列。每N次写入重算一次后误差回到窗口当前量级的舍入误差；
+     * 其间的误差只取决于最近2N个值的峰值，不随运行时间累积 */
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> small(20.0f, 80.0f);
+    std::uniform_real_distribution<float> large(1.0e4f, 1.0e5f);
+    FixedRing<float, 7> ring7;
+    std::deque<float> ref7;
+    std::deque<float> recent;
+    for (int i = 1; i <= 200000; i++) {
+        float v = (i / 50) % 10 == 0 ? large(rng) : small(rng);
+        push_both(ring7, ref7, v);
+        recent.push_back(v);
+        if (recent.size() > 14) {
+            recent.pop_front();
+        }
+        CHECK(matches_order(ring7, ref7));
+
+        double cur = *std::max_element(ref7.begin(), ref7.end());
+        double peak = *std::max_element(recent.begin(), recent.end());
+        if (i % 7 == 0) {
+            CHECK(matches_moments(ring7, ref7, 1e-6 * cur, 1e-6 * cur * cur));
+        } else {
+            CHECK(matches_moments(ring7, ref7, 1e-6 * peak, 1e-6 * peak * peak));
+        }
+    }
+}
+
+int main()
+{
+    test_wraparound();
+    test_wedge_after_eviction();
+    test_resync_drift();
+    return CHECK_RESULT();
+}
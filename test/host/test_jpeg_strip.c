@@ -0,0 +1,140 @@
+/* jpeg_strip主机测试：分条拼接的JPEG能被桌面解码器(libjpeg)无警告解码，且像素与整帧编码逐字节相同；
+ * 覆盖整帧回退、换质量、辅助任务饿死（调用者独自编完，不等它）三种情况 */
+#include "jpeg_strip.h"
+#include "img_converters.h"
+#include "host_rtos.h"
+#include "host_check.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <jpeglib.h>
+
+typedef struct {
+    uint8_t *rgb;
+    int width;
+    int height;
+    long warnings;
+} decoded_t;
+
+static decoded_t decode(const uint8_t *buf, size_t len)
+{
+    struct jpeg_decompress_struct dinfo;
+    struct jpeg_error_mgr jerr;
+    decoded_t img = {0};
+
+    dinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&dinfo);
+    jpeg_mem_src(&dinfo, buf, len);
+    jpeg_read_header(&dinfo, TRUE);
+    jpeg_start_decompress(&dinfo);
+    img.width = (int)dinfo.output_width;
+    img.height = (int)dinfo.output_height;
+    img.rgb = malloc((size_t)img.width * img.height * 3);
+    while (dinfo.output_scanline < dinfo.output_height) {
+        JSAMPROW row = img.rgb + (size_t)dinfo.output_scanline * img.width * 3;
+        jpeg_read_scanlines(&dinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&dinfo);
+    img.warnings = jerr.num_warnings;
+    jpeg_destroy_decompress(&dinfo);
+    return img;
+}
+
+static uint8_t *make_frame(int width, int height)
+{
+    uint8_t *src = malloc((size_t)width * height * 2);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint16_t px = (uint16_t)(((x * 31 / width) << 11) | ((((y * 63 / height) ^ (x & 7)) & 63) << 5) | ((x + y) & 31));
+            src[(y * width + x) * 2] = (uint8_t)(px >> 8);
+            src[(y * width + x) * 2 + 1] = (uint8_t)px;
+        }
+    }
+    return src;
+}
+
+static bool has_marker(const uint8_t *buf, size_t len, uint8_t marker)
+{
+    for (size_t i = 0; i + 1 < len; i++) {
+        if (buf[i] == 0xFF && buf[i + 1] == marker) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* 编码一帧并与整帧fmt2jpg的解码结果比较，返回是否走了分条路径 */
+static bool check_frame(int width, int height, uint8_t quality)
+{
+    size_t len = (size_t)width * height * 2;
+    uint8_t *src = make_frame(width, height);
+    uint8_t *whole = NULL, *strip = NULL;
+    size_t whole_len = 0, strip_len = 0;
+
+    CHECK(fmt2jpg(src, len, (uint16_t)width, (uint16_t)height, PIXFORMAT_RGB565, quality, &whole, &whole_len));
+    CHECK(jpeg_strip_encode(src, len, (uint16_t)width, (uint16_t)height, quality, &strip, &strip_len) == ESP_OK);
+
+    decoded_t a = decode(whole, whole_len);
+    decoded_t b = decode(strip, strip_len);
+    CHECK(b.warnings == 0);
+    CHECK(a.width == width && a.height == height);
+    CHECK(b.width == width && b.height == height);
+    CHECK(memcmp(a.rgb, b.rgb, (size_t)width * height * 3) == 0);
+    CHECK(strip[strip_len - 2] == 0xFF && strip[strip_len - 1] == 0xD9);
+
+    bool spliced = has_marker(strip, strip_len, 0xDD);
+    printf("%dx%d q%u: whole %zu B, strips %zu B, %s\n", width, height, quality, whole_len, strip_len,
+           spliced ? "spliced" : "whole-frame");
+
+    free(a.rgb);
+    free(b.rgb);
+    free(whole);
+    free(strip);
+    free(src);
+    return spliced;
+}
+
+int main(void)
+{
+    jpeg_strip_stats_t st;
+
+    /* 辅助任务未创建：整帧编码 */
+    CHECK(!check_frame(320, 240, 80));
+    jpeg_strip_get_stats(&st);
+    CHECK(st.fallback == 1 && st.parallel == 0);
+
+    CHECK(jpeg_strip_init(80) == ESP_OK);
+
+    CHECK(check_frame(800, 600, 80));
+    CHECK(check_frame(400, 300, 80));
+    CHECK(check_frame(320, 240, 80));
+    CHECK(check_frame(37, 50, 80));         /* 宽高都不是MCU的整数倍，最后一条只有2行 */
+    CHECK(!check_frame(16, 16, 80));        /* 只有一个MCU行，整帧编码 */
+
+    /* 换质量后先单核重新预热，输出仍与整帧编码一致 */
+    CHECK(check_frame(320, 240, 50));
+    CHECK(check_frame(320, 240, 80));
+
+    /* 辅助任务饿死：调用者独自编完所有条即返回 */
+    jpeg_strip_get_stats(&st);
+    uint32_t worker_strips = st.worker_strips;
+    uint32_t parallel = st.parallel;
+    host_rtos_hold_tasks(true);
+    CHECK(check_frame(800, 600, 80));
+    jpeg_strip_get_stats(&st);
+    CHECK(st.worker_strips == worker_strips);
+    CHECK(st.parallel == parallel + 1);
+
+    /* 晚醒的辅助任务领不到已结束作业的条 */
+    host_rtos_hold_tasks(false);
+    usleep(20 * 1000);
+    jpeg_strip_get_stats(&st);
+    CHECK(st.worker_strips == worker_strips);
+    CHECK(check_frame(800, 600, 80));
+
+    jpeg_strip_get_stats(&st);
+    printf("parallel %u, fallback %u, strips %u, worker strips %u\n",
+           st.parallel, st.fallback, st.strips, st.worker_strips);
+    return CHECK_RESULT();
+}
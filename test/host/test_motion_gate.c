@@ -0,0 +1,155 @@
+/* motion_gate主机测试：大端RGB565亮度换算、阈值与MOTION_MIN_CELLS判决、MOTION_MAX_STALE_US强制推理 */
+#include "motion_gate.h"
+#include "host_check.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_W     320
+#define FRAME_H     240
+#define BLOCK_W     (FRAME_W / MOTION_THUMB_W)
+#define BLOCK_H     (FRAME_H / MOTION_THUMB_H)
+
+static uint16_t s_frame[FRAME_W * FRAME_H];
+
+/* 按摄像头的大端字节序写像素，与主机字节序无关 */
+static void put_pixel(int x, int y, uint16_t rgb565)
+{
+    uint8_t *p = (uint8_t *)&s_frame[y * FRAME_W + x];
+    p[0] = (uint8_t)(rgb565 >> 8);
+    p[1] = (uint8_t)rgb565;
+}
+
+static void fill(uint16_t rgb565)
+{
+    for (int y = 0; y < FRAME_H; y++) {
+        for (int x = 0; x < FRAME_W; x++) {
+            put_pixel(x, y, rgb565);
+        }
+    }
+}
+
+/* 把第0行前n个缩略图格对应的块涂成指定颜色 */
+static void paint_cells(int n, uint16_t rgb565)
+{
+    for (int c = 0; c < n; c++) {
+        for (int y = 0; y < BLOCK_H; y++) {
+            for (int x = 0; x < BLOCK_W; x++) {
+                put_pixel(c * BLOCK_W + x, y, rgb565);
+            }
+        }
+    }
+}
+
+static uint8_t thumb_of(uint16_t rgb565)
+{
+    uint8_t thumb[MOTION_THUMB_W * MOTION_THUMB_H];
+
+    fill(rgb565);
+    motion_luma_thumb_rgb565be(s_frame, FRAME_W, FRAME_H, thumb);
+    for (int i = 1; i < MOTION_THUMB_W * MOTION_THUMB_H; i++) {
+        CHECK(thumb[i] == thumb[0]);
+    }
+    return thumb[0];
+}
+
+static void test_luma(void)
+{
+    /* 64倍定点系数：白 = (31*157 + 63*152 + 31*60) >> 6 */
+    CHECK(thumb_of(0xFFFF) == 254);
+    CHECK(thumb_of(0x0000) == 0);
+    /* 单色分量检验字节交换：未交换时红色会被读成0x00F8 */
+    CHECK(thumb_of(0xF800) == 76);
+    CHECK(thumb_of(0x07E0) == 149);
+    CHECK(thumb_of(0x001F) == 29);
+
+    /* 左白右黑：缩略图左右两半分开 */
+    uint8_t thumb[MOTION_THUMB_W * MOTION_THUMB_H];
+    fill(0x0000);
+    for (int y = 0; y < FRAME_H; y++) {
+        for (int x = 0; x < FRAME_W / 2; x++) {
+            put_pixel(x, y, 0xFFFF);
+        }
+    }
+    motion_luma_thumb_rgb565be(s_frame, FRAME_W, FRAME_H, thumb);
+    CHECK(thumb[MOTION_THUMB_W / 2 - 1] == 254 && thumb[MOTION_THUMB_W / 2] == 0);
+    CHECK(thumb[(MOTION_THUMB_H - 1) * MOTION_THUMB_W] == 254);
+}
+
+static void test_diff(void)
+{
+    uint8_t a[MOTION_THUMB_W * MOTION_THUMB_H];
+    uint8_t b[MOTION_THUMB_W * MOTION_THUMB_H];
+    uint32_t sad = 0;
+
+    memset(a, 100, sizeof(a));
+    memcpy(b, a, sizeof(b));
+    b[0] = 100 + MOTION_CELL_THRESHOLD;         /* 等于阈值不算变化 */
+    b[1] = 100 + MOTION_CELL_THRESHOLD + 1;
+    b[2] = 100 - MOTION_CELL_THRESHOLD - 1;
+    CHECK(motion_thumb_diff(a, b, MOTION_CELL_THRESHOLD, &sad) == 2);
+    CHECK(sad == 3 * MOTION_CELL_THRESHOLD + 2);
+    CHECK(motion_thumb_diff(a, a, MOTION_CELL_THRESHOLD, NULL) == 0);
+}
+
+static void test_gate(void)
+{
+    motion_gate_t gate;
+    int64_t t = 1000000;
+
+    motion_gate_init(&gate);
+    fill(0x0000);
+
+    /* 没有参考帧时必须推理 */
+    CHECK(motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, t));
+    motion_gate_commit(&gate, t);
+
+    /* 静止 */
+    t += 100000;
+    CHECK(!motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, t));
+    CHECK(gate.last_changed == 0 && gate.skipped == 1);
+
+    /* 变化格数少于MOTION_MIN_CELLS：仍跳过，且不更新参考 */
+    paint_cells(MOTION_MIN_CELLS - 1, 0xFFFF);
+    t += 100000;
+    CHECK(!motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, t));
+    CHECK(gate.last_changed == MOTION_MIN_CELLS - 1);
+
+    /* 变化低于单格阈值的不计数：亮度变化约8 */
+    fill(0x0000);
+    paint_cells(MOTION_MIN_CELLS, 0x0841);
+    t += 100000;
+    CHECK(!motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, t));
+    CHECK(gate.last_changed == 0);
+
+    /* 达到MOTION_MIN_CELLS：推理 */
+    fill(0x0000);
+    paint_cells(MOTION_MIN_CELLS, 0xFFFF);
+    t += 100000;
+    CHECK(motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, t));
+    CHECK(gate.last_changed == MOTION_MIN_CELLS);
+    motion_gate_commit(&gate, t);
+
+    /* 推理后以新画面为参考，静止时跳过直到结果过期 */
+    int64_t infer_us = t;
+    CHECK(!motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, infer_us + MOTION_MAX_STALE_US - 1));
+    CHECK(gate.stale == 0);
+    CHECK(motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, infer_us + MOTION_MAX_STALE_US));
+    CHECK(gate.stale == 1);
+    motion_gate_commit(&gate, infer_us + MOTION_MAX_STALE_US);
+    CHECK(!motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, infer_us + MOTION_MAX_STALE_US + 1));
+
+    /* 帧小于缩略图：始终推理并作废参考 */
+    CHECK(motion_gate_check(&gate, s_frame, MOTION_THUMB_W - 1, MOTION_THUMB_H, t));
+    CHECK(!gate.ref_valid);
+    CHECK(motion_gate_check(&gate, s_frame, FRAME_W, FRAME_H, t));
+
+    CHECK(gate.checks == 10 && gate.skipped == 5);
+}
+
+int main(void)
+{
+    test_luma();
+    test_diff();
+    test_gate();
+    return CHECK_RESULT();
+}
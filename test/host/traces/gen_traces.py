@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""生成距离滤波回放用的合成轨迹（固定随机种子，重复运行输出不变）。
+
+这些轨迹是合成的，不是设备录制的：真实距离按场景脚本给出，原始测量按实测观察到的误差形态叠加
+——眼距抖动约3%的乘性噪声、偶发关键点误检（单帧距离偏近10%-30%）、随调速器变化的帧间隔(80-200 ms)、
+人脸丢失造成的时间断档。用设备日志替换时保持同样的三列格式即可：
+
+    timestamp_us,raw_cm,truth_cm
+
+truth_cm是该帧的真实距离，回放程序据此判定报警延迟与误报；设备日志没有真值时可用人工标注的区间填写。
+"""
+import math
+import os
+import random
+
+OUT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+
+def frames(rng, duration_s, start_us, min_ms=80, max_ms=200):
+    """按随机帧间隔产生时间戳"""
+    t = start_us
+    end = start_us + int(duration_s * 1e6)
+    while t < end:
+        yield t
+        t += int(rng.uniform(min_ms, max_ms) * 1000)
+
+
+def measure(rng, truth, glitch_rate):
+    """真实距离 -> 原始测量：乘性抖动 + 偶发偏近的误检"""
+    if rng.random() < glitch_rate:
+        return truth * rng.uniform(0.7, 0.9)
+    return truth * (1.0 + rng.gauss(0.0, 0.03))
+
+
+def write(name, description, rows):
+    with open(os.path.join(OUT_DIR, name + ".csv"), "w") as f:
+        f.write("# synthetic trace generated by gen_traces.py: %s\n" % description)
+        f.write("timestamp_us,raw_cm,truth_cm\n")
+        for t, raw, truth in rows:
+            f.write("%d,%.2f,%.2f\n" % (t, raw, truth))
+
+
+def scripted(rng, segments, glitch_rate):
+    """segments: [(时长s, 起始距离, 结束距离), ...]，段内线性变化；距离为None表示人脸丢失（无帧）"""
+    rows = []
+    t0 = 0
+    for duration, d0, d1 in segments:
+        if d0 is None:
+            t0 += int(duration * 1e6)
+            continue
+        for t in frames(rng, duration, t0):
+            a = (t - t0) / (duration * 1e6)
+            truth = d0 + (d1 - d0) * a
+            rows.append((t, measure(rng, truth, glitch_rate), truth))
+        t0 += int(duration * 1e6)
+    return rows
+
+
+def main():
+    rng = random.Random(20250725)
+
+    write("steady_safe", "seated at 55 cm for 120 s, 2% glitches",
+          scripted(rng, [(120, 55, 55)], 0.02))
+
+    write("hover_above_threshold", "seated at 49-51 cm (just outside the 48 cm exit threshold) for 120 s, 2% glitches",
+          [(t, measure(rng, 50 + math.sin(t * 1e-6 * 0.3), 0.02), 50 + math.sin(t * 1e-6 * 0.3))
+           for t in frames(rng, 120, 0)])
+
+    write("slow_lean", "60 cm -> 38 cm over 10 s, hold 5 s, back over 5 s, repeated 4 times, 2% glitches",
+          scripted(rng, [(5, 60, 60), (10, 60, 38), (5, 38, 38), (5, 38, 60)] * 4, 0.02))
+
+    write("fast_lean", "60 cm -> 35 cm in 0.5 s, hold 3 s, back in 0.5 s, repeated 6 times, 2% glitches",
+          scripted(rng, [(4, 60, 60), (0.5, 60, 35), (3, 35, 35), (0.5, 35, 60)] * 6, 0.02))
+
+    write("face_lost", "leans in and out with 1.5 s face-loss gaps before each approach, 2% glitches",
+          scripted(rng, [(4, 55, 55), (1.5, None, None), (3, 40, 40), (2, 40, 55)] * 5, 0.02))
+
+
+if __name__ == "__main__":
+    main()